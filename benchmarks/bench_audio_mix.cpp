@@ -0,0 +1,239 @@
+/**
+ * @file bench_audio_mix.cpp
+ * @brief AudioMixKernel 混音内核微基准
+ *
+ * 以 10ms @48kHz（480 采样）为一帧，分别混合 2 / 8 / 32 / 64 路输入，
+ * 对比标量、SSE2、AVX2 实现的每帧耗时与吞吐量。
+ * 运行前会先校验各 SIMD 实现与标量实现的输出逐位一致。
+ *
+ * 第二部分对比 mix-minus（每路都输出 N−1 混音）：单遍 mixMinusStreams()
+ * 与「对每路各做一次 N−1 路 mixStreams()」的朴素实现。
+ *
+ * 用法：bench_audio_mix [迭代次数]
+ */
+
+#include "audiomixkernel.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr int kSamplesPerFrame = 48000 / 100; // 10ms @48kHz
+constexpr int kStreamCounts[] = {2, 8, 32, 64};
+
+using AudioMixKernel::Implementation;
+
+struct Inputs
+{
+  std::vector<std::vector<int16_t>> storage;
+  std::vector<const int16_t *> ptrs;
+};
+
+Inputs makeInputs(int streamCount, int sampleCount)
+{
+  // 固定种子，覆盖满幅值以触发饱和路径
+  std::mt19937 rng(12345u + static_cast<unsigned>(streamCount));
+  std::uniform_int_distribution<int> dist(-32768, 32767);
+
+  Inputs in;
+  in.storage.resize(streamCount);
+  for (auto &s : in.storage)
+  {
+    s.resize(sampleCount);
+    for (auto &v : s)
+      v = static_cast<int16_t>(dist(rng));
+  }
+  for (const auto &s : in.storage)
+    in.ptrs.push_back(s.data());
+  return in;
+}
+
+bool verify(Implementation impl, const Inputs &in, int sampleCount)
+{
+  std::vector<int16_t> ref(sampleCount), out(sampleCount);
+  const int n = static_cast<int>(in.ptrs.size());
+  AudioMixKernel::mixStreamsWith(Implementation::Scalar, ref.data(),
+                                 in.ptrs.data(), n, sampleCount);
+  AudioMixKernel::mixStreamsWith(impl, out.data(), in.ptrs.data(), n,
+                                 sampleCount);
+  return ref == out;
+}
+
+double benchNsPerFrame(Implementation impl, const Inputs &in, int iterations)
+{
+  std::vector<int16_t> out(kSamplesPerFrame);
+  const int n = static_cast<int>(in.ptrs.size());
+
+  // 预热
+  for (int i = 0; i < iterations / 10 + 1; ++i)
+    AudioMixKernel::mixStreamsWith(impl, out.data(), in.ptrs.data(), n,
+                                   kSamplesPerFrame);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+    AudioMixKernel::mixStreamsWith(impl, out.data(), in.ptrs.data(), n,
+                                   kSamplesPerFrame);
+  const auto end = std::chrono::steady_clock::now();
+
+  // 防止编译器消除无副作用的循环
+  volatile int16_t sink = out[kSamplesPerFrame / 2];
+  (void)sink;
+
+  return static_cast<double>(
+             std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+                 .count()) /
+         iterations;
+}
+
+// 朴素 mix-minus 参考：对每一路各做一次 N−1 路混音
+void naiveMixMinus(Implementation impl, const Inputs &in,
+                   std::vector<std::vector<int16_t>> &outs,
+                   std::vector<const int16_t *> &others, int sampleCount)
+{
+  const int n = static_cast<int>(in.ptrs.size());
+  for (int k = 0; k < n; ++k)
+  {
+    others.clear();
+    for (int j = 0; j < n; ++j)
+    {
+      if (j != k)
+        others.push_back(in.ptrs[j]);
+    }
+    AudioMixKernel::mixStreamsWith(impl, outs[k].data(), others.data(), n - 1,
+                                   sampleCount);
+  }
+}
+
+struct MixMinusOutputs
+{
+  std::vector<std::vector<int16_t>> storage;
+  std::vector<int16_t *> ptrs;
+
+  MixMinusOutputs(int streamCount, int sampleCount)
+      : storage(streamCount, std::vector<int16_t>(sampleCount))
+  {
+    for (auto &s : storage)
+      ptrs.push_back(s.data());
+  }
+};
+
+bool verifyMixMinus(Implementation impl, const Inputs &in, int sampleCount)
+{
+  const int n = static_cast<int>(in.ptrs.size());
+  std::vector<std::vector<int16_t>> ref(n, std::vector<int16_t>(sampleCount));
+  std::vector<const int16_t *> others;
+  naiveMixMinus(Implementation::Scalar, in, ref, others, sampleCount);
+
+  MixMinusOutputs out(n, sampleCount);
+  AudioMixKernel::mixMinusStreamsWith(impl, nullptr, out.ptrs.data(),
+                                      in.ptrs.data(), n, sampleCount);
+  return out.storage == ref;
+}
+
+template <typename Fn> double timeNsPerFrame(int iterations, Fn &&fn)
+{
+  for (int i = 0; i < iterations / 10 + 1; ++i)
+    fn();
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+    fn();
+  const auto end = std::chrono::steady_clock::now();
+  return static_cast<double>(
+             std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+                 .count()) /
+         iterations;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20000;
+
+  const Implementation impls[] = {Implementation::Scalar, Implementation::SSE2,
+                                  Implementation::AVX2};
+
+  std::printf("AudioMixKernel benchmark: %d samples/frame (10 ms @48 kHz), "
+              "%d iterations, active=%s\n",
+              kSamplesPerFrame, iterations,
+              AudioMixKernel::implementationName(
+                  AudioMixKernel::activeImplementation()));
+  std::printf("%-8s %-8s %14s %16s %10s\n", "streams", "impl", "ns/frame",
+              "Msamples/s", "speedup");
+
+  int failures = 0;
+  for (int streams : kStreamCounts)
+  {
+    // 用不是 8/16 整数倍的长度校验尾部处理
+    const Inputs verifyIn = makeInputs(streams, kSamplesPerFrame + 7);
+    const Inputs in = makeInputs(streams, kSamplesPerFrame);
+
+    double scalarNs = 0.0;
+    for (Implementation impl : impls)
+    {
+      if (!AudioMixKernel::isSupported(impl))
+        continue;
+      if (!verify(impl, verifyIn, kSamplesPerFrame + 7))
+      {
+        std::printf("%-8d %-8s MISMATCH vs scalar\n", streams,
+                    AudioMixKernel::implementationName(impl));
+        ++failures;
+        continue;
+      }
+
+      const double ns = benchNsPerFrame(impl, in, iterations);
+      if (impl == Implementation::Scalar)
+        scalarNs = ns;
+      const double msps =
+          static_cast<double>(streams) * kSamplesPerFrame / ns * 1000.0;
+      std::printf("%-8d %-8s %14.1f %16.1f %9.2fx\n", streams,
+                  AudioMixKernel::implementationName(impl), ns, msps,
+                  scalarNs > 0.0 ? scalarNs / ns : 1.0);
+    }
+  }
+
+  // ---- mix-minus：每路都输出 N−1 混音 ----
+  const Implementation active = AudioMixKernel::activeImplementation();
+  std::printf("\nmix-minus (all buses), impl=%s\n",
+              AudioMixKernel::implementationName(active));
+  std::printf("%-8s %16s %16s %10s\n", "streams", "naive ns/frame",
+              "single-pass ns", "speedup");
+  for (int streams : kStreamCounts)
+  {
+    const Inputs verifyIn = makeInputs(streams, kSamplesPerFrame + 7);
+    if (!verifyMixMinus(active, verifyIn, kSamplesPerFrame + 7))
+    {
+      std::printf("%-8d mix-minus MISMATCH vs naive\n", streams);
+      ++failures;
+      continue;
+    }
+
+    const Inputs in = makeInputs(streams, kSamplesPerFrame);
+    std::vector<std::vector<int16_t>> naiveOut(
+        streams, std::vector<int16_t>(kSamplesPerFrame));
+    std::vector<const int16_t *> others;
+    others.reserve(streams);
+    MixMinusOutputs out(streams, kSamplesPerFrame);
+
+    // 朴素实现为 O(N²)，迭代次数按路数缩减以控制运行时间
+    const int iters = std::max(100, iterations / streams);
+    const double naiveNs = timeNsPerFrame(iters, [&]()
+                                          { naiveMixMinus(active, in, naiveOut,
+                                                          others,
+                                                          kSamplesPerFrame); });
+    const double fusedNs = timeNsPerFrame(iters, [&]()
+                                          { AudioMixKernel::mixMinusStreams(
+                                                nullptr, out.ptrs.data(),
+                                                in.ptrs.data(), streams,
+                                                kSamplesPerFrame); });
+    std::printf("%-8d %16.1f %16.1f %9.2fx\n", streams, naiveNs, fusedNs,
+                naiveNs / fusedNs);
+  }
+
+  return failures == 0 ? 0 : 1;
+}
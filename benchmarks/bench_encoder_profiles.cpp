@@ -0,0 +1,133 @@
+/**
+ * @file bench_encoder_profiles.cpp
+ * @brief 录制视频编码配置基准
+ *
+ * 用 EncoderCalibrator 逐个试编码候选配置（默认 H.264 / HEVC / AV1 各若干
+ * 预设），合成画面为多宫格、带运动和噪声的会议画面。每个配置记录墙钟吞吐、
+ * 进程 CPU 时间（含编码器线程）和输出字节数，最后给出校准会选用的配置。
+ * 结果打印为表格，指定 --output 时另存 JSON，便于在 CI 中对比回归。
+ *
+ * 用法：bench_encoder_profiles [--seconds 3] [--width 1920] [--height 1080]
+ *                              [--fps 30] [--profiles h264/fast/crf23/t0,...]
+ *                              [--output result.json]
+ */
+
+#include "encoderprofile.h"
+#include "videocompositor.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+
+#include <algorithm>
+#include <cstdio>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int seconds = EncoderCalibrator::DEFAULT_DURATION_SECONDS;
+    int width = VideoCompositor::DEFAULT_OUTPUT_WIDTH;
+    int height = VideoCompositor::DEFAULT_OUTPUT_HEIGHT;
+    int fps = VideoCompositor::DEFAULT_OUTPUT_FPS;
+    QList<EncoderProfile> candidates = EncoderProfile::defaultCandidates();
+    QString outputPath;
+
+    const QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i)
+    {
+        const QString &arg = args[i];
+        const bool hasValue = i + 1 < args.size();
+        if (arg == "--seconds" && hasValue)
+            seconds = std::max(1, args[++i].toInt());
+        else if (arg == "--width" && hasValue)
+            width = args[++i].toInt();
+        else if (arg == "--height" && hasValue)
+            height = args[++i].toInt();
+        else if (arg == "--fps" && hasValue)
+            fps = std::max(1, args[++i].toInt());
+        else if (arg == "--profiles" && hasValue)
+        {
+            candidates.clear();
+            for (const QString &part : args[++i].split(',', Qt::SkipEmptyParts))
+            {
+                bool ok = false;
+                const EncoderProfile profile =
+                    EncoderProfile::fromString(part, &ok);
+                if (!ok)
+                {
+                    std::fprintf(stderr, "无效的编码配置: %s\n",
+                                 qPrintable(part));
+                    return 1;
+                }
+                candidates.append(profile);
+            }
+        }
+        else if (arg == "--output" && hasValue)
+            outputPath = args[++i];
+    }
+    // YUV420P 要求宽高为偶数
+    if (width < 2 || height < 2 || width % 2 || height % 2 ||
+        candidates.isEmpty())
+    {
+        std::fprintf(stderr, "无效的 --width / --height / --profiles 参数\n");
+        return 1;
+    }
+
+    EncoderCalibrator calibrator(width, height, fps);
+    calibrator.setDurationSeconds(seconds);
+
+    std::printf("Encoder profile benchmark: %dx%d @ %d fps, %d s per profile, "
+                "realtime >= %.2fx\n",
+                width, height, fps, seconds,
+                EncoderCalibrator::DEFAULT_REALTIME_MARGIN);
+    std::printf("%-26s %10s %12s %12s %9s\n", "profile", "fps", "cpu ms/frame",
+                "kbit/s", "realtime");
+
+    const QList<EncoderCalibrator::Result> results = calibrator.run(candidates);
+    QJsonArray json;
+    for (const EncoderCalibrator::Result &r : results)
+    {
+        const QString name = r.profile.toString();
+        if (!r.available)
+        {
+            std::printf("%-26s %10s\n", qPrintable(name), "n/a");
+            json.append(QJsonObject{{"profile", name}, {"available", false}});
+            continue;
+        }
+        const double kbps = r.bytes * 8.0 / 1000.0 / seconds;
+        std::printf("%-26s %10.1f %12.2f %12.0f %9s\n", qPrintable(name),
+                    r.encodeFps, r.cpuMsPerFrame, kbps,
+                    r.realtime ? "yes" : "no");
+        json.append(QJsonObject{{"profile", name},
+                                {"available", true},
+                                {"encode_fps", r.encodeFps},
+                                {"cpu_ms_per_frame", r.cpuMsPerFrame},
+                                {"kbps", kbps},
+                                {"realtime", r.realtime}});
+    }
+
+    const EncoderProfile picked = EncoderCalibrator::pick(results);
+    std::printf("picked: %s\n", qPrintable(picked.toString()));
+
+    if (!outputPath.isEmpty())
+    {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            std::fprintf(stderr, "无法写入 %s\n", qPrintable(outputPath));
+            return 1;
+        }
+        const QJsonObject root{
+            {"output",
+             QJsonObject{{"width", width}, {"height", height}, {"fps", fps}}},
+            {"seconds", seconds},
+            {"results", json},
+            {"picked", picked.toString()}};
+        file.write(QJsonDocument(root).toJson());
+    }
+    return 0;
+}
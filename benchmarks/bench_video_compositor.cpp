@@ -0,0 +1,460 @@
+/**
+ * @file bench_video_compositor.cpp
+ * @brief VideoCompositor 合成基准
+ *
+ * 1080p 输出，分别合成 4 / 9 / 16 / 25 个参会者，源分辨率 360p / 720p /
+ * 1080p，对比单线程串行绘制与线程池并行绘制：
+ * - all dirty：每个 tick 所有参会者都有新帧（最坏情况）
+ * - static：没有新帧（增量合成只重发上一帧画布）
+ *
+ * 另对比录制路径的两种输出方式（all dirty，线程池绘制）：
+ * - argb+sws：合成 ARGB 画布，再按 MeetingRecorder 的方式整帧 BGRA→YUV420P
+ *   （sws_scale_frame，SWS_FAST_BILINEAR，自动线程数）
+ * - yuv420p：合成器直接输出 YUV420P（各单元格 sws_scale 写入平面）
+ *
+ * 每个 tick 记录墙钟耗时（输出 p50 / p95）、进程 CPU 时间（含线程池）和
+ * operator new 次数（QImage 像素缓冲走 malloc，不在其中）。结果打印为
+ * 表格，指定 --output 时另存 JSON，便于在 CI 中对比回归。
+ *
+ * 使用 offscreen 平台运行，无需显示器。
+ *
+ * 用法：bench_video_compositor [--frames 60] [--tiles 4,9,16,25]
+ *                              [--sources 360,720,1080] [--output result.json]
+ */
+
+#include "videocompositor.h"
+
+#include <QColor>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QStringList>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+extern "C"
+{
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+#include <libavutil/opt.h>
+#include <libswscale/swscale.h>
+}
+
+#ifdef Q_OS_WIN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// ==================== 堆分配计数 ====================
+
+namespace
+{
+std::atomic<quint64> g_newCount{0};
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    g_newCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// 进程累计 CPU 时间（用户 + 内核，所有线程），纳秒
+qint64 processCpuNs()
+{
+#ifdef Q_OS_WIN
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return static_cast<qint64>(k.QuadPart + u.QuadPart) * 100;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return (static_cast<qint64>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+            1000000 +
+            usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) *
+           1000;
+#endif
+}
+
+// 每个参会者一张不同色调的渐变图，保证缩放有真实工作量
+QImage makeSource(int index, int height)
+{
+    const int width = height * 16 / 9;
+    QImage img(width, height, QImage::Format_ARGB32);
+    const int hue = (index * 37) % 360;
+    for (int y = 0; y < height; ++y)
+    {
+        auto *line = reinterpret_cast<QRgb *>(img.scanLine(y));
+        for (int x = 0; x < width; ++x)
+        {
+            const QColor c = QColor::fromHsv(hue, 80 + (x * 175) / width,
+                                             60 + (y * 195) / height);
+            line[x] = c.rgb();
+        }
+    }
+    QPainter p(&img);
+    p.setPen(Qt::white);
+    p.drawEllipse(img.rect().adjusted(width / 6, height / 7, -width / 6,
+                                      -height / 7));
+    return img;
+}
+
+struct TickStats
+{
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double cpuMsPerTick = 0.0;
+    double allocsPerTick = 0.0;
+};
+
+// 预热后逐 tick 计时
+template <typename Fn> TickStats measure(int frames, Fn &&fn)
+{
+    for (int i = 0; i < frames / 10 + 1; ++i)
+        fn();
+
+    std::vector<qint64> tickNs;
+    tickNs.reserve(frames);
+    const qint64 cpuStart = processCpuNs();
+    const quint64 allocStart = g_newCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < frames; ++i)
+    {
+        const auto start = Clock::now();
+        fn();
+        tickNs.push_back(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                                 start)
+                .count());
+    }
+    const quint64 allocs =
+        g_newCount.load(std::memory_order_relaxed) - allocStart;
+    const qint64 cpuNs = processCpuNs() - cpuStart;
+
+    std::sort(tickNs.begin(), tickNs.end());
+    auto pct = [&tickNs](double p) {
+        return static_cast<double>(
+                   tickNs[static_cast<size_t>(p * (tickNs.size() - 1))]) /
+               1e6;
+    };
+    TickStats stats;
+    stats.p50Ms = pct(0.50);
+    stats.p95Ms = pct(0.95);
+    stats.cpuMsPerTick = static_cast<double>(cpuNs) / 1e6 / frames;
+    stats.allocsPerTick = static_cast<double>(allocs) / frames;
+    return stats;
+}
+
+// 与 MeetingRecorder::convertQueuedVideo 相同的整帧 BGRA→YUV420P 转换
+class RecorderConverter
+{
+public:
+    ~RecorderConverter()
+    {
+        sws_freeContext(m_ctx);
+        av_frame_free(&m_dst);
+    }
+
+    bool convert(const QImage &image)
+    {
+        if (!m_ctx && !init(image.width(), image.height()))
+            return false;
+
+        // 录制器用 AVBuffer 包装 QImage 像素；这里图像在转换期间一直有效，释放回调为空
+        AVFrame *src = av_frame_alloc();
+        if (!src)
+            return false;
+        src->buf[0] = av_buffer_create(const_cast<uint8_t *>(image.constBits()),
+                                       static_cast<size_t>(image.sizeInBytes()),
+                                       [](void *, uint8_t *) {}, nullptr,
+                                       AV_BUFFER_FLAG_READONLY);
+        src->data[0] = src->buf[0] ? src->buf[0]->data : nullptr;
+        src->linesize[0] = static_cast<int>(image.bytesPerLine());
+        src->format = AV_PIX_FMT_BGRA;
+        src->width = image.width();
+        src->height = image.height();
+        const bool ok = src->buf[0] && sws_scale_frame(m_ctx, m_dst, src) >= 0;
+        av_frame_free(&src);
+        return ok;
+    }
+
+private:
+    bool init(int width, int height)
+    {
+        m_ctx = sws_alloc_context();
+        m_dst = av_frame_alloc();
+        if (!m_ctx || !m_dst)
+            return false;
+        av_opt_set_int(m_ctx, "srcw", width, 0);
+        av_opt_set_int(m_ctx, "srch", height, 0);
+        av_opt_set_int(m_ctx, "src_format", AV_PIX_FMT_BGRA, 0);
+        av_opt_set_int(m_ctx, "dstw", width, 0);
+        av_opt_set_int(m_ctx, "dsth", height, 0);
+        av_opt_set_int(m_ctx, "dst_format", AV_PIX_FMT_YUV420P, 0);
+        av_opt_set_int(m_ctx, "sws_flags", SWS_FAST_BILINEAR, 0);
+        av_opt_set_int(m_ctx, "threads", 0, 0);
+        if (sws_init_context(m_ctx, nullptr, nullptr) < 0)
+            return false;
+        m_dst->format = AV_PIX_FMT_YUV420P;
+        m_dst->width = width;
+        m_dst->height = height;
+        return av_frame_get_buffer(m_dst, 0) >= 0;
+    }
+
+    SwsContext *m_ctx = nullptr;
+    AVFrame *m_dst = nullptr;
+};
+
+QJsonObject toJson(const TickStats &s)
+{
+    return QJsonObject{{"p50_ms", s.p50Ms},
+                       {"p95_ms", s.p95Ms},
+                       {"cpu_ms_per_tick", s.cpuMsPerTick},
+                       {"allocs_per_tick", s.allocsPerTick}};
+}
+
+std::vector<int> parseList(const QString &arg)
+{
+    std::vector<int> values;
+    for (const QString &part : arg.split(',', Qt::SkipEmptyParts))
+    {
+        const int v = part.trimmed().toInt();
+        if (v > 0)
+            values.push_back(v);
+    }
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    int frames = 60;
+    std::vector<int> tileCounts = {4, 9, 16, 25};
+    std::vector<int> sourceHeights = {360, 720, 1080};
+    QString outputPath;
+
+    const QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i)
+    {
+        const QString &arg = args[i];
+        const bool hasValue = i + 1 < args.size();
+        if (arg == "--frames" && hasValue)
+            frames = std::max(1, args[++i].toInt());
+        else if (arg == "--tiles" && hasValue)
+            tileCounts = parseList(args[++i]);
+        else if (arg == "--sources" && hasValue)
+            sourceHeights = parseList(args[++i]);
+        else if (arg == "--output" && hasValue)
+            outputPath = args[++i];
+    }
+    if (tileCounts.empty() || sourceHeights.empty())
+    {
+        std::fprintf(stderr, "无效的 --tiles / --sources 参数\n");
+        return 1;
+    }
+
+    const int threads = qMax(1, QThread::idealThreadCount());
+    const int maxTiles = *std::max_element(tileCounts.begin(), tileCounts.end());
+
+    std::printf("VideoCompositor benchmark: %dx%d output, %d frames, "
+                "%d threads\n",
+                VideoCompositor::DEFAULT_OUTPUT_WIDTH,
+                VideoCompositor::DEFAULT_OUTPUT_HEIGHT, frames, threads);
+    std::printf("%-6s %-7s %-8s %10s %10s %10s %12s %10s %9s\n", "tiles",
+                "source", "threads", "p50 ms", "p95 ms", "cpu ms",
+                "allocs/tick", "static ms", "speedup");
+
+    QJsonArray results;
+    for (int sourceHeight : sourceHeights)
+    {
+        std::vector<QImage> sources;
+        for (int i = 0; i < maxTiles; ++i)
+            sources.push_back(makeSource(i, sourceHeight));
+
+        for (int tiles : tileCounts)
+        {
+            double serialMs = 0.0;
+            for (int threadCount : {1, threads})
+            {
+                VideoCompositor compositor;
+                compositor.setRenderThreadCount(threadCount);
+
+                auto feedAll = [&]() {
+                    for (int i = 0; i < tiles; ++i)
+                    {
+                        compositor.feedFrame(QStringLiteral("p%1").arg(i),
+                                             sources[i],
+                                             QStringLiteral("参会者 %1").arg(i));
+                    }
+                };
+
+                const TickStats dirty = measure(frames, [&]() {
+                    feedAll();
+                    compositor.compositeNow();
+                });
+                const TickStats still =
+                    measure(frames, [&]() { compositor.compositeNow(); });
+
+                if (threadCount == 1)
+                    serialMs = dirty.p50Ms;
+                const double speedup =
+                    dirty.p50Ms > 0.0 ? serialMs / dirty.p50Ms : 1.0;
+                std::printf("%-6d %-7d %-8d %10.2f %10.2f %10.2f %12.1f "
+                            "%10.3f %8.2fx\n",
+                            tiles, sourceHeight, threadCount, dirty.p50Ms,
+                            dirty.p95Ms, dirty.cpuMsPerTick,
+                            dirty.allocsPerTick, still.p50Ms, speedup);
+
+                results.append(QJsonObject{{"tiles", tiles},
+                                           {"source_height", sourceHeight},
+                                           {"threads", threadCount},
+                                           {"all_dirty", toJson(dirty)},
+                                           {"static", toJson(still)},
+                                           {"speedup", speedup}});
+
+                if (threads == 1)
+                    break;
+            }
+        }
+    }
+
+    // ---- 录制路径：ARGB 画布 + 整帧转换 vs. 直接输出 YUV420P ----
+    std::printf("\nRecording path (all dirty, %d threads)\n", threads);
+    std::printf("%-6s %-7s %-10s %10s %10s %10s %12s %9s\n", "tiles", "source",
+                "output", "p50 ms", "p95 ms", "cpu ms", "allocs/tick",
+                "saving");
+
+    QJsonArray yuvResults;
+    for (int sourceHeight : sourceHeights)
+    {
+        std::vector<QImage> sources;
+        for (int i = 0; i < maxTiles; ++i)
+            sources.push_back(makeSource(i, sourceHeight));
+
+        for (int tiles : tileCounts)
+        {
+            auto feedAll = [&](VideoCompositor &compositor) {
+                for (int i = 0; i < tiles; ++i)
+                {
+                    compositor.feedFrame(QStringLiteral("p%1").arg(i),
+                                         sources[i],
+                                         QStringLiteral("参会者 %1").arg(i));
+                }
+            };
+
+            VideoCompositor argbCompositor;
+            argbCompositor.setRenderThreadCount(threads);
+            RecorderConverter converter;
+            QImage canvas;
+            QObject::connect(&argbCompositor,
+                             &VideoCompositor::compositeFrameReady,
+                             [&canvas](const QImage &frame, qint64) {
+                                 canvas = frame;
+                             });
+            const TickStats argb = measure(frames, [&]() {
+                feedAll(argbCompositor);
+                argbCompositor.compositeNow();
+                converter.convert(canvas);
+                canvas = QImage(); // 归还画布，与编码后释放引用一致
+            });
+
+            VideoCompositor yuvCompositor;
+            yuvCompositor.setRenderThreadCount(threads);
+            yuvCompositor.setOutputFormat(VideoCompositor::OutputFormat::Yuv420p);
+            const TickStats yuv = measure(frames, [&]() {
+                feedAll(yuvCompositor);
+                yuvCompositor.compositeNow();
+            });
+
+            const double saving =
+                argb.cpuMsPerTick > 0.0
+                    ? 1.0 - yuv.cpuMsPerTick / argb.cpuMsPerTick
+                    : 0.0;
+            std::printf("%-6d %-7d %-10s %10.2f %10.2f %10.2f %12.1f\n", tiles,
+                        sourceHeight, "argb+sws", argb.p50Ms, argb.p95Ms,
+                        argb.cpuMsPerTick, argb.allocsPerTick);
+            std::printf("%-6d %-7d %-10s %10.2f %10.2f %10.2f %12.1f %8.0f%%\n",
+                        tiles, sourceHeight, "yuv420p", yuv.p50Ms, yuv.p95Ms,
+                        yuv.cpuMsPerTick, yuv.allocsPerTick, saving * 100.0);
+
+            yuvResults.append(QJsonObject{{"tiles", tiles},
+                                          {"source_height", sourceHeight},
+                                          {"threads", threads},
+                                          {"argb_sws", toJson(argb)},
+                                          {"yuv420p", toJson(yuv)},
+                                          {"cpu_saving", saving}});
+        }
+    }
+
+    if (!outputPath.isEmpty())
+    {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            std::fprintf(stderr, "无法写入 %s\n", qPrintable(outputPath));
+            return 1;
+        }
+        const QJsonObject root{
+            {"output",
+             QJsonObject{{"width", VideoCompositor::DEFAULT_OUTPUT_WIDTH},
+                         {"height", VideoCompositor::DEFAULT_OUTPUT_HEIGHT}}},
+            {"frames", frames},
+            {"results", results},
+            {"recording_path", yuvResults}};
+        file.write(QJsonDocument(root).toJson());
+    }
+    return 0;
+}
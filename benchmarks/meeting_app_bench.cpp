@@ -0,0 +1,512 @@
+/**
+ * @file meeting_app_bench.cpp
+ * @brief 音频链路端到端基准（MeetingAppBench）
+ *
+ * 用合成 PCM 驱动真实的音频链路组件，按 10ms 帧统计耗时、延迟分位数和
+ * 堆分配次数，结果以 JSON 输出，便于在 CI 中对比回归：
+ *
+ * - capture_framing：复现 AudioFrameHandler 的 10ms 分帧（变长采集块
+ *   追加到 std::vector，再逐帧拷出 + erase）
+ * - asr_downsample：AIAssistant::downsampleForAsr()（48kHz → 16kHz）
+ * - mixer / mixer_top4 / mixer_mix_minus：AudioMixer 以 Pacing::Manual
+ *   在当前线程逐周期驱动，每帧推入 N 路远程音频 + 本地麦克风，并登记
+ *   16kHz int16 与 48kHz float planar 两路输出（与 main.cpp 一致）
+ *
+ * 每个阶段先预热 WARMUP_FRAMES 帧，不计入统计。allocs_per_frame 统计的是
+ * operator new 次数（QByteArray 等走 malloc 的分配不在其中）；混音阶段的
+ * 下游输出与 main.cpp 的连接方式一致：录制输出 DirectConnection，ASR 输出
+ * DirectConnection 写入 SPSC 环形缓冲（同 AIAssistant::pushAsrAudio），
+ * 每帧在计时区间内取出（生产环境中 GUI 线程每秒取一次）。
+ * mixer_allocations 为 AudioMixer::allocationCount() 在计时区间内的增量，
+ * 只覆盖 scratch arena 与输出缓冲池，稳态应为 0。
+ *
+ * 用法：MeetingAppBench [--participants 1,4,16,64] [--frames 3000]
+ *                       [--output result.json]
+ */
+
+#include "aiassistant.h"
+#include "audiomixer.h"
+#include "audiomixkernel.h"
+#include "audioringbuffer.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+// ==================== 堆分配计数 ====================
+
+namespace
+{
+std::atomic<quint64> g_newCount{0};
+} // namespace
+
+void *operator new(std::size_t size)
+{
+  g_newCount.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+  return ::operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+namespace
+{
+
+constexpr int kSampleRate = 48000;
+constexpr int kFrameMs = AudioMixer::MIX_INTERVAL_MS;
+constexpr int kSamplesPerFrame = kSampleRate * kFrameMs / 1000;
+constexpr int WARMUP_FRAMES = 100;
+// 每路合成音频的长度（循环读取）
+constexpr int kSignalSeconds = 4;
+
+using Clock = std::chrono::steady_clock;
+
+// ==================== 统计 ====================
+
+struct StageResult
+{
+  QString stage;
+  int participants = 0;
+  std::vector<qint64> frameNs; // 每次计时的耗时
+  qint64 framesProduced = 0;   // 计时区间内产出的 10ms 帧数
+  quint64 allocations = 0;     // 计时区间内的 operator new 次数
+  QJsonObject extra;
+};
+
+qint64 percentile(const std::vector<qint64> &sorted, double p)
+{
+  if (sorted.empty())
+    return 0;
+  const size_t rank = static_cast<size_t>(p * (sorted.size() - 1));
+  return sorted[rank];
+}
+
+QJsonObject toJson(StageResult &r)
+{
+  std::sort(r.frameNs.begin(), r.frameNs.end());
+  qint64 total = 0;
+  for (qint64 ns : r.frameNs)
+    total += ns;
+  const qint64 frames = std::max<qint64>(1, r.framesProduced);
+
+  QJsonObject obj;
+  obj[QStringLiteral("stage")] = r.stage;
+  obj[QStringLiteral("participants")] = r.participants;
+  obj[QStringLiteral("frames")] = static_cast<double>(r.framesProduced);
+  obj[QStringLiteral("ns_per_frame")] = static_cast<double>(total) / frames;
+  obj[QStringLiteral("p50_ns")] =
+      static_cast<double>(percentile(r.frameNs, 0.50));
+  obj[QStringLiteral("p99_ns")] =
+      static_cast<double>(percentile(r.frameNs, 0.99));
+  obj[QStringLiteral("max_ns")] =
+      static_cast<double>(r.frameNs.empty() ? 0 : r.frameNs.back());
+  obj[QStringLiteral("allocs_per_frame")] =
+      static_cast<double>(r.allocations) / frames;
+  for (auto it = r.extra.cbegin(); it != r.extra.cend(); ++it)
+    obj[it.key()] = it.value();
+  return obj;
+}
+
+// ==================== 合成音频 ====================
+
+/**
+ * 类语音信号：基频 + 两个谐波，按参会者错开的「说话 / 停顿」包络调制，
+ * 电平各不相同，使 VAD 与 top-N 排序有实际工作量。
+ */
+std::vector<int16_t> makeSpeechLike(int index, int sampleRate, int seconds)
+{
+  std::mt19937 rng(1000u + static_cast<unsigned>(index));
+  std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+
+  const int count = sampleRate * seconds;
+  const float f0 = 110.0f + 17.0f * static_cast<float>(index % 11);
+  const float amplitude = 2000.0f + 600.0f * static_cast<float>(index % 13);
+  // 说话 / 停顿周期 1~2.5s，占空比约 60%
+  const int burstPeriod = sampleRate * (10 + (index % 16)) / 10;
+  const int burstOffset = (index * sampleRate / 7) % burstPeriod;
+  const float twoPi = 6.28318530718f;
+
+  std::vector<int16_t> pcm(count);
+  for (int i = 0; i < count; ++i)
+  {
+    const float t = static_cast<float>(i) / static_cast<float>(sampleRate);
+    const bool talking =
+        ((i + burstOffset) % burstPeriod) < burstPeriod * 6 / 10;
+    float v = 0.02f * noise(rng); // 底噪
+    if (talking)
+    {
+      v += std::sin(twoPi * f0 * t) + 0.5f * std::sin(twoPi * 2 * f0 * t) +
+           0.25f * std::sin(twoPi * 3 * f0 * t);
+    }
+    pcm[i] = static_cast<int16_t>(
+        std::clamp(v * amplitude, -32768.0f, 32767.0f));
+  }
+  return pcm;
+}
+
+// 从循环信号中取出第 frame 帧（不拷贝，引用原始数据）
+QByteArray frameView(const std::vector<int16_t> &signal, qint64 frame)
+{
+  const qint64 framesInSignal =
+      static_cast<qint64>(signal.size()) / kSamplesPerFrame;
+  const qint64 offset = (frame % framesInSignal) * kSamplesPerFrame;
+  return QByteArray::fromRawData(
+      reinterpret_cast<const char *>(signal.data() + offset),
+      kSamplesPerFrame * static_cast<int>(sizeof(int16_t)));
+}
+
+// ==================== 阶段：采集分帧 ====================
+
+StageResult benchCaptureFraming(int frames)
+{
+  // 与 AudioFrameHandler::writeData() / processAndSendFrames() 相同的
+  // vector 追加 + 逐帧拷出 + erase；采集块长度随机（设备回调大小不固定）
+  const std::vector<int16_t> signal = makeSpeechLike(0, kSampleRate, 1);
+  std::mt19937 rng(42u);
+  std::uniform_int_distribution<int> chunkDist(kSamplesPerFrame / 2,
+                                               kSamplesPerFrame * 3 / 2);
+
+  std::vector<int16_t> frameBuffer;
+  size_t readPos = 0;
+  qint64 sink = 0;
+
+  StageResult r;
+  r.stage = QStringLiteral("capture_framing");
+  r.participants = 1;
+  r.frameNs.reserve(frames);
+
+  auto feedChunk = [&]() -> int {
+    const int chunk = chunkDist(rng);
+    if (readPos + chunk > signal.size())
+      readPos = 0;
+    const int16_t *samples = signal.data() + readPos;
+    readPos += chunk;
+
+    frameBuffer.insert(frameBuffer.end(), samples, samples + chunk);
+
+    int produced = 0;
+    while (static_cast<int>(frameBuffer.size()) >= kSamplesPerFrame)
+    {
+      std::vector<int16_t> frameData(frameBuffer.begin(),
+                                     frameBuffer.begin() + kSamplesPerFrame);
+      frameBuffer.erase(frameBuffer.begin(),
+                        frameBuffer.begin() + kSamplesPerFrame);
+      sink += frameData[0];
+      ++produced;
+    }
+    return produced;
+  };
+
+  for (int i = 0; i < WARMUP_FRAMES; ++i)
+    feedChunk();
+
+  const quint64 allocBefore = g_newCount.load(std::memory_order_relaxed);
+  for (int i = 0; i < frames; ++i)
+  {
+    const auto start = Clock::now();
+    r.framesProduced += feedChunk();
+    r.frameNs.push_back(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                             start)
+            .count());
+  }
+  // frameNs 已预留，push_back 不产生分配
+  r.allocations = g_newCount.load(std::memory_order_relaxed) - allocBefore;
+  r.extra[QStringLiteral("checksum")] = static_cast<double>(sink);
+  return r;
+}
+
+// ==================== 阶段：ASR 降采样 ====================
+
+StageResult benchAsrDownsample(int frames)
+{
+  const std::vector<int16_t> signal = makeSpeechLike(0, kSampleRate, 1);
+  qint64 outBytes = 0;
+
+  StageResult r;
+  r.stage = QStringLiteral("asr_downsample");
+  r.participants = 1;
+  r.frameNs.reserve(frames);
+
+  for (int i = 0; i < WARMUP_FRAMES; ++i)
+    outBytes +=
+        AIAssistant::downsampleForAsr(frameView(signal, i), kSampleRate, 1)
+            .size();
+
+  const quint64 allocBefore = g_newCount.load(std::memory_order_relaxed);
+  for (int i = 0; i < frames; ++i)
+  {
+    const QByteArray in = frameView(signal, i);
+    const auto start = Clock::now();
+    const QByteArray out =
+        AIAssistant::downsampleForAsr(in, kSampleRate, 1);
+    r.frameNs.push_back(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                             start)
+            .count());
+    outBytes += out.size();
+  }
+  r.framesProduced = frames;
+  r.allocations = g_newCount.load(std::memory_order_relaxed) - allocBefore;
+  r.extra[QStringLiteral("output_bytes")] = static_cast<double>(outBytes);
+  return r;
+}
+
+// ==================== 阶段：AudioMixer ====================
+
+enum class MixerMode
+{
+  All,
+  Top4,
+  MixMinus
+};
+
+StageResult benchMixer(MixerMode mode, int participants, int frames)
+{
+  AudioMixer mixer(nullptr, AudioMixer::Pacing::Manual);
+  if (mode == MixerMode::Top4)
+    mixer.setMaxActiveSpeakers(4);
+  if (mode == MixerMode::MixMinus)
+    mixer.setMixMinusEnabled(true);
+
+  // 合成信号与输入句柄在计时前准备好
+  const std::vector<int16_t> local = makeSpeechLike(0, kSampleRate,
+                                                    kSignalSeconds);
+  std::vector<std::vector<int16_t>> signals;
+  std::vector<std::shared_ptr<AudioMixerInput>> inputs;
+  signals.reserve(participants);
+  inputs.reserve(participants);
+  for (int p = 0; p < participants; ++p)
+  {
+    const QString id = QStringLiteral("p%1").arg(p);
+    signals.push_back(makeSpeechLike(p + 1, kSampleRate, kSignalSeconds));
+    inputs.push_back(mixer.remoteInput(id));
+  }
+
+  // 与 main.cpp 相同的下游输出与连接方式：
+  // - 16kHz int16 → ASR：DirectConnection 写入 SPSC 环形缓冲，另一端取出
+  //   追加到预留好的录音缓冲（同 AIAssistant::pushAsrAudio / drainAsrAudio）
+  // - 48kHz float planar → 录制：DirectConnection（MeetingRecorder 自身加锁）
+  // mixedAudioReady 在 main.cpp 中没有连接，这里同样不连接
+  qint64 outBytes = 0;
+  AudioRingBuffer asrRing(16000 * 4);
+  std::vector<int16_t> asrRecord(16000);
+  QObject::connect(
+      mixer.output({16000, AudioOutputFormat::SampleFormat::Int16}),
+      &AudioMixerOutput::audioReady, &mixer,
+      [&asrRing](const QByteArray &data, int sampleRate, int channels) {
+        const QByteArray pcm =
+            AIAssistant::downsampleForAsr(data, sampleRate, channels);
+        asrRing.write(reinterpret_cast<const int16_t *>(pcm.constData()),
+                      pcm.size() / static_cast<int>(sizeof(int16_t)));
+      },
+      Qt::DirectConnection);
+  QObject::connect(
+      mixer.output({kSampleRate, AudioOutputFormat::SampleFormat::FloatPlanar}),
+      &AudioMixerOutput::audioReady, &mixer,
+      [&outBytes](const QByteArray &data, int, int) {
+        outBytes += data.size();
+      },
+      Qt::DirectConnection);
+  if (mode == MixerMode::MixMinus)
+  {
+    // main.cpp 尚未使用 mix-minus 总线；按线程安全消费者的方式直接连接
+    for (int p = 0; p < participants; ++p)
+    {
+      QObject::connect(mixer.mixMinusOutput(QStringLiteral("p%1").arg(p)),
+                       &AudioMixerOutput::audioReady, &mixer,
+                       [&outBytes](const QByteArray &data, int, int) {
+                         outBytes += data.size();
+                       },
+                       Qt::DirectConnection);
+    }
+  }
+
+  auto runFrame = [&](qint64 frame) {
+    for (int p = 0; p < participants; ++p)
+      inputs[p]->push(frameView(signals[p], frame), kSampleRate, 1);
+    mixer.feedLocalAudio(frameView(local, frame), kSampleRate, 1);
+    mixer.runTick();
+    const int asrSamples =
+        asrRing.read(asrRecord.data(), static_cast<int>(asrRecord.size()));
+    outBytes += asrSamples * static_cast<qint64>(sizeof(int16_t));
+  };
+
+  static const char *const kStageNames[] = {"mixer", "mixer_top4",
+                                            "mixer_mix_minus"};
+  StageResult r;
+  r.stage = QString::fromLatin1(kStageNames[static_cast<int>(mode)]);
+  r.participants = participants;
+  r.frameNs.reserve(frames);
+
+  for (int i = 0; i < WARMUP_FRAMES; ++i)
+    runFrame(i);
+
+  const quint64 mixerAllocBefore = mixer.allocationCount();
+  const quint64 allocBefore = g_newCount.load(std::memory_order_relaxed);
+  for (int i = 0; i < frames; ++i)
+  {
+    const auto start = Clock::now();
+    runFrame(WARMUP_FRAMES + i);
+    r.frameNs.push_back(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                             start)
+            .count());
+  }
+  r.allocations = g_newCount.load(std::memory_order_relaxed) - allocBefore;
+  r.framesProduced = frames;
+
+  r.extra[QStringLiteral("mixer_allocations")] =
+      static_cast<double>(mixer.allocationCount() - mixerAllocBefore);
+  r.extra[QStringLiteral("active_speakers")] =
+      static_cast<int>(mixer.activeSpeakers().size());
+  r.extra[QStringLiteral("output_bytes")] = static_cast<double>(outBytes);
+  return r;
+}
+
+// ==================== 命令行 ====================
+
+struct Options
+{
+  QList<int> participants{1, 4, 16, 64};
+  int frames = 3000;
+  QString outputPath;
+};
+
+bool parseOptions(const QStringList &args, Options &opt)
+{
+  for (int i = 1; i < args.size(); ++i)
+  {
+    const QString &arg = args[i];
+    const bool hasValue = i + 1 < args.size();
+    if (arg == QLatin1String("--participants") && hasValue)
+    {
+      opt.participants.clear();
+      for (const QString &v : args[++i].split(',', Qt::SkipEmptyParts))
+      {
+        bool ok = false;
+        const int n = v.toInt(&ok);
+        if (!ok || n <= 0)
+          return false;
+        opt.participants.append(n);
+      }
+    }
+    else if (arg == QLatin1String("--frames") && hasValue)
+    {
+      bool ok = false;
+      opt.frames = args[++i].toInt(&ok);
+      if (!ok || opt.frames <= 0)
+        return false;
+    }
+    else if (arg == QLatin1String("--output") && hasValue)
+    {
+      opt.outputPath = args[++i];
+    }
+    else
+    {
+      return false;
+    }
+  }
+  return !opt.participants.isEmpty();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  Options opt;
+  if (!parseOptions(app.arguments(), opt))
+  {
+    QTextStream(stderr)
+        << "用法: MeetingAppBench [--participants 1,4,16,64] "
+           "[--frames 3000] [--output result.json]\n";
+    return 1;
+  }
+
+  QJsonArray results;
+  {
+    StageResult r = benchCaptureFraming(opt.frames);
+    results.append(toJson(r));
+  }
+  {
+    StageResult r = benchAsrDownsample(opt.frames);
+    results.append(toJson(r));
+  }
+  for (MixerMode mode : {MixerMode::All, MixerMode::Top4, MixerMode::MixMinus})
+  {
+    for (int participants : opt.participants)
+    {
+      StageResult r = benchMixer(mode, participants, opt.frames);
+      results.append(toJson(r));
+    }
+  }
+
+  QJsonObject root;
+  root[QStringLiteral("benchmark")] = QStringLiteral("MeetingAppBench");
+  root[QStringLiteral("frame_ms")] = kFrameMs;
+  root[QStringLiteral("sample_rate")] = kSampleRate;
+  root[QStringLiteral("frames")] = opt.frames;
+  root[QStringLiteral("warmup_frames")] = WARMUP_FRAMES;
+  root[QStringLiteral("mix_kernel")] = QString::fromLatin1(
+      AudioMixKernel::implementationName(
+          AudioMixKernel::activeImplementation()));
+  root[QStringLiteral("results")] = results;
+
+  const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+  if (opt.outputPath.isEmpty())
+  {
+    QTextStream(stdout) << json;
+  }
+  else
+  {
+    QFile file(opt.outputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+      QTextStream(stderr) << "无法写入: " << opt.outputPath << "\n";
+      return 1;
+    }
+    file.write(json);
+    QTextStream(stdout) << "结果已写入 " << opt.outputPath << "\n";
+  }
+  return 0;
+}
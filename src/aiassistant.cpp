@@ -16,11 +16,13 @@ AIAssistant::AIAssistant(QObject *parent)
     : QObject(parent), m_networkManager(new QNetworkAccessManager(this)),
       m_serverUrl("http://8.162.3.195:3000"), m_isBusy(false),
       m_isRecordingAudio(false), m_isTranscribing(false),
-      m_recordingTimer(new QTimer(this)), m_recordingSeconds(0)
+      m_asrRing(ASR_RING_SAMPLES), m_recordingTimer(new QTimer(this)),
+      m_recordingSeconds(0)
 {
-  // 录音计时器：每秒更新录音时长显示
+  // 录音计时器：每秒更新录音时长显示，并取出混音线程送来的音频
   connect(m_recordingTimer, &QTimer::timeout, this, [this]()
           {
+    drainAsrAudio();
     m_recordingSeconds++;
     emit recordingDurationChanged(); });
 
@@ -263,6 +265,9 @@ void AIAssistant::startRecording()
                               5); // 预分配 5 分钟容量 (16kHz, 16-bit, mono)
   m_recordingSeconds = 0;
   m_isRecordingAudio = true;
+  // 丢弃上次停止后混音线程可能写入的残留数据，再开始接收
+  m_asrRing.skip(m_asrRing.available());
+  m_asrCapturing.store(true, std::memory_order_release);
   m_recordingTimer->start(1000); // 每秒更新
 
   emit recordingAudioChanged();
@@ -282,7 +287,9 @@ void AIAssistant::stopRecordingAndTranscribe()
 
   // 停止录音
   m_isRecordingAudio = false;
+  m_asrCapturing.store(false, std::memory_order_release);
   m_recordingTimer->stop();
+  drainAsrAudio();
   emit recordingAudioChanged();
 
   int bufferSize = m_audioRecordBuffer.size();
@@ -382,60 +389,99 @@ void AIAssistant::feedAudioData(const QByteArray &pcmData, int sampleRate,
   if (!m_isRecordingAudio)
     return;
 
+  // 追加到本地录音缓冲区
+  m_audioRecordBuffer.append(downsampleForAsr(pcmData, sampleRate, channels));
+}
+
+void AIAssistant::pushAsrAudio(const QByteArray &pcmData, int sampleRate,
+                               int channels)
+{
+  // 混音线程调用：只读原子标志、写环形缓冲，不触碰其它成员
+  if (!m_asrCapturing.load(std::memory_order_acquire))
+    return;
+
+  const QByteArray pcm = downsampleForAsr(pcmData, sampleRate, channels);
+  m_asrRing.write(reinterpret_cast<const int16_t *>(pcm.constData()),
+                  pcm.size() / static_cast<int>(sizeof(int16_t)));
+}
+
+void AIAssistant::drainAsrAudio()
+{
+  const int samples = m_asrRing.available();
+  if (samples > 0)
+  {
+    // 录音开始时已预留 5 分钟容量，resize 通常不重新分配
+    const int offset = m_audioRecordBuffer.size();
+    m_audioRecordBuffer.resize(offset +
+                               samples * static_cast<int>(sizeof(int16_t)));
+    m_asrRing.read(
+        reinterpret_cast<int16_t *>(m_audioRecordBuffer.data() + offset),
+        samples);
+  }
+
+  const uint64_t dropped = m_asrRing.droppedSamples();
+  if (dropped != m_asrDroppedReported)
+  {
+    qWarning() << "[AIAssistant] ASR 环形缓冲溢出，累计丢弃采样:" << dropped;
+    m_asrDroppedReported = dropped;
+  }
+}
+
+QByteArray AIAssistant::downsampleForAsr(const QByteArray &pcmData,
+                                         int sampleRate, int channels)
+{
   const int targetRate = 16000; // ASR 要求 16kHz
-  QByteArray chunk;
 
   if (sampleRate == targetRate && channels == 1)
   {
     // 已经是 16kHz 单声道，直接使用
-    chunk = pcmData;
+    return pcmData;
   }
-  else
-  {
-    // --- 带低通滤波的降采样 + 混音到单声道 ---
-    const int16_t *src = reinterpret_cast<const int16_t *>(pcmData.constData());
-    int totalSamples = pcmData.size() / sizeof(int16_t);
-    int frames = totalSamples / channels;
+  if (channels <= 0)
+    return QByteArray();
 
-    int ratio = sampleRate / targetRate;
-    if (ratio < 1)
-      ratio = 1;
+  // --- 带低通滤波的降采样 + 混音到单声道 ---
+  const int16_t *src = reinterpret_cast<const int16_t *>(pcmData.constData());
+  int totalSamples = pcmData.size() / sizeof(int16_t);
+  int frames = totalSamples / channels;
 
-    int outFrames = frames / ratio;
-    chunk.resize(outFrames * static_cast<int>(sizeof(int16_t)));
-    int16_t *dst = reinterpret_cast<int16_t *>(chunk.data());
+  int ratio = sampleRate / targetRate;
+  if (ratio < 1)
+    ratio = 1;
 
-    for (int i = 0; i < outFrames; ++i)
+  int outFrames = frames / ratio;
+  QByteArray chunk;
+  chunk.resize(outFrames * static_cast<int>(sizeof(int16_t)));
+  int16_t *dst = reinterpret_cast<int16_t *>(chunk.data());
+
+  for (int i = 0; i < outFrames; ++i)
+  {
+    // 对 ratio 个输入帧取平均值（简单低通滤波，防止混叠）
+    int64_t sum = 0;
+    int count = 0;
+    for (int j = 0; j < ratio; ++j)
     {
-      // 对 ratio 个输入帧取平均值（简单低通滤波，防止混叠）
-      int64_t sum = 0;
-      int count = 0;
-      for (int j = 0; j < ratio; ++j)
-      {
-        int srcFrame = i * ratio + j;
-        if (srcFrame >= frames)
-          break;
+      int srcFrame = i * ratio + j;
+      if (srcFrame >= frames)
+        break;
 
-        if (channels == 1)
-        {
-          sum += src[srcFrame];
-        }
-        else
-        {
-          // 多声道混音：取所有声道平均值
-          int32_t chSum = 0;
-          for (int ch = 0; ch < channels; ++ch)
-            chSum += src[srcFrame * channels + ch];
-          sum += chSum / channels;
-        }
-        count++;
+      if (channels == 1)
+      {
+        sum += src[srcFrame];
       }
-      dst[i] = static_cast<int16_t>(count > 0 ? sum / count : 0);
+      else
+      {
+        // 多声道混音：取所有声道平均值
+        int32_t chSum = 0;
+        for (int ch = 0; ch < channels; ++ch)
+          chSum += src[srcFrame * channels + ch];
+        sum += chSum / channels;
+      }
+      count++;
     }
+    dst[i] = static_cast<int16_t>(count > 0 ? sum / count : 0);
   }
-
-  // 追加到本地录音缓冲区
-  m_audioRecordBuffer.append(chunk);
+  return chunk;
 }
 
 QVariantList AIAssistant::getTranscripts() const
@@ -479,7 +525,9 @@ void AIAssistant::saveRecordingToFile()
 
   // 停止录音
   m_isRecordingAudio = false;
+  m_asrCapturing.store(false, std::memory_order_release);
   m_recordingTimer->stop();
+  drainAsrAudio();
   emit recordingAudioChanged();
 
   int bufferSize = m_audioRecordBuffer.size();
@@ -27,6 +27,10 @@
 #include <QTimer>
 #include <QVariantList>
 
+#include <atomic>
+
+#include "audioringbuffer.h"
+
 /**
  * @brief 一条转录记录
  */
@@ -89,6 +93,17 @@ public:
   void setRoomName(const QString &name);
   void setUserName(const QString &name);
 
+  // ====== 音频工具 ======
+
+  /**
+   * @brief 将任意采样率 / 声道的 int16 PCM 转为 ASR 所需的 16kHz 单声道
+   *
+   * 整数倍降采样，每 ratio 帧取平均（简单低通）；已是 16kHz 单声道时
+   * 直接返回原数据（隐式共享，不拷贝）。
+   */
+  static QByteArray downsampleForAsr(const QByteArray &pcmData, int sampleRate,
+                                     int channels);
+
 public slots:
   // ====== AI 对话接口（QML 可调用） ======
 
@@ -137,6 +152,18 @@ public slots:
    */
   void feedAudioData(const QByteArray &pcmData, int sampleRate, int channels);
 
+  /**
+   * @brief 从混音线程直接接收 ASR 音频（DirectConnection，线程安全）
+   * @param pcmData int16 PCM（AudioMixer 登记的 16kHz 单声道输出）
+   * @param sampleRate 采样率
+   * @param channels 声道数
+   *
+   * 录音时写入 SPSC 环形缓冲（混音线程为唯一生产者），GUI 线程每秒
+   * 及停止录音时取出追加到录音缓冲区。不经事件循环排队，每周期没有
+   * QMetaCallEvent 分配；格式已是 16kHz 单声道时写入路径零分配。
+   */
+  void pushAsrAudio(const QByteArray &pcmData, int sampleRate, int channels);
+
   /**
    * @brief 获取所有转录记录（供会议纪要使用）
    */
@@ -256,6 +283,14 @@ private:
    */
   QString recordingsDir() const;
 
+  /**
+   * @brief 取出 m_asrRing 中已有的音频，追加到录音缓冲区（GUI 线程）
+   */
+  void drainAsrAudio();
+
+  // m_asrRing 容量：GUI 线程每秒取一次，留 4 秒余量
+  static constexpr int ASR_RING_SAMPLES = 16000 * 4;
+
   /**
    * @brief 保存/读取录音元数据到 QSettings
    */
@@ -282,6 +317,9 @@ private:
   bool m_isRecordingAudio;              // 是否正在录音
   bool m_isTranscribing;                // 是否正在转录中（等待服务端返回）
   QByteArray m_audioRecordBuffer;       // 本地 PCM 录音缓冲（16kHz mono 16-bit）
+  AudioRingBuffer m_asrRing;            // 混音线程 → GUI 线程的 ASR 音频（SPSC）
+  std::atomic<bool> m_asrCapturing{false}; // 混音线程是否写入 m_asrRing
+  uint64_t m_asrDroppedReported = 0;    // 已上报的溢出丢弃采样数
   QTimer *m_recordingTimer;             // 录音计时器（更新时长显示）
   int m_recordingSeconds;               // 已录音秒数
   QList<TranscriptEntry> m_transcripts; // 全部已确认的转录历史
@@ -0,0 +1,50 @@
+/**
+ * @file audiobufferpool.cpp
+ * @brief PCM 输出缓冲池实现
+ */
+
+#include "audiobufferpool.h"
+#include <QtGlobal>
+
+AudioBufferPool::AudioBufferPool(int initialBuffers, int bufferBytes,
+                                 int maxBuffers)
+    : m_maxBuffers(qMax(maxBuffers, initialBuffers))
+{
+  m_buffers.reserve(m_maxBuffers);
+  for (int i = 0; i < initialBuffers; ++i)
+  {
+    m_buffers.append(QByteArray(bufferBytes, Qt::Uninitialized));
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+QByteArray &AudioBufferPool::acquire(int bytes)
+{
+  const int count = m_buffers.size();
+
+  // 轮转查找下游已释放的槽位
+  for (int n = 0; n < count; ++n)
+  {
+    QByteArray &buf = m_buffers[(m_next + n) % count];
+    if (!buf.isDetached())
+      continue;
+
+    m_next = (m_next + n + 1) % count;
+    if (buf.capacity() < bytes)
+      m_allocations.fetch_add(1, std::memory_order_relaxed);
+    // 独占且容量足够时 resize 不会重新分配
+    buf.resize(bytes);
+    return buf;
+  }
+
+  // 所有槽位都被下游持有：扩容，超过上限则临时分配
+  m_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (count < m_maxBuffers)
+  {
+    m_buffers.append(QByteArray(bytes, Qt::Uninitialized));
+    m_next = 0;
+    return m_buffers.last();
+  }
+  m_overflow = QByteArray(bytes, Qt::Uninitialized);
+  return m_overflow;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file audiobufferpool.h
+ * @brief 可复用的 PCM 输出缓冲池
+ *
+ * AudioMixer 每个混音周期都要发出一块 QByteArray。QByteArray 是隐式共享的，
+ * 下游（AIAssistant / MeetingRecorder）持有引用期间该缓冲不可复用；
+ * 一旦所有下游释放引用（isDetached()），即可原地重写而无需重新分配。
+ *
+ * 缓冲池按轮转顺序查找空闲槽位，全部被占用时新增槽位（上限 maxBuffers），
+ * 超过上限才退化为临时分配。所有分配都会计入 allocationCount()。
+ *
+ * 线程约束：acquire() 只能在混音线程调用；allocationCount() 可跨线程读取。
+ */
+
+#ifndef AUDIOBUFFERPOOL_H
+#define AUDIOBUFFERPOOL_H
+
+#include <QByteArray>
+#include <QVector>
+#include <atomic>
+
+class AudioBufferPool
+{
+public:
+  /**
+   * @param initialBuffers 预分配的缓冲数量
+   * @param bufferBytes 每块缓冲的初始容量（字节）
+   * @param maxBuffers 槽位上限
+   */
+  AudioBufferPool(int initialBuffers, int bufferBytes, int maxBuffers);
+
+  /**
+   * @brief 取得一块大小为 bytes 的独占缓冲
+   *
+   * 返回的引用在下一次 acquire() 之前有效。调用方应先写入数据
+   * （此时引用计数为 1，data() 不会触发拷贝），再将其按值发出。
+   */
+  QByteArray &acquire(int bytes);
+
+  /** @brief 自构造以来的堆分配次数（含预分配） */
+  quint64 allocationCount() const
+  {
+    return m_allocations.load(std::memory_order_relaxed);
+  }
+
+  /** @brief 当前槽位数量 */
+  int size() const { return m_buffers.size(); }
+
+private:
+  QVector<QByteArray> m_buffers;
+  QByteArray m_overflow; // 超过上限时的临时缓冲
+  int m_next = 0;
+  int m_maxBuffers;
+  std::atomic<quint64> m_allocations{0};
+};
+
+#endif // AUDIOBUFFERPOOL_H
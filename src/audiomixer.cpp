@@ -4,210 +4,605 @@
  */
 
 #include "audiomixer.h"
+#include "audiomixkernel.h"
 #include <QDebug>
 #include <QtGlobal>
+#include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <thread>
+#include <utility>
+
+#ifdef Q_OS_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#include <timeapi.h>
+#elif defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+// scratch arena 预留：32 路输入 × 100ms @48kHz，覆盖常见会议规模与采集块大小
+constexpr int ARENA_RESERVE_INPUTS = 32;
+constexpr int ARENA_RESERVE_SAMPLES = 48000 / 10;
+
+// 输出缓冲池：预分配 8 块 100ms，最多 32 块（下游排队时扩容）
+constexpr int OUTPUT_POOL_INITIAL = 8;
+constexpr int OUTPUT_POOL_MAX = 32;
+
+// mix-minus 缓冲池：按需增长（每条总线每周期一块），上限 64 块
+constexpr int MIX_MINUS_POOL_MAX = 64;
+
+// top-N 排序加成：正在说话的输入优先于任何背景噪声；
+// 已选中的输入加少量滞回，避免电平相近的两路逐周期来回切换
+constexpr float SPEAKING_BONUS_DB = 40.0f;
+constexpr float SELECTED_HYSTERESIS_DB = 3.0f;
+
+// 本地麦克风直通模式最大积压：吸收采集与混音时钟漂移及 GUI 线程短暂阻塞
+constexpr int LOCAL_MAX_BACKLOG_SAMPLES = 48000 / 10;
+
+// 迟到超过该周期数时放弃追赶，直接与当前时刻重新对齐（系统挂起 / 断点）
+constexpr int MAX_CATCHUP_TICKS = 10;
 
-AudioMixer::AudioMixer(QObject *parent) : QObject(parent)
+// 所有输入静默后继续输出的周期数，保证抖动缓冲的丢包隐藏能平滑收尾
+constexpr int IDLE_GRACE_TICKS = 20;
+
+// 提升当前线程的调度优先级（失败时保持默认优先级继续运行）
+void raiseMixThreadPriority()
 {
-  // 定时混音：当本地麦克风未提供数据时，仍然输出远程音频
-  m_mixTimer = new QTimer(this);
-  m_mixTimer->setInterval(MIX_INTERVAL_MS);
-  connect(m_mixTimer, &QTimer::timeout, this, &AudioMixer::onMixTimer);
-  m_mixTimer->start();
+#ifdef Q_OS_WIN
+  // QThread::TimeCriticalPriority 已设置线程优先级，这里只需提高系统定时器精度
+  timeBeginPeriod(1);
+#elif defined(Q_OS_LINUX)
+  // SCHED_OTHER 下 QThread 优先级无效，尝试实时调度（需要 CAP_SYS_NICE）
+  sched_param param{};
+  param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 10;
+  if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+  {
+    qDebug() << "[AudioMixer] 无法设置实时调度策略，使用默认优先级";
+  }
+#endif
+}
 
-  qDebug() << "[AudioMixer] 初始化完成";
+void restoreMixThreadPriority()
+{
+#ifdef Q_OS_WIN
+  timeEndPeriod(1);
+#endif
 }
+} // namespace
+
+AudioMixer::AudioMixer(QObject *parent, Pacing pacing)
+    : QObject(parent),
+      m_minusPool(0, ARENA_RESERVE_SAMPLES * static_cast<int>(sizeof(int16_t)),
+                  MIX_MINUS_POOL_MAX),
+      m_outputPool(OUTPUT_POOL_INITIAL,
+                   ARENA_RESERVE_SAMPLES * static_cast<int>(sizeof(int16_t)),
+                   OUTPUT_POOL_MAX)
+{
+  m_clock.start();
+
+  m_localInput = std::make_shared<AudioMixerInput>(
+      QStringLiteral("local"), &m_clock, &m_outputSampleRate);
+  m_localInput->setMaxBacklogSamples(LOCAL_MAX_BACKLOG_SAMPLES);
+
+  // 预留 scratch arena，使稳态混音不再触发扩容
+  reserveScratch(ARENA_RESERVE_INPUTS, ARENA_RESERVE_SAMPLES);
+  m_candidates.reserve(ARENA_RESERVE_INPUTS);
+  m_speakerScratch.reserve(ARENA_RESERVE_INPUTS);
+  m_activeSet.reserve(ARENA_RESERVE_INPUTS);
+
+  // 独立混音线程：不依赖 GUI 事件循环
+  if (pacing == Pacing::RealTimeThread)
+  {
+    m_running.store(true, std::memory_order_release);
+    m_mixThread = QThread::create([this]() { mixLoop(); });
+    m_mixThread->setObjectName(QStringLiteral("AudioMixer"));
+    m_mixThread->start(QThread::TimeCriticalPriority);
+  }
+
+  qDebug() << "[AudioMixer] 初始化完成, 混音内核:"
+           << AudioMixKernel::implementationName(
+                  AudioMixKernel::activeImplementation())
+           << "周期:" << MIX_INTERVAL_MS << "ms"
+           << (pacing == Pacing::Manual ? "(手动驱动)" : "");
+}
+
+AudioMixer::~AudioMixer()
+{
+  m_running.store(false, std::memory_order_release);
+  if (m_mixThread)
+  {
+    m_mixThread->wait();
+    delete m_mixThread;
+    m_mixThread = nullptr;
+  }
 
-AudioMixer::~AudioMixer() { qDebug() << "[AudioMixer] 销毁"; }
+  const LatencyHistogram::Snapshot lateness = m_tickLateness.snapshot();
+  qDebug() << "[AudioMixer] 销毁, 混音周期:" << lateness.count
+           << "迟到 p50/p99/max(us):" << lateness.percentileUs(0.5)
+           << lateness.percentileUs(0.99) << lateness.maxUs
+           << "重新对齐:" << resyncCount();
+}
 
 void AudioMixer::feedLocalAudio(const QByteArray &pcmData, int sampleRate,
                                 int channels)
 {
-  // 本地麦克风数据到达 → 作为 master clock 触发一次混音
-  m_localAudioTimer.restart();
-  m_outputSampleRate = sampleRate;
+  if (pcmData.isEmpty() || sampleRate <= 0)
+    return;
+
+  // 本地麦克风采样率即输出采样率（先更新，使本块不被重采样）
+  m_outputSampleRate.store(sampleRate, std::memory_order_relaxed);
+  m_localInput->push(pcmData, sampleRate, channels);
+}
+
+void AudioMixer::mixLoop()
+{
+  using Clock = std::chrono::steady_clock;
+  const auto interval = std::chrono::milliseconds(MIX_INTERVAL_MS);
+
+  raiseMixThreadPriority();
+
+  auto deadline = Clock::now() + interval;
+  while (m_running.load(std::memory_order_acquire))
+  {
+    std::this_thread::sleep_until(deadline);
 
-  // 【关键修复】统一下混为单声道，防止立体声数据被误当做单声道处理导致乱码
-  const QByteArray &monoData =
-      (channels > 1) ? downmixToMono(pcmData, channels) : pcmData;
+    const auto lateness = Clock::now() - deadline;
+    m_tickLateness.record(
+        std::chrono::duration_cast<std::chrono::microseconds>(lateness)
+            .count());
 
-  const int localSampleCount =
-      static_cast<int>(monoData.size()) / static_cast<int>(sizeof(int16_t));
-  if (localSampleCount <= 0)
+    if (lateness > interval * MAX_CATCHUP_TICKS)
+    {
+      // 严重迟到：放弃追赶，避免之后连续突发输出
+      m_resyncCount.fetch_add(1, std::memory_order_relaxed);
+      deadline = Clock::now();
+    }
+
+    // 轻微迟到时 deadline 仍按固定步长推进，后续周期会立即连续执行以追上
+    const int outputRate = m_outputSampleRate.load(std::memory_order_relaxed);
+    mixTick(outputRate * MIX_INTERVAL_MS / 1000, outputRate);
+    deadline += interval;
+  }
+
+  restoreMixThreadPriority();
+}
+
+void AudioMixer::runTick()
+{
+  if (m_mixThread)
+  {
+    qWarning() << "[AudioMixer] 混音线程运行中，忽略 runTick()";
     return;
+  }
 
-  const auto *localSamples =
-      reinterpret_cast<const int16_t *>(monoData.constData());
+  const int outputRate = m_outputSampleRate.load(std::memory_order_relaxed);
+  mixTick(outputRate * MIX_INTERVAL_MS / 1000, outputRate);
+}
+
+bool AudioMixer::hasPendingInput() const
+{
+  if (m_localInput->hasData())
+    return true;
 
-  // 用 int32 临时缓冲来累加，防止溢出
-  std::vector<int32_t> mixBuf(localSampleCount);
-  for (int i = 0; i < localSampleCount; ++i)
+  QMutexLocker locker(&m_mutex);
+  for (auto it = m_remoteInputs.cbegin(); it != m_remoteInputs.cend(); ++it)
   {
-    mixBuf[i] = static_cast<int32_t>(localSamples[i]);
+    if (it.value()->hasData())
+      return true;
   }
+  return false;
+}
 
-  // 叠加所有远程参会者的缓冲区
+void AudioMixer::mixTick(int sampleCount, int sampleRate)
+{
+  if (sampleCount <= 0)
+    return;
+
+  // 所有输入静默一段时间后停止输出，并清空说话人集合
+  m_idleTicks = hasPendingInput() ? 0 : m_idleTicks + 1;
+  if (m_idleTicks > IDLE_GRACE_TICKS)
   {
-    QMutexLocker locker(&m_mutex);
-    for (auto it = m_remoteBuffers.begin(); it != m_remoteBuffers.end(); ++it)
-    {
-      QByteArray &remoteBuf = it.value();
-      if (remoteBuf.isEmpty())
-        continue;
-
-      const auto *remoteSamples =
-          reinterpret_cast<const int16_t *>(remoteBuf.constData());
-      const int remoteSampleCount = static_cast<int>(remoteBuf.size()) /
-                                    static_cast<int>(sizeof(int16_t));
-
-      // 取两者中较短的长度进行混合
-      const int mixLen = qMin(localSampleCount, remoteSampleCount);
-      for (int i = 0; i < mixLen; ++i)
-      {
-        mixBuf[i] += static_cast<int32_t>(remoteSamples[i]);
-      }
-
-      // 消费掉已混合的部分，保留多出来的数据等待下一轮
-      const int consumedBytes = qMin(localSampleCount, remoteSampleCount) *
-                                static_cast<int>(sizeof(int16_t));
-      remoteBuf.remove(0, consumedBytes);
-    }
+    m_candidates.clear();
+    updateActiveSpeakers();
+    return;
   }
 
-  // 钳位到 int16 范围
-  QByteArray output(localSampleCount * static_cast<int>(sizeof(int16_t)),
-                    Qt::Uninitialized);
-  auto *outSamples = reinterpret_cast<int16_t *>(output.data());
-  for (int i = 0; i < localSampleCount; ++i)
+  // 第 0 路为本地麦克风，其后为被选中的远程参会者
+  m_inputPtrs.clear();
+  m_inputOwners.clear();
+  reserveScratch(1, sampleCount);
+  if (m_localInput->pull(m_localScratch.data(), sampleCount, sampleRate,
+                         isTimestampedMixing()))
   {
-    outSamples[i] = static_cast<int16_t>(qBound(
-        static_cast<int32_t>(-32768), mixBuf[i], static_cast<int32_t>(32767)));
+    m_inputPtrs.push_back(m_localScratch.data());
+    m_inputOwners.push_back(m_localInput.get());
   }
+  collectRemoteInputs(sampleCount);
 
   // 始终输出单声道，与下游 MeetingRecorder/AIAssistant 的预期格式一致
-  emit mixedAudioReady(output, sampleRate, 1);
+  mixAndEmit(sampleCount, sampleRate);
 }
 
-void AudioMixer::feedRemoteAudio(const QString &participantId,
-                                 const QByteArray &pcmData, int sampleRate,
-                                 int channels)
+std::shared_ptr<AudioMixerInput>
+AudioMixer::remoteInput(const QString &participantId)
 {
-  Q_UNUSED(sampleRate)
+  QMutexLocker locker(&m_mutex);
+  auto it = m_remoteInputs.find(participantId);
+  if (it != m_remoteInputs.end())
+    return it.value();
 
-  if (pcmData.isEmpty())
-    return;
+  auto input = std::make_shared<AudioMixerInput>(participantId, &m_clock,
+                                                  &m_outputSampleRate);
+  m_remoteInputs.insert(participantId, input);
 
-  // 【关键修复】统一下混为单声道
-  const QByteArray &monoData =
-      (channels > 1) ? downmixToMono(pcmData, channels) : pcmData;
+  // 参会者重新加入：已登记的 mix-minus 总线改为指向新的输入端
+  for (MixMinusBus &bus : m_mixMinusBuses)
+  {
+    if (bus.participantId == participantId)
+      bus.input = input;
+  }
+  qDebug() << "[AudioMixer] 创建远程输入缓冲:" << participantId;
+  return input;
+}
 
+AudioMixerOutput *AudioMixer::output(const AudioOutputFormat &format)
+{
   QMutexLocker locker(&m_mutex);
-  m_remoteBuffers[participantId].append(monoData);
+  for (AudioMixerOutput *existing : std::as_const(m_outputs))
+  {
+    if (existing->format() == format)
+      return existing;
+  }
 
-  // 安全阀：防止某个远程流堆积过多数据（超过 2 秒 = 48000*2*2 bytes）
-  static constexpr int MAX_BUFFER_BYTES = 48000 * 2 * 2;
-  QByteArray &buf = m_remoteBuffers[participantId];
-  if (buf.size() > MAX_BUFFER_BYTES)
+  auto *created = new AudioMixerOutput(format, this);
+  m_outputs.append(created);
+  return created;
+}
+
+AudioMixerOutput *AudioMixer::mixMinusOutput(const QString &participantId,
+                                             const AudioOutputFormat &format)
+{
+  // 先解析输入端（remoteInput 自身加锁）
+  std::shared_ptr<AudioMixerInput> input =
+      participantId.isEmpty() ? m_localInput : remoteInput(participantId);
+
+  QMutexLocker locker(&m_mutex);
+  for (const MixMinusBus &bus : std::as_const(m_mixMinusBuses))
   {
-    buf.remove(0, buf.size() - MAX_BUFFER_BYTES);
+    if (bus.participantId == participantId && bus.output->format() == format)
+      return bus.output;
   }
+
+  auto *created = new AudioMixerOutput(format, this);
+  m_mixMinusBuses.append({participantId, input, created});
+  qDebug() << "[AudioMixer] 创建 mix-minus 总线:"
+           << (participantId.isEmpty() ? QStringLiteral("local") : participantId)
+           << format.toString();
+  return created;
+}
+
+void AudioMixer::setMixMinusEnabled(bool enabled)
+{
+  m_mixMinusEnabled.store(enabled, std::memory_order_relaxed);
+  qDebug() << "[AudioMixer] mix-minus 模式:" << (enabled ? "开启" : "关闭");
+}
+
+void AudioMixer::feedRemoteAudio(const QString &participantId,
+                                 const QByteArray &pcmData, int sampleRate,
+                                 int channels)
+{
+  if (pcmData.isEmpty())
+    return;
+
+  remoteInput(participantId)->push(pcmData, sampleRate, channels);
 }
 
 void AudioMixer::removeParticipant(const QString &participantId)
 {
   QMutexLocker locker(&m_mutex);
-  m_remoteBuffers.remove(participantId);
+  // 仅从表中摘除；生产者若仍持有句柄，缓冲区随最后一个引用一起释放
+  m_remoteInputs.remove(participantId);
   qDebug() << "[AudioMixer] 移除参会者缓冲:" << participantId;
 }
 
-QByteArray AudioMixer::downmixToMono(const QByteArray &pcmData, int channels)
+void AudioMixer::collectRemoteInputs(int sampleCount)
 {
-  if (channels <= 1)
-    return pcmData;
+  // 拷贝快照后立即释放锁（QMap 隐式共享，只增加引用计数）
+  QMap<QString, std::shared_ptr<AudioMixerInput>> inputs;
+  {
+    QMutexLocker locker(&m_mutex);
+    inputs = m_remoteInputs;
+  }
 
-  const auto *src =
-      reinterpret_cast<const int16_t *>(pcmData.constData());
-  const int totalSamples =
-      static_cast<int>(pcmData.size()) / static_cast<int>(sizeof(int16_t));
-  const int monoSamples = totalSamples / channels;
+  const int inputCount = static_cast<int>(inputs.size());
+  const int maxSpeakers = maxActiveSpeakers();
+  const int selectCount =
+      (maxSpeakers > 0 && inputCount > maxSpeakers) ? maxSpeakers : inputCount;
 
-  QByteArray mono(monoSamples * static_cast<int>(sizeof(int16_t)),
-                  Qt::Uninitialized);
-  auto *dst = reinterpret_cast<int16_t *>(mono.data());
+  // 每路被选中的远程输入占用 m_readScratch 中连续的 sampleCount 个采样
+  reserveScratch(selectCount + 1, sampleCount);
+  if (m_candidates.capacity() < static_cast<size_t>(inputCount))
+  {
+    m_candidates.reserve(inputCount);
+    m_scratchAllocations.fetch_add(1, std::memory_order_relaxed);
+  }
 
-  for (int i = 0; i < monoSamples; ++i)
+  // 电平 / VAD 由生产者线程维护，这里只读原子量
+  m_candidates.clear();
+  for (auto it = inputs.cbegin(); it != inputs.cend(); ++it)
   {
-    int32_t sum = 0;
-    for (int ch = 0; ch < channels; ++ch)
+    const std::shared_ptr<AudioMixerInput> &input = it.value();
+    SpeakerCandidate c{input, input->levelDb(), 0.0f, input->isSpeaking()};
+    c.score = c.levelDb + (c.speaking ? SPEAKING_BONUS_DB : 0.0f) +
+              (input->isMixSelected() ? SELECTED_HYSTERESIS_DB : 0.0f);
+    m_candidates.push_back(std::move(c));
+  }
+
+  // 只需要前 selectCount 名，不必完整排序
+  if (selectCount < inputCount)
+  {
+    std::nth_element(m_candidates.begin(), m_candidates.begin() + selectCount,
+                     m_candidates.end(),
+                     [](const SpeakerCandidate &a, const SpeakerCandidate &b)
+                     { return a.score > b.score; });
+  }
+
+  const int outputRate = m_outputSampleRate.load(std::memory_order_relaxed);
+  const bool timestamped = isTimestampedMixing();
+
+  int slot = 0;
+  for (int i = 0; i < inputCount; ++i)
+  {
+    AudioMixerInput *input = m_candidates[i].input.get();
+    const bool selected = i < selectCount;
+    input->setMixSelected(selected);
+    if (!selected)
     {
-      sum += src[i * channels + ch];
+      // 未选中：推进时间线但不拷贝数据
+      input->discard(sampleCount, outputRate, timestamped);
+      continue;
     }
-    dst[i] = static_cast<int16_t>(
-        qBound(static_cast<int32_t>(-32768), sum / channels,
-               static_cast<int32_t>(32767)));
+
+    int16_t *dst = m_readScratch.data() +
+                   static_cast<size_t>(slot) * static_cast<size_t>(sampleCount);
+    if (!input->pull(dst, sampleCount, outputRate, timestamped))
+      continue;
+    m_inputPtrs.push_back(dst);
+    m_inputOwners.push_back(input);
+    ++slot;
   }
-  return mono;
+
+  // 候选数组前 selectCount 个即本周期被混音的输入
+  m_candidates.resize(selectCount);
+  updateActiveSpeakers();
 }
 
-void AudioMixer::onMixTimer()
+void AudioMixer::updateActiveSpeakers()
 {
-  // 如果本地麦克风最近提供了数据，由 feedLocalAudio 驱动混音即可
-  if (m_localAudioTimer.isValid() &&
-      m_localAudioTimer.elapsed() < MIX_INTERVAL_MS * 2)
+  // 当前说话人集合：被选中且 VAD 判定为说话的输入（按指针排序后比较集合）
+  m_speakerScratch.clear();
+  for (const SpeakerCandidate &c : m_candidates)
   {
+    if (c.speaking)
+      m_speakerScratch.push_back(c.input.get());
+  }
+  std::sort(m_speakerScratch.begin(), m_speakerScratch.end());
+
+  const bool unchanged =
+      m_speakerScratch.size() == m_activeSet.size() &&
+      std::equal(m_speakerScratch.begin(), m_speakerScratch.end(),
+                 m_activeSet.begin(),
+                 [](const AudioMixerInput *a,
+                    const std::shared_ptr<AudioMixerInput> &b)
+                 { return a == b.get(); });
+  if (unchanged)
     return;
+
+  // 集合变化（低频事件）：按电平从高到低生成参会者列表
+  std::sort(m_candidates.begin(), m_candidates.end(),
+            [](const SpeakerCandidate &a, const SpeakerCandidate &b)
+            { return a.levelDb > b.levelDb; });
+
+  QStringList speakers;
+  m_activeSet.clear();
+  for (const SpeakerCandidate &c : m_candidates)
+  {
+    if (!c.speaking)
+      continue;
+    speakers.append(c.input->participantId());
+    m_activeSet.push_back(c.input);
   }
+  std::sort(m_activeSet.begin(), m_activeSet.end());
 
-  // 本地麦克风未提供数据，检查是否有远程音频需要输出
+  {
+    QMutexLocker locker(&m_mutex);
+    m_activeSpeakers = speakers;
+  }
+  emit activeSpeakersChanged(speakers);
+}
+
+void AudioMixer::setMaxActiveSpeakers(int count)
+{
+  m_maxActiveSpeakers.store(qMax(0, count), std::memory_order_relaxed);
+  qDebug() << "[AudioMixer] 最大混音说话人数:"
+           << (count > 0 ? QString::number(count) : QStringLiteral("不限"));
+}
+
+QStringList AudioMixer::activeSpeakers() const
+{
   QMutexLocker locker(&m_mutex);
+  return m_activeSpeakers;
+}
 
-  bool hasRemoteData = false;
-  for (auto it = m_remoteBuffers.cbegin(); it != m_remoteBuffers.cend(); ++it)
+void AudioMixer::setTimestampedMixing(bool enabled)
+{
+  m_timestampedMixing.store(enabled, std::memory_order_relaxed);
+  qDebug() << "[AudioMixer] 时间戳混音模式:" << (enabled ? "开启" : "关闭");
+}
+
+QList<AudioStreamStats> AudioMixer::streamStats() const
+{
+  QMap<QString, std::shared_ptr<AudioMixerInput>> inputs;
   {
-    if (!it.value().isEmpty())
-    {
-      hasRemoteData = true;
-      break;
-    }
+    QMutexLocker locker(&m_mutex);
+    inputs = m_remoteInputs;
   }
-  if (!hasRemoteData)
-    return;
 
-  // 生成 MIX_INTERVAL_MS 毫秒的静音作为本地音频，驱动远程音频输出
-  const int silenceSamples = m_outputSampleRate * MIX_INTERVAL_MS / 1000;
-  std::vector<int32_t> mixBuf(silenceSamples, 0);
+  const int outputRate = m_outputSampleRate.load(std::memory_order_relaxed);
+  QList<AudioStreamStats> result;
+  result.reserve(inputs.size());
+  for (auto it = inputs.cbegin(); it != inputs.cend(); ++it)
+    result.append(it.value()->stats(outputRate));
+  return result;
+}
 
-  for (auto it = m_remoteBuffers.begin(); it != m_remoteBuffers.end(); ++it)
+void AudioMixer::reserveScratch(int inputCount, int sampleCount)
+{
+  const size_t samples =
+      static_cast<size_t>(inputCount) * static_cast<size_t>(sampleCount);
+  if (m_readScratch.size() < samples)
   {
-    QByteArray &remoteBuf = it.value();
-    if (remoteBuf.isEmpty())
-      continue;
+    m_readScratch.resize(samples);
+    m_scratchAllocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (m_inputPtrs.capacity() < static_cast<size_t>(inputCount))
+  {
+    m_inputPtrs.reserve(inputCount);
+    m_inputOwners.reserve(inputCount);
+    m_minusPtrs.reserve(inputCount);
+    m_minusSlots.reserve(inputCount);
+    m_minusBuffers.reserve(inputCount);
+    m_scratchAllocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (m_localScratch.size() < static_cast<size_t>(sampleCount))
+  {
+    m_localScratch.resize(sampleCount);
+    m_scratchAllocations.fetch_add(1, std::memory_order_relaxed);
+  }
+}
 
-    const auto *remoteSamples =
-        reinterpret_cast<const int16_t *>(remoteBuf.constData());
-    const int remoteSampleCount = static_cast<int>(remoteBuf.size()) /
-                                  static_cast<int>(sizeof(int16_t));
+void AudioMixer::mixAndEmit(int sampleCount, int sampleRate)
+{
+  QList<MixMinusBus> buses;
+  if (isMixMinusEnabled())
+  {
+    QMutexLocker locker(&m_mutex);
+    buses = m_mixMinusBuses;
+  }
 
-    const int mixLen = qMin(silenceSamples, remoteSampleCount);
-    for (int i = 0; i < mixLen; ++i)
-    {
-      mixBuf[i] += static_cast<int32_t>(remoteSamples[i]);
-    }
+  // 在 SIMD 内核中累加并饱和钳位，直接写入池化的输出缓冲区；
+  // mix-minus 模式下同一遍扫描同时写出各总线的「总和 − 自身」
+  QByteArray &mixed =
+      m_outputPool.acquire(sampleCount * static_cast<int>(sizeof(int16_t)));
+  auto *mixedSamples = reinterpret_cast<int16_t *>(mixed.data());
+  const int inputCount = static_cast<int>(m_inputPtrs.size());
+  if (!buses.isEmpty() && prepareMixMinus(buses, sampleCount))
+  {
+    AudioMixKernel::mixMinusStreams(mixedSamples, m_minusPtrs.data(),
+                                    m_inputPtrs.data(), inputCount,
+                                    sampleCount);
+  }
+  else
+  {
+    AudioMixKernel::mixStreams(mixedSamples, m_inputPtrs.data(), inputCount,
+                               sampleCount);
+  }
+
+  m_tickCount.fetch_add(1, std::memory_order_relaxed);
+
+  // 下游按引用计数共享该缓冲，释放后下一轮 acquire() 可原地复用
+  emit mixedAudioReady(mixed, sampleRate, 1);
+
+  // 各登记格式：每种格式转换一次，由该格式的全部消费者共享
+  QList<AudioMixerOutput *> outputs;
+  {
+    QMutexLocker locker(&m_mutex);
+    outputs = m_outputs;
+  }
+  for (AudioMixerOutput *out : std::as_const(outputs))
+  {
+    if (out->hasConsumers())
+      out->process(mixed, sampleRate);
+  }
 
-    const int consumedBytes = mixLen * static_cast<int>(sizeof(int16_t));
-    remoteBuf.remove(0, consumedBytes);
+  if (!buses.isEmpty())
+    emitMixMinus(buses, mixed, sampleRate);
+}
+
+bool AudioMixer::prepareMixMinus(const QList<MixMinusBus> &buses,
+                                 int sampleCount)
+{
+  const int inputCount = static_cast<int>(m_inputPtrs.size());
+  m_minusPtrs.assign(inputCount, nullptr);
+  m_minusSlots.assign(inputCount, -1);
+  m_minusBuffers.clear();
+
+  for (const MixMinusBus &bus : buses)
+  {
+    if (!bus.output->hasConsumers())
+      continue;
+
+    const auto it = std::find(m_inputOwners.begin(), m_inputOwners.end(),
+                              bus.input.get());
+    if (it == m_inputOwners.end())
+      continue; // 本周期未参与混音：总线输出即全体混音
+
+    const int k = static_cast<int>(it - m_inputOwners.begin());
+    if (m_minusSlots[k] >= 0)
+      continue; // 同一参会者的多种格式共享一份 mix-minus
+
+    // 先在独占状态下取得写指针，再保存一份引用防止本周期内被复用
+    QByteArray &buf =
+        m_minusPool.acquire(sampleCount * static_cast<int>(sizeof(int16_t)));
+    m_minusPtrs[k] = reinterpret_cast<int16_t *>(buf.data());
+    m_minusSlots[k] = static_cast<int>(m_minusBuffers.size());
+    m_minusBuffers.push_back(buf);
   }
+  return !m_minusBuffers.empty();
+}
 
-  QByteArray output(silenceSamples * static_cast<int>(sizeof(int16_t)),
-                    Qt::Uninitialized);
-  auto *outSamples = reinterpret_cast<int16_t *>(output.data());
-  for (int i = 0; i < silenceSamples; ++i)
+void AudioMixer::emitMixMinus(const QList<MixMinusBus> &buses,
+                              const QByteArray &mixed, int sampleRate)
+{
+  for (const MixMinusBus &bus : buses)
   {
-    outSamples[i] = static_cast<int16_t>(
-        qBound(static_cast<int32_t>(-32768), mixBuf[i],
-               static_cast<int32_t>(32767)));
+    if (!bus.output->hasConsumers())
+      continue;
+
+    const QByteArray *source = &mixed;
+    const auto it = std::find(m_inputOwners.begin(), m_inputOwners.end(),
+                              bus.input.get());
+    if (it != m_inputOwners.end())
+    {
+      const int slot = m_minusSlots.empty()
+                           ? -1
+                           : m_minusSlots[it - m_inputOwners.begin()];
+      if (slot >= 0)
+        source = &m_minusBuffers[slot];
+    }
+    bus.output->process(*source, sampleRate);
   }
 
-  emit mixedAudioReady(output, m_outputSampleRate, 1);
+  // 释放本周期持有的引用，下游释放后缓冲池即可复用
+  m_minusBuffers.clear();
+}
+
+quint64 AudioMixer::allocationCount() const
+{
+  quint64 total = m_scratchAllocations.load(std::memory_order_relaxed) +
+                  m_outputPool.allocationCount() +
+                  m_minusPool.allocationCount();
+
+  QMutexLocker locker(&m_mutex);
+  for (const AudioMixerOutput *out : m_outputs)
+    total += out->allocationCount();
+  for (const MixMinusBus &bus : m_mixMinusBuses)
+    total += bus.output->allocationCount();
+  return total;
 }
@@ -3,12 +3,53 @@
  * @brief 音频混音器
  *
  * 负责：
- * 1. 接收本地麦克风 PCM 音频数据（master clock）
+ * 1. 接收本地麦克风 PCM 音频数据
  * 2. 接收所有远程参会者的 PCM 音频数据
- * 3. 将多路音频逐样本相加并钳位混合
+ * 3. 将多路音频逐样本相加并钳位混合（SIMD 内核，见 audiomixkernel.h）
  * 4. 输出混合后的 PCM 数据供 AIAssistant 和 MeetingRecorder 使用
  *
- * 所有输入/输出统一格式：48kHz / mono / int16_t
+ * 混音在独立的高优先级线程中进行，由单调时钟（steady_clock）按
+ * MIX_INTERVAL_MS 定步长驱动，不依赖 Qt 事件循环：QML 渲染阻塞 GUI 线程时
+ * 混音周期不会推迟，录制不再出现空洞。本地麦克风与远程参会者一样经
+ * SPSC 环形缓冲区（AudioMixerInput）交给混音线程。每个周期实际唤醒时间
+ * 与计划时间之差记入 tickLatenessHistogram()。
+ *
+ * 多路输出（output()）：消费者按需登记输出格式（如 16kHz int16、48kHz
+ * float planar），每种不同格式每周期只重采样 / 转换一次，结果以隐式
+ * 共享缓冲零拷贝分发给该格式的全部消费者；mixedAudioReady 仍按基准格式
+ * 发出。
+ *
+ * mix-minus 模式（setMixMinusEnabled）：同一遍扫描中求出全体总和，并为每条
+ * 登记的总线（mixMinusOutput）输出「总和 − 该参会者」，用于 SIP 桥接、
+ * 按说话人转写等需要 N−1 混音的下游，开销 O(N) 而非运行 N 个混音器的 O(N²)。
+ *
+ * mixedAudioReady / activeSpeakersChanged / AudioMixerOutput::audioReady
+ * 从混音线程发出：接收者若在其它
+ * 线程将按 QueuedConnection 投递；线程安全的接收者（如 MeetingRecorder）
+ * 可使用 DirectConnection 以完全绕开 GUI 事件循环。
+ *
+ * 输出格式：mono / int16_t，采样率跟随本地麦克风（默认 48kHz）
+ * （采样率不同的远程音频在 AudioMixerInput 中经多相重采样转换）
+ *
+ * 远程音频通过每个参会者独立的 SPSC 环形缓冲区（AudioMixerInput）传递：
+ * RemoteAudioPlayer 播放线程为唯一生产者，混音线程为唯一消费者，
+ * 热路径上不加锁、不搬移已缓存数据。
+ *
+ * 时间戳混音模式（setTimestampedMixing）：每路输入使用由混音器统一时钟
+ * 驱动的自适应抖动缓冲，晚到的数据做丢包隐藏、早到的数据 hold 到播放
+ * 时刻，streamStats() 给出每个参会者的 underrun / overrun 计数。
+ *
+ * 说话人检测与 top-N 混音（setMaxActiveSpeakers）：每路输入在生产者线程
+ * 估计电平和 VAD，混音线程按「正在说话 > 电平」排序，只读取并混合最响的
+ * N 路，其余输入仅推进读位置（不拷贝），混音开销从 O(参会者) 降为 O(N)。
+ * 当前说话人集合变化时发出 activeSpeakersChanged，可用于驱动演讲者布局。
+ *
+ * 缓冲复用：混音所需的临时缓冲在构造时预留（scratch arena），输出缓冲
+ * 来自 AudioBufferPool 并在下游释放后复用；allocationCount() 可在运行时
+ * 确认预热后这两类缓冲不再分配。注意这不等于整个周期零堆分配：跨线程
+ * 消费者经队列连接接收信号时，Qt 每周期仍会为每个连接创建 QMetaCallEvent。
+ * main.cpp 中的逐周期消费者（MeetingRecorder、AIAssistant::pushAsrAudio）
+ * 均使用 DirectConnection，实际堆分配次数见 MeetingAppBench 的 allocs_per_frame。
  */
 
 #ifndef AUDIOMIXER_H
@@ -16,33 +57,168 @@
 
 #include <QByteArray>
 #include <QElapsedTimer>
+#include <QList>
 #include <QMap>
 #include <QMutex>
 #include <QObject>
 #include <QString>
-#include <QTimer>
+#include <QStringList>
+#include <QThread>
+#include <atomic>
+#include <memory>
 #include <vector>
 
+#include "audiobufferpool.h"
+#include "audiomixerinput.h"
+#include "audiomixeroutput.h"
+#include "audiooutputformat.h"
+#include "latencyhistogram.h"
+
 class AudioMixer : public QObject
 {
   Q_OBJECT
 public:
-  explicit AudioMixer(QObject *parent = nullptr);
+  /**
+   * @brief 混音周期的驱动方式
+   */
+  enum class Pacing
+  {
+    RealTimeThread, // 内部实时线程按 MIX_INTERVAL_MS 定步长驱动（默认）
+    Manual          // 不启动线程，由调用方通过 runTick() 逐周期驱动
+  };
+
+  explicit AudioMixer(QObject *parent = nullptr,
+                      Pacing pacing = Pacing::RealTimeThread);
   ~AudioMixer() override;
 
+  /**
+   * @brief 同步执行一个混音周期（仅 Pacing::Manual）
+   *
+   * 供基准测试 / 离线处理在调用线程上逐周期驱动混音，不受调度抖动影响；
+   * 周期时长固定为 MIX_INTERVAL_MS。信号在调用线程上发出。
+   */
+  void runTick();
+
+  /**
+   * @brief 获取（不存在则创建）指定参会者的输入端
+   *
+   * 调用方应保存返回的句柄，并在 RemoteAudioPlayer 的播放线程中直接
+   * 调用 push()，这样每个音频块只经过环形缓冲区，无需查表和加锁。
+   */
+  std::shared_ptr<AudioMixerInput> remoteInput(const QString &participantId);
+
+  /**
+   * @brief 获取（不存在则创建）指定格式的输出
+   *
+   * 同一格式总是返回同一个对象（由混音器持有），消费者连接其 audioReady
+   * 信号即完成登记；没有连接的输出不做任何转换。
+   */
+  AudioMixerOutput *output(const AudioOutputFormat &format);
+
+  /**
+   * @brief 开启 / 关闭 mix-minus（N−1）模式
+   *
+   * 关闭时 mixMinusOutput() 返回的总线不输出任何数据。
+   */
+  void setMixMinusEnabled(bool enabled);
+  bool isMixMinusEnabled() const
+  {
+    return m_mixMinusEnabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 获取（不存在则创建）指定参会者的 mix-minus 总线
+   * @param participantId 参会者标识；为空表示本地麦克风
+   *        （即只含远程参会者的混音）
+   * @param format 总线输出格式（默认 48kHz int16）
+   *
+   * 每条总线是一个独立的 AudioMixerOutput，消费者连接其 audioReady 即可。
+   * 该参会者本周期没有参与混音（静默、未被 top-N 选中或已离开）时，
+   * 总线输出即全体混音，直接共享同一块缓冲。
+   */
+  AudioMixerOutput *mixMinusOutput(
+      const QString &participantId,
+      const AudioOutputFormat &format = AudioOutputFormat());
+
+  /**
+   * @brief 混音缓冲累计的分配次数（scratch arena 扩容 + 各输出缓冲池分配）
+   *
+   * 预热后应保持不变；可与 mixTickCount() 对比计算每周期分配率。
+   * 不包含 Qt 投递队列信号时的事件分配等混音器之外的堆分配。
+   */
+  quint64 allocationCount() const;
+
+  /**
+   * @brief 混音周期迟到时间直方图（实际唤醒时刻 - 计划时刻，微秒）
+   */
+  LatencyHistogram::Snapshot tickLatenessHistogram() const
+  {
+    return m_tickLateness.snapshot();
+  }
+  void resetTickLatenessHistogram() { m_tickLateness.reset(); }
+
+  /**
+   * @brief 因严重迟到（超过 MAX_CATCHUP_TICKS 个周期）放弃追赶、重新对齐
+   *        时钟的次数；每次意味着输出出现了一段空洞
+   */
+  quint64 resyncCount() const
+  {
+    return m_resyncCount.load(std::memory_order_relaxed);
+  }
+
+  /** @brief 已完成的混音周期数 */
+  quint64 mixTickCount() const
+  {
+    return m_tickCount.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 开启 / 关闭时间戳混音模式（自适应抖动缓冲 + 丢包隐藏）
+   *
+   * 关闭时为直通模式：有多少远程数据混多少，积压超过 2 秒丢弃最旧数据。
+   */
+  void setTimestampedMixing(bool enabled);
+  bool isTimestampedMixing() const
+  {
+    return m_timestampedMixing.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 每个远程参会者的抖动缓冲统计（underrun / overrun / 缓冲深度等）
+   */
+  QList<AudioStreamStats> streamStats() const;
+
+  /**
+   * @brief 设置每个周期最多混合的远程说话人数（0 表示混合全部）
+   *
+   * 选择顺序：正在说话的输入优先，其次按平滑电平；已选中的输入有少量
+   * 滞回加成，避免电平相近时来回切换。本地麦克风始终参与混音。
+   */
+  void setMaxActiveSpeakers(int count);
+  int maxActiveSpeakers() const
+  {
+    return m_maxActiveSpeakers.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 当前正在说话的远程参会者（按电平从高到低，top-N 模式下最多 N 个）
+   */
+  QStringList activeSpeakers() const;
+
 public slots:
   /**
-   * @brief 输入本地麦克风音频（作为 master clock 驱动混音输出）
+   * @brief 输入本地麦克风音频
    *
-   * 每次调用时，将本地数据与已缓存的远程数据混合后发出 mixedAudioReady 信号。
+   * 数据写入本地输入的环形缓冲区，由混音线程在下一个周期与远程音频一起
+   * 混合；同时以其采样率作为混音输出采样率。须始终由同一线程调用。
    */
   void feedLocalAudio(const QByteArray &pcmData, int sampleRate, int channels);
 
   /**
-   * @brief 输入远程参会者音频
+   * @brief 输入远程参会者音频（sampleRate 与输出不同时自动重采样）
    *
-   * 数据缓存到对应 participantId 的缓冲区，等待下一次 feedLocalAudio
-   * 时一起混合。
+   * 等价于 remoteInput(participantId)->push(...)，数据写入该参会者的
+   * 环形缓冲区，等待下一个混音周期一起混合。
    */
   void feedRemoteAudio(const QString &participantId, const QByteArray &pcmData,
                        int sampleRate, int channels);
@@ -61,23 +237,121 @@ signals:
    */
   void mixedAudioReady(const QByteArray &pcmData, int sampleRate, int channels);
 
+  /**
+   * @brief 当前说话人集合变化（集合内仅电平排序变化时不发出）
+   * @param participantIds 正在说话的远程参会者，按电平从高到低
+   */
+  void activeSpeakersChanged(const QStringList &participantIds);
+
+public:
+  // 混音周期（同时也是每次输出的时长）
+  static constexpr int MIX_INTERVAL_MS = 10;
+
 private:
-  // 将多声道 PCM 下混为单声道
-  QByteArray downmixToMono(const QByteArray &pcmData, int channels);
+  // mix-minus 总线：participantId 对应的输入端 + 输出
+  struct MixMinusBus
+  {
+    QString participantId;
+    std::shared_ptr<AudioMixerInput> input;
+    AudioMixerOutput *output;
+  };
+
+  // top-N 排序候选（仅混音线程访问）
+  struct SpeakerCandidate
+  {
+    std::shared_ptr<AudioMixerInput> input;
+    float levelDb;
+    float score;
+    bool speaking;
+  };
+
+  // 混音线程主循环：按 steady_clock 定步长调度 mixTick()
+  void mixLoop();
+
+  // 一个混音周期：取出本地 + 远程输入，混音并发出；全部静默时不输出
+  void mixTick(int sampleCount, int sampleRate);
+
+  // 本地或任一远程输入是否有待混合的数据
+  bool hasPendingInput() const;
+
+  // 确保 scratch arena 能容纳 inputCount 路 × sampleCount 采样，扩容时计数
+  void reserveScratch(int inputCount, int sampleCount);
+
+  // 混音并通过缓冲池发出 mixedAudioReady，再交给各格式输出转换
+  void mixAndEmit(int sampleCount, int sampleRate);
+
+  // 从被选中的输入取出 sampleCount 个采样（直通或抖动缓冲），
+  // 并将有效输入的指针追加到 m_inputPtrs；未选中的输入只丢弃同样长度
+  void collectRemoteInputs(int sampleCount);
+
+  // 按 m_candidates 更新说话人集合，变化时发出 activeSpeakersChanged
+  void updateActiveSpeakers();
 
-  // 定时器回调：当无本地麦克风数据时，仍输出远程音频
-  void onMixTimer();
+  // 为本周期参与混音且有消费者的总线分配 mix-minus 缓冲，
+  // 填充 m_minusPtrs / m_minusSlots；没有需要计算的总线时返回 false
+  bool prepareMixMinus(const QList<MixMinusBus> &buses, int sampleCount);
 
+  // 把各总线的 mix-minus 结果（或全体混音）交给对应输出
+  void emitMixMinus(const QList<MixMinusBus> &buses, const QByteArray &mixed,
+                    int sampleRate);
+
+  // 仅保护 m_remoteInputs / m_outputs / m_mixMinusBuses 的增删；混音时拷贝一份快照（隐式共享，无分配）
   mutable QMutex m_mutex;
 
-  // 每个远程参会者的待混合音频缓冲区
-  QMap<QString, QByteArray> m_remoteBuffers;
+  // 每个远程参会者的输入端（participantId → 环形缓冲区）
+  QMap<QString, std::shared_ptr<AudioMixerInput>> m_remoteInputs;
+
+  // 已登记的输出格式（子对象，随混音器销毁；受 m_mutex 保护）
+  QList<AudioMixerOutput *> m_outputs;
+  QList<MixMinusBus> m_mixMinusBuses;
+  std::atomic<bool> m_mixMinusEnabled{false};
+
+  // 统一单调时钟：所有输入的到达时间戳都基于它
+  QElapsedTimer m_clock;
+
+  // 本地麦克风输入（不参与 top-N 排序，始终混音）
+  std::shared_ptr<AudioMixerInput> m_localInput;
+  std::atomic<bool> m_timestampedMixing{false};
+
+  // ---- scratch arena（仅混音线程访问，构造时预留，只增不减）----
+  // 从环形缓冲区读出的临时采样，每路连续存放
+  std::vector<int16_t> m_readScratch;
+  // 本轮参与混音的输入指针（送入 AudioMixKernel::mixStreams）
+  std::vector<const int16_t *> m_inputPtrs;
+  // 与 m_inputPtrs 一一对应的输入端（mix-minus 按此匹配总线）
+  std::vector<const AudioMixerInput *> m_inputOwners;
+  // mix-minus：每路输入的输出指针（无总线为 nullptr）及其在
+  // m_minusBuffers 中的下标（-1 表示无）
+  std::vector<int16_t *> m_minusPtrs;
+  std::vector<int> m_minusSlots;
+  // 本周期的 mix-minus 结果（持有引用，防止同一周期内被缓冲池复用）
+  std::vector<QByteArray> m_minusBuffers;
+  AudioBufferPool m_minusPool;
+  // 本地麦克风本周期采样
+  std::vector<int16_t> m_localScratch;
+  // top-N 候选及说话人集合比较用的临时数组
+  std::vector<SpeakerCandidate> m_candidates;
+  std::vector<const AudioMixerInput *> m_speakerScratch;
+
+  // 上次发出的说话人集合（按指针排序；持有引用，保证指针不被复用）
+  std::vector<std::shared_ptr<AudioMixerInput>> m_activeSet;
+  QStringList m_activeSpeakers; // 受 m_mutex 保护
+  std::atomic<int> m_maxActiveSpeakers{0};
+
+  // 输出缓冲池（下游释放引用后原地复用）
+  AudioBufferPool m_outputPool;
+
+  std::atomic<quint64> m_scratchAllocations{0};
+  std::atomic<quint64> m_tickCount{0};
+
+  // 混音线程
+  QThread *m_mixThread = nullptr;
+  std::atomic<bool> m_running{false};
+  std::atomic<int> m_outputSampleRate{48000};
+  int m_idleTicks = 0; // 连续无输入数据的周期数（仅混音线程）
 
-  // 定时混音（本地麦克风未开启时的 fallback 驱动）
-  QTimer *m_mixTimer = nullptr;
-  QElapsedTimer m_localAudioTimer;
-  int m_outputSampleRate = 48000;
-  static constexpr int MIX_INTERVAL_MS = 20;
+  LatencyHistogram m_tickLateness;
+  std::atomic<quint64> m_resyncCount{0};
 };
 
 #endif // AUDIOMIXER_H
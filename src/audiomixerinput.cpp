@@ -0,0 +1,300 @@
+/**
+ * @file audiomixerinput.cpp
+ * @brief AudioMixer 单路远程音频输入端实现
+ */
+
+#include "audiomixerinput.h"
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+// 环形缓冲区容量（向上取整到 2 的幂，约 2.7 秒 @48kHz）
+constexpr int RING_CAPACITY_SAMPLES = 48000 * 2;
+// 直通模式安全阀（默认）：单路积压超过 2 秒时丢弃最旧的数据
+constexpr int MAX_BACKLOG_SAMPLES = 48000 * 2;
+
+// 抖动缓冲目标深度 = 基础深度 + 2 × 抖动估计，限制在 [MIN, MAX] 毫秒
+constexpr int JITTER_BASE_MS = 20;
+constexpr int JITTER_MIN_MS = 20;
+constexpr int JITTER_MAX_MS = 200;
+// 连续隐藏超过该周期数视为对端停止发送，回到缓冲状态并输出静音
+constexpr int MAX_CONCEAL_PULLS = 5;
+// 丢包隐藏历史缓冲预留（100ms @48kHz）
+constexpr int HISTORY_RESERVE_SAMPLES = 48000 / 10;
+// 超过该时长没有新数据到达，电平 / VAD 视为静音
+constexpr qint64 LEVEL_STALE_US = 200 * 1000;
+} // namespace
+
+AudioMixerInput::AudioMixerInput(const QString &participantId,
+                                 const QElapsedTimer *clock,
+                                 const std::atomic<int> *outputSampleRate)
+    : m_participantId(participantId), m_clock(clock),
+      m_outputSampleRate(outputSampleRate), m_ring(RING_CAPACITY_SAMPLES),
+      m_maxBacklogSamples(MAX_BACKLOG_SAMPLES)
+{
+  m_history.resize(HISTORY_RESERVE_SAMPLES);
+}
+
+void AudioMixerInput::push(const QByteArray &pcmData, int sampleRate,
+                           int channels)
+{
+  if (pcmData.isEmpty() || channels <= 0 || sampleRate <= 0)
+    return;
+
+  const auto *src = reinterpret_cast<const int16_t *>(pcmData.constData());
+  const int totalSamples =
+      static_cast<int>(pcmData.size()) / static_cast<int>(sizeof(int16_t));
+  const int frames = totalSamples / channels;
+
+  // 到达抖动估计（RFC 3550）：实际到达间隔与上一块媒体时长之差的平滑均值
+  const qint64 nowUs = m_clock->nsecsElapsed() / 1000;
+  if (m_lastArrivalUs >= 0)
+  {
+    const double d =
+        static_cast<double>((nowUs - m_lastArrivalUs) - m_lastChunkUs);
+    m_jitterEstimateUs += (std::abs(d) - m_jitterEstimateUs) / 16.0;
+    m_jitterUs.store(static_cast<int>(m_jitterEstimateUs),
+                     std::memory_order_relaxed);
+  }
+  m_lastArrivalUs = nowUs;
+  m_lastChunkUs = static_cast<qint64>(frames) * 1000000 / sampleRate;
+  m_lastPushUs.store(nowUs, std::memory_order_relaxed);
+
+  // 【关键修复】统一下混为单声道（复用生产者线程私有的临时缓冲）
+  const int16_t *mono = src;
+  if (channels > 1)
+  {
+    if (static_cast<int>(m_downmixScratch.size()) < frames)
+      m_downmixScratch.resize(frames);
+    for (int i = 0; i < frames; ++i)
+    {
+      int32_t sum = 0;
+      for (int ch = 0; ch < channels; ++ch)
+        sum += src[i * channels + ch];
+      m_downmixScratch[i] = static_cast<int16_t>(sum / channels);
+    }
+    mono = m_downmixScratch.data();
+  }
+
+  // 电平 / VAD 在生产者线程计算，混音线程排序时只读原子量
+  m_vad.process(mono, frames, sampleRate);
+  m_levelDb.store(m_vad.levelDb(), std::memory_order_relaxed);
+  m_speaking.store(m_vad.isSpeaking(), std::memory_order_relaxed);
+
+  // 采样率与混音输出一致：直接写入
+  const int targetRate = m_outputSampleRate->load(std::memory_order_relaxed);
+  if (sampleRate == targetRate || targetRate <= 0)
+  {
+    m_ring.write(mono, frames);
+    return;
+  }
+
+  // 采样率不一致：流式重采样（采样率对变化时才重建，滤波器组全局缓存）
+  if (!m_resampler || m_resampler->inRate() != sampleRate ||
+      m_resampler->outRate() != targetRate)
+  {
+    m_resampler = std::make_unique<AudioResampler>(sampleRate, targetRate);
+  }
+  const int maxOut = m_resampler->maxOutputSamples(frames);
+  if (static_cast<int>(m_resampleScratch.size()) < maxOut)
+    m_resampleScratch.resize(maxOut);
+  const int produced =
+      m_resampler->process(mono, frames, m_resampleScratch.data());
+  m_ring.write(m_resampleScratch.data(), produced);
+}
+
+bool AudioMixerInput::pull(int16_t *dst, int sampleCount, int outputSampleRate,
+                           bool timestamped)
+{
+  if (sampleCount <= 0)
+    return false;
+  return timestamped ? pullJitterBuffered(dst, sampleCount, outputSampleRate)
+                     : pullDirect(dst, sampleCount);
+}
+
+bool AudioMixerInput::pullDirect(int16_t *dst, int sampleCount)
+{
+  // 安全阀：防止某个远程流堆积过多数据
+  const int backlog = m_ring.available();
+  if (backlog > m_maxBacklogSamples)
+  {
+    const int skipped = m_ring.skip(backlog - m_maxBacklogSamples);
+    m_skippedSamples.fetch_add(skipped, std::memory_order_relaxed);
+  }
+
+  // 取两者中较短的长度进行混合，多出来的数据留在缓冲区等待下一轮；
+  // 不足部分补零，使所有输入等长以便向量化累加
+  const int got = m_ring.read(dst, sampleCount);
+  if (got <= 0)
+    return false;
+  if (got < sampleCount)
+  {
+    std::memset(dst + got, 0,
+                static_cast<size_t>(sampleCount - got) * sizeof(int16_t));
+  }
+  return true;
+}
+
+int AudioMixerInput::jitterTargetSamples(int sampleCount, int outputSampleRate)
+{
+  // 根据当前抖动估计计算目标深度（至少一个混音周期）
+  const int jitterMs = m_jitterUs.load(std::memory_order_relaxed) / 1000;
+  const int targetMs =
+      qBound(JITTER_MIN_MS, JITTER_BASE_MS + 2 * jitterMs, JITTER_MAX_MS);
+  const int targetSamples =
+      qMax(sampleCount, targetMs * outputSampleRate / 1000);
+  m_targetSamples.store(targetSamples, std::memory_order_relaxed);
+  return targetSamples;
+}
+
+bool AudioMixerInput::pullJitterBuffered(int16_t *dst, int sampleCount,
+                                         int outputSampleRate)
+{
+  const int targetSamples = jitterTargetSamples(sampleCount, outputSampleRate);
+  const int available = m_ring.available();
+
+  if (!m_playing)
+  {
+    // 缓冲中：提前到达的帧先 hold 住，直到深度达到目标再开始播放
+    if (available < targetSamples)
+    {
+      std::memset(dst, 0, static_cast<size_t>(sampleCount) * sizeof(int16_t));
+      return false;
+    }
+    m_playing = true;
+    m_consecutiveUnderruns = 0;
+  }
+
+  // 高水位：积压超过 2 倍目标深度 + 一个周期时，丢弃到目标深度（overrun）
+  if (available > targetSamples * 2 + sampleCount)
+  {
+    const int skipped = m_ring.skip(available - targetSamples);
+    m_skippedSamples.fetch_add(skipped, std::memory_order_relaxed);
+    m_overruns.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  const int got = m_ring.read(dst, sampleCount);
+  if (got < sampleCount)
+  {
+    // 晚到：用上一周期输出衰减重复做丢包隐藏（underrun）
+    m_underruns.fetch_add(1, std::memory_order_relaxed);
+    ++m_consecutiveUnderruns;
+    if (m_consecutiveUnderruns > MAX_CONCEAL_PULLS)
+    {
+      // 对端已停止发送：回到缓冲状态，其余部分输出静音
+      m_playing = false;
+      std::memset(dst + got, 0,
+                  static_cast<size_t>(sampleCount - got) * sizeof(int16_t));
+    }
+    else
+    {
+      conceal(dst + got, sampleCount - got);
+      m_concealedSamples.fetch_add(sampleCount - got,
+                                   std::memory_order_relaxed);
+    }
+  }
+  else
+  {
+    m_consecutiveUnderruns = 0;
+  }
+
+  // 只用完整的真实数据更新历史：若记录隐藏后的输出，衰减会逐周期叠加
+  // （6、18、36dB...），部分读取也会把隐藏采样混入历史
+  if (got == sampleCount)
+  {
+    const int keep = qMin(sampleCount, static_cast<int>(m_history.size()));
+    std::memcpy(m_history.data(), dst + (sampleCount - keep),
+                static_cast<size_t>(keep) * sizeof(int16_t));
+    m_historyLen = keep;
+  }
+
+  return got > 0 || m_playing;
+}
+
+void AudioMixerInput::discard(int sampleCount, int outputSampleRate,
+                              bool timestamped)
+{
+  if (sampleCount <= 0)
+    return;
+
+  if (!timestamped)
+  {
+    m_ring.skip(sampleCount);
+    return;
+  }
+
+  // 缓冲中：继续 hold，与 pullJitterBuffered 一致
+  const int targetSamples = jitterTargetSamples(sampleCount, outputSampleRate);
+  if (!m_playing)
+  {
+    if (m_ring.available() < targetSamples)
+      return;
+    m_playing = true;
+  }
+
+  m_ring.skip(sampleCount);
+  // 未混音期间的历史已失效，重新被选中时不再用旧数据做丢包隐藏
+  m_historyLen = 0;
+  m_consecutiveUnderruns = 0;
+}
+
+bool AudioMixerInput::isStale() const
+{
+  const qint64 last = m_lastPushUs.load(std::memory_order_relaxed);
+  return last < 0 || m_clock->nsecsElapsed() / 1000 - last > LEVEL_STALE_US;
+}
+
+float AudioMixerInput::levelDb() const
+{
+  return isStale() ? VoiceActivityDetector::SILENCE_DB
+                   : m_levelDb.load(std::memory_order_relaxed);
+}
+
+bool AudioMixerInput::isSpeaking() const
+{
+  return !isStale() && m_speaking.load(std::memory_order_relaxed);
+}
+
+void AudioMixerInput::conceal(int16_t *dst, int count)
+{
+  if (m_historyLen <= 0)
+  {
+    std::memset(dst, 0, static_cast<size_t>(count) * sizeof(int16_t));
+    return;
+  }
+
+  // 历史为最近一个完整周期的真实数据；第 n 次连续隐藏衰减 6n dB，
+  // 避免长时间重复产生明显的「嗡嗡」声
+  const int shift = qMin(m_consecutiveUnderruns, 15);
+  for (int i = 0; i < count; ++i)
+  {
+    dst[i] = static_cast<int16_t>(m_history[i % m_historyLen] >> shift);
+  }
+}
+
+AudioStreamStats AudioMixerInput::stats(int outputSampleRate) const
+{
+  AudioStreamStats s;
+  s.participantId = m_participantId;
+  s.underruns = m_underruns.load(std::memory_order_relaxed);
+  s.overruns = m_overruns.load(std::memory_order_relaxed);
+  s.concealedSamples = m_concealedSamples.load(std::memory_order_relaxed);
+  s.droppedSamples = m_skippedSamples.load(std::memory_order_relaxed) +
+                     m_ring.droppedSamples();
+  s.jitterMs = m_jitterUs.load(std::memory_order_relaxed) / 1000;
+  if (outputSampleRate > 0)
+  {
+    s.targetDelayMs = static_cast<int>(
+        static_cast<qint64>(m_targetSamples.load(std::memory_order_relaxed)) *
+        1000 / outputSampleRate);
+    s.bufferedMs = static_cast<int>(static_cast<qint64>(m_ring.available()) *
+                                    1000 / outputSampleRate);
+  }
+  s.levelDb = levelDb();
+  s.speaking = isSpeaking();
+  s.mixed = isMixSelected();
+  return s;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file audiomixerinput.h
+ * @brief AudioMixer 的单路远程音频输入端
+ *
+ * 每个远程参会者对应一个 AudioMixerInput：
+ * 1. 生产者（RemoteAudioPlayer 播放线程）调用 push() 写入 SPSC 环形缓冲区，
+ *    同时用混音器的统一时钟记录到达时间、估计到达抖动；采样率与混音输出
+ *    不一致时先经 AudioResampler 转换（重采样在生产者线程完成）；
+ *    同时做电平 / VAD 估计，混音线程只读原子量即可完成说话人排序
+ * 2. 消费者（AudioMixer）每个混音周期调用 pull() 取出固定长度的采样
+ *
+ * pull() 支持两种模式：
+ * - 直通模式：有多少读多少，不足补零，积压超过 2 秒丢弃最旧数据
+ * - 时间戳模式：自适应抖动缓冲。目标深度随抖动估计调整；
+ *   缓冲未达目标深度前保持静音（提前到达的帧被 hold 住），
+ *   数据不足时用上一帧衰减重复做丢包隐藏（underrun），
+ *   积压超过高水位时丢弃到目标深度（overrun）
+ *
+ * 未被选入本周期混音的输入（top-N 模式）调用 discard()：只推进读位置，
+ * 不拷贝采样，保持该路与其它输入的时间对齐。
+ */
+
+#ifndef AUDIOMIXERINPUT_H
+#define AUDIOMIXERINPUT_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "audioresampler.h"
+#include "audioringbuffer.h"
+#include "voiceactivitydetector.h"
+
+/**
+ * @brief 单路远程音频的统计信息（AudioMixer::streamStats() 返回）
+ */
+struct AudioStreamStats
+{
+  QString participantId;
+  quint64 underruns = 0;        // 数据不足、触发丢包隐藏的周期数
+  quint64 overruns = 0;         // 积压超过高水位、丢弃数据的次数
+  quint64 concealedSamples = 0; // 丢包隐藏生成的采样数
+  quint64 droppedSamples = 0;   // 因积压 / 缓冲区满被丢弃的采样数
+  int jitterMs = 0;             // 到达抖动估计
+  int targetDelayMs = 0;        // 当前抖动缓冲目标深度
+  int bufferedMs = 0;           // 当前缓冲深度
+  float levelDb = VoiceActivityDetector::SILENCE_DB; // 平滑电平（dBFS）
+  bool speaking = false;        // VAD 判决
+  bool mixed = false;           // 最近一个周期是否被选入混音
+};
+
+class AudioMixerInput
+{
+public:
+  /**
+   * @param participantId 参会者标识
+   * @param clock 混音器的统一单调时钟（生命周期须长于本对象的使用期）
+   * @param outputSampleRate 混音器当前输出采样率（push() 据此决定是否重采样）
+   */
+  AudioMixerInput(const QString &participantId, const QElapsedTimer *clock,
+                  const std::atomic<int> *outputSampleRate);
+
+  const QString &participantId() const { return m_participantId; }
+
+  /**
+   * @brief 写入一段远程 PCM（仅生产者线程）
+   *
+   * 多声道先下混为单声道；采样率与混音输出不同则流式重采样，
+   * 重采样器保存跨块状态，块边界无伪影。
+   */
+  void push(const QByteArray &pcmData, int sampleRate, int channels);
+
+  /**
+   * @brief 取出 sampleCount 个采样到 dst（仅混音线程）
+   * @param outputSampleRate 混音输出采样率（用于毫秒 ↔ 采样换算）
+   * @param timestamped 是否使用抖动缓冲模式
+   * @return 本周期该路是否有有效输出；false 时 dst 内容为静音
+   */
+  bool pull(int16_t *dst, int sampleCount, int outputSampleRate,
+            bool timestamped);
+
+  /**
+   * @brief 丢弃本周期的 sampleCount 个采样（仅混音线程，top-N 未选中时调用）
+   *
+   * 与 pull() 推进相同的时间线，但不拷贝数据；抖动缓冲模式下仍遵守
+   * 缓冲 / 播放状态，重新被选中时从当前时刻继续播放。
+   */
+  void discard(int sampleCount, int outputSampleRate, bool timestamped);
+
+  /**
+   * @brief 平滑电平（dBFS，任意线程）
+   *
+   * 超过一段时间没有新数据到达时视为静音，避免对端停止发送后
+   * 一直保持最后的电平。
+   */
+  float levelDb() const;
+
+  /** @brief VAD 判决：是否正在说话（任意线程，规则同 levelDb()） */
+  bool isSpeaking() const;
+
+  /** @brief 最近一个混音周期是否被选入混音（混音线程写，任意线程读） */
+  bool isMixSelected() const
+  {
+    return m_mixSelected.load(std::memory_order_relaxed);
+  }
+  void setMixSelected(bool selected)
+  {
+    m_mixSelected.store(selected, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 直通模式下允许的最大积压（采样数，默认 2 秒）
+   *
+   * 须在混音开始前设置。本地麦克风等到达节奏稳定的输入可设得更小，
+   * 以吸收采集时钟与混音时钟之间的漂移而不累积延迟。
+   */
+  void setMaxBacklogSamples(int samples) { m_maxBacklogSamples = samples; }
+
+  /** @brief 是否有待混合的数据（任意线程） */
+  bool hasData() const { return m_ring.available() > 0; }
+
+  /** @brief 统计快照（任意线程） */
+  AudioStreamStats stats(int outputSampleRate) const;
+
+private:
+  bool pullDirect(int16_t *dst, int sampleCount);
+  bool pullJitterBuffered(int16_t *dst, int sampleCount, int outputSampleRate);
+
+  // 根据当前抖动估计计算抖动缓冲目标深度（采样数）
+  int jitterTargetSamples(int sampleCount, int outputSampleRate);
+
+  // 最近一次数据到达是否已超时（超时后电平 / VAD 视为静音）
+  bool isStale() const;
+
+  // 用上一周期输出衰减重复填充 [dst, dst+count)
+  void conceal(int16_t *dst, int count);
+
+  QString m_participantId;
+  const QElapsedTimer *m_clock;
+  const std::atomic<int> *m_outputSampleRate;
+  AudioRingBuffer m_ring;
+
+  // ---- 生产者线程私有 ----
+  std::vector<int16_t> m_downmixScratch; // 下混临时缓冲
+  std::unique_ptr<AudioResampler> m_resampler; // 采样率变化时重建
+  std::vector<int16_t> m_resampleScratch;      // 重采样输出缓冲
+  VoiceActivityDetector m_vad;
+  qint64 m_lastArrivalUs = -1;
+  qint64 m_lastChunkUs = 0;
+  double m_jitterEstimateUs = 0.0; // RFC 3550 式平滑抖动估计
+
+  // ---- 消费者（混音线程）私有 ----
+  int m_maxBacklogSamples;
+  bool m_playing = false;             // false：缓冲中（hold），true：播放中
+  int m_consecutiveUnderruns = 0;
+  std::vector<int16_t> m_history;     // 上一周期输出，用于丢包隐藏
+  int m_historyLen = 0;
+
+  // ---- 跨线程共享（统计 / 抖动估计）----
+  std::atomic<int> m_jitterUs{0};
+  std::atomic<qint64> m_lastPushUs{-1};
+  std::atomic<float> m_levelDb{VoiceActivityDetector::SILENCE_DB};
+  std::atomic<bool> m_speaking{false};
+  std::atomic<bool> m_mixSelected{false};
+  std::atomic<int> m_targetSamples{0};
+  std::atomic<quint64> m_underruns{0};
+  std::atomic<quint64> m_overruns{0};
+  std::atomic<quint64> m_concealedSamples{0};
+  std::atomic<quint64> m_skippedSamples{0};
+};
+
+#endif // AUDIOMIXERINPUT_H
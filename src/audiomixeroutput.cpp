@@ -0,0 +1,100 @@
+/**
+ * @file audiomixeroutput.cpp
+ * @brief AudioMixer 单路输出实现
+ */
+
+#include "audiomixeroutput.h"
+#include <QDebug>
+#include <QMetaMethod>
+#include <cstring>
+
+namespace
+{
+// 输出缓冲池：预分配 8 块 100ms，最多 32 块（与 AudioMixer 基准输出一致）
+constexpr int OUTPUT_POOL_INITIAL = 8;
+constexpr int OUTPUT_POOL_MAX = 32;
+constexpr int OUTPUT_POOL_BUFFER_MS = 100;
+} // namespace
+
+AudioMixerOutput::AudioMixerOutput(const AudioOutputFormat &format,
+                                   QObject *parent)
+    : QObject(parent), m_format(format),
+      m_pool(OUTPUT_POOL_INITIAL,
+             format.sampleRate * OUTPUT_POOL_BUFFER_MS / 1000 *
+                 format.bytesPerSample(),
+             OUTPUT_POOL_MAX)
+{
+  qDebug() << "[AudioMixerOutput] 创建输出:" << m_format.toString();
+}
+
+AudioMixerOutput::~AudioMixerOutput() = default;
+
+bool AudioMixerOutput::hasConsumers() const
+{
+  static const QMetaMethod signal =
+      QMetaMethod::fromSignal(&AudioMixerOutput::audioReady);
+  return isSignalConnected(signal);
+}
+
+void AudioMixerOutput::process(const QByteArray &mix, int mixSampleRate)
+{
+  if (mix.isEmpty() || mixSampleRate <= 0)
+    return;
+
+  const auto *src = reinterpret_cast<const int16_t *>(mix.constData());
+  const int count =
+      static_cast<int>(mix.size()) / static_cast<int>(sizeof(int16_t));
+  const bool sameRate = m_format.sampleRate == mixSampleRate;
+
+  // 格式与基准混音完全相同：直接转发同一块缓冲
+  if (sameRate &&
+      m_format.sampleFormat == AudioOutputFormat::SampleFormat::Int16)
+  {
+    emit audioReady(mix, m_format.sampleRate, 1);
+    return;
+  }
+
+  const int16_t *samples = src;
+  int sampleCount = count;
+  if (!sameRate)
+  {
+    if (!m_resampler || m_resampler->inRate() != mixSampleRate)
+    {
+      m_resampler =
+          std::make_unique<AudioResampler>(mixSampleRate, m_format.sampleRate);
+      m_scratchAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    const int maxOut = m_resampler->maxOutputSamples(count);
+    if (static_cast<int>(m_resampleScratch.size()) < maxOut)
+    {
+      m_resampleScratch.resize(maxOut);
+      m_scratchAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    sampleCount = m_resampler->process(src, count, m_resampleScratch.data());
+    samples = m_resampleScratch.data();
+    if (sampleCount <= 0)
+      return;
+  }
+
+  QByteArray &output = m_pool.acquire(sampleCount * m_format.bytesPerSample());
+  if (m_format.sampleFormat == AudioOutputFormat::SampleFormat::Int16)
+  {
+    std::memcpy(output.data(), samples,
+                static_cast<size_t>(sampleCount) * sizeof(int16_t));
+  }
+  else
+  {
+    float *dst = reinterpret_cast<float *>(output.data());
+    constexpr float scale = 1.0f / 32768.0f;
+    for (int i = 0; i < sampleCount; ++i)
+      dst[i] = static_cast<float>(samples[i]) * scale;
+  }
+
+  emit audioReady(output, m_format.sampleRate, 1);
+}
+
+quint64 AudioMixerOutput::allocationCount() const
+{
+  return m_scratchAllocations.load(std::memory_order_relaxed) +
+         m_pool.allocationCount();
+}
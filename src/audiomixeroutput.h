@@ -0,0 +1,72 @@
+/**
+ * @file audiomixeroutput.h
+ * @brief AudioMixer 的一路输出（一种输出格式）
+ *
+ * 每种不同的 AudioOutputFormat 对应一个 AudioMixerOutput，由 AudioMixer
+ * 创建并持有。混音线程每个周期把基准混音结果（mono / int16 / 输入采样率）
+ * 交给 process()：
+ * 1. 采样率不同时经 AudioResampler 流式重采样（每种格式一个重采样器）
+ * 2. 需要浮点时做 int16 → float 转换
+ * 3. 结果写入本输出自己的 AudioBufferPool 缓冲，通过 audioReady 发出
+ *
+ * 同一格式的所有消费者连接到同一个对象，共享同一块隐式共享缓冲，
+ * 不再各自转换。没有任何连接时 process() 直接跳过。
+ */
+
+#ifndef AUDIOMIXEROUTPUT_H
+#define AUDIOMIXEROUTPUT_H
+
+#include <QByteArray>
+#include <QObject>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "audiobufferpool.h"
+#include "audiooutputformat.h"
+#include "audioresampler.h"
+
+class AudioMixerOutput : public QObject
+{
+  Q_OBJECT
+public:
+  explicit AudioMixerOutput(const AudioOutputFormat &format,
+                            QObject *parent = nullptr);
+  ~AudioMixerOutput() override;
+
+  const AudioOutputFormat &format() const { return m_format; }
+
+  /** @brief 是否有消费者连接到 audioReady（任意线程） */
+  bool hasConsumers() const;
+
+  /**
+   * @brief 转换并发出本周期输出（仅混音线程）
+   * @param mix 基准混音结果（单声道 int16），与格式相同时直接转发不拷贝
+   * @param mixSampleRate 基准混音采样率
+   */
+  void process(const QByteArray &mix, int mixSampleRate);
+
+  /** @brief 该输出累计的堆分配次数（重采样缓冲扩容 + 缓冲池分配） */
+  quint64 allocationCount() const;
+
+signals:
+  /**
+   * @brief 本格式的混音数据就绪（从混音线程发出）
+   * @param data 按 format() 编码的单声道采样
+   * @param sampleRate 采样率（即 format().sampleRate）
+   * @param channels 声道数（固定为 1）
+   */
+  void audioReady(const QByteArray &data, int sampleRate, int channels);
+
+private:
+  AudioOutputFormat m_format;
+
+  // ---- 仅混音线程访问 ----
+  std::unique_ptr<AudioResampler> m_resampler; // 基准采样率变化时重建
+  std::vector<int16_t> m_resampleScratch;
+  AudioBufferPool m_pool;
+
+  std::atomic<quint64> m_scratchAllocations{0};
+};
+
+#endif // AUDIOMIXEROUTPUT_H
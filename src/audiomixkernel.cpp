@@ -0,0 +1,362 @@
+/**
+ * @file audiomixkernel.cpp
+ * @brief 多路 int16 PCM 混音内核实现
+ */
+
+#include "audiomixkernel.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#define AUDIOMIX_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang 需要按函数开启 AVX2 指令集；MSVC 可直接使用 intrinsics
+#if defined(AUDIOMIX_X86) && (defined(__GNUC__) || defined(__clang__))
+#define AUDIOMIX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define AUDIOMIX_TARGET_AVX2
+#endif
+
+namespace AudioMixKernel
+{
+
+namespace
+{
+
+inline int16_t clampToInt16(int32_t v)
+{
+  return static_cast<int16_t>(std::min(32767, std::max(-32768, v)));
+}
+
+// 标量实现，同时用于 SIMD 实现的尾部处理
+void mixScalar(int16_t *out, const int16_t *const *inputs, int inputCount,
+               int begin, int end)
+{
+  for (int i = begin; i < end; ++i)
+  {
+    int32_t sum = 0;
+    for (int k = 0; k < inputCount; ++k)
+      sum += inputs[k][i];
+    out[i] = clampToInt16(sum);
+  }
+}
+
+// mix-minus 标量实现，同时用于 SIMD 实现的尾部处理
+void mixMinusScalar(int16_t *fullOut, int16_t *const *minusOuts,
+                    const int16_t *const *inputs, int inputCount, int begin,
+                    int end)
+{
+  for (int i = begin; i < end; ++i)
+  {
+    int32_t sum = 0;
+    for (int k = 0; k < inputCount; ++k)
+      sum += inputs[k][i];
+    if (fullOut)
+      fullOut[i] = clampToInt16(sum);
+    for (int k = 0; k < inputCount; ++k)
+    {
+      if (minusOuts[k])
+        minusOuts[k][i] = clampToInt16(sum - inputs[k][i]);
+    }
+  }
+}
+
+#ifdef AUDIOMIX_X86
+
+// SSE2 没有 cvtepi16_epi32：复制到高 16 位后算术右移完成符号扩展
+inline __m128i widenLo16(__m128i v)
+{
+  return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+}
+inline __m128i widenHi16(__m128i v)
+{
+  return _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+}
+
+// SSE2：每次处理 8 个采样，int16 → int32 符号扩展后累加，最后饱和打包
+void mixSse2(int16_t *out, const int16_t *const *inputs, int inputCount,
+             int sampleCount)
+{
+  int i = 0;
+  for (; i + 8 <= sampleCount; i += 8)
+  {
+    __m128i accLo = _mm_setzero_si128();
+    __m128i accHi = _mm_setzero_si128();
+    for (int k = 0; k < inputCount; ++k)
+    {
+      const __m128i v =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(inputs[k] + i));
+      accLo = _mm_add_epi32(accLo, widenLo16(v));
+      accHi = _mm_add_epi32(accHi, widenHi16(v));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                     _mm_packs_epi32(accLo, accHi));
+  }
+  mixScalar(out, inputs, inputCount, i, sampleCount);
+}
+
+// AVX2：每次处理 16 个采样
+AUDIOMIX_TARGET_AVX2
+void mixAvx2(int16_t *out, const int16_t *const *inputs, int inputCount,
+             int sampleCount)
+{
+  int i = 0;
+  for (; i + 16 <= sampleCount; i += 16)
+  {
+    __m256i accLo = _mm256_setzero_si256();
+    __m256i accHi = _mm256_setzero_si256();
+    for (int k = 0; k < inputCount; ++k)
+    {
+      const __m128i lo =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(inputs[k] + i));
+      const __m128i hi =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(inputs[k] + i + 8));
+      accLo = _mm256_add_epi32(accLo, _mm256_cvtepi16_epi32(lo));
+      accHi = _mm256_add_epi32(accHi, _mm256_cvtepi16_epi32(hi));
+    }
+    // packs 按 128 位 lane 交错输出，需重排 64 位块恢复采样顺序
+    const __m256i packed = _mm256_packs_epi32(accLo, accHi);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        _mm256_permute4x64_epi64(packed, 0xD8));
+  }
+  mixScalar(out, inputs, inputCount, i, sampleCount);
+}
+
+// SSE2 mix-minus：总和留在寄存器中，逐路减去自身后饱和打包
+void mixMinusSse2(int16_t *fullOut, int16_t *const *minusOuts,
+                  const int16_t *const *inputs, int inputCount,
+                  int sampleCount)
+{
+  int i = 0;
+  for (; i + 8 <= sampleCount; i += 8)
+  {
+    __m128i accLo = _mm_setzero_si128();
+    __m128i accHi = _mm_setzero_si128();
+    for (int k = 0; k < inputCount; ++k)
+    {
+      const __m128i v =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(inputs[k] + i));
+      accLo = _mm_add_epi32(accLo, widenLo16(v));
+      accHi = _mm_add_epi32(accHi, widenHi16(v));
+    }
+    if (fullOut)
+    {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(fullOut + i),
+                       _mm_packs_epi32(accLo, accHi));
+    }
+    for (int k = 0; k < inputCount; ++k)
+    {
+      if (!minusOuts[k])
+        continue;
+      const __m128i v =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(inputs[k] + i));
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i *>(minusOuts[k] + i),
+          _mm_packs_epi32(_mm_sub_epi32(accLo, widenLo16(v)),
+                          _mm_sub_epi32(accHi, widenHi16(v))));
+    }
+  }
+  mixMinusScalar(fullOut, minusOuts, inputs, inputCount, i, sampleCount);
+}
+
+// AVX2 mix-minus：每次处理 16 个采样
+AUDIOMIX_TARGET_AVX2
+void mixMinusAvx2(int16_t *fullOut, int16_t *const *minusOuts,
+                  const int16_t *const *inputs, int inputCount,
+                  int sampleCount)
+{
+  int i = 0;
+  for (; i + 16 <= sampleCount; i += 16)
+  {
+    __m256i accLo = _mm256_setzero_si256();
+    __m256i accHi = _mm256_setzero_si256();
+    for (int k = 0; k < inputCount; ++k)
+    {
+      const __m128i lo =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(inputs[k] + i));
+      const __m128i hi =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(inputs[k] + i + 8));
+      accLo = _mm256_add_epi32(accLo, _mm256_cvtepi16_epi32(lo));
+      accHi = _mm256_add_epi32(accHi, _mm256_cvtepi16_epi32(hi));
+    }
+    if (fullOut)
+    {
+      const __m256i packed = _mm256_packs_epi32(accLo, accHi);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(fullOut + i),
+                          _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    for (int k = 0; k < inputCount; ++k)
+    {
+      if (!minusOuts[k])
+        continue;
+      const __m128i lo =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(inputs[k] + i));
+      const __m128i hi =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(inputs[k] + i + 8));
+      const __m256i packed = _mm256_packs_epi32(
+          _mm256_sub_epi32(accLo, _mm256_cvtepi16_epi32(lo)),
+          _mm256_sub_epi32(accHi, _mm256_cvtepi16_epi32(hi)));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(minusOuts[k] + i),
+                          _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+  }
+  mixMinusScalar(fullOut, minusOuts, inputs, inputCount, i, sampleCount);
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4] = {0, 0, 0, 0};
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  if (!osxsave || !avx)
+    return false;
+  // 操作系统需保存 YMM 寄存器状态
+  if ((_xgetbv(0) & 0x6) != 0x6)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // AUDIOMIX_X86
+
+Implementation detectImplementation()
+{
+#ifdef AUDIOMIX_X86
+  if (cpuHasAvx2())
+    return Implementation::AVX2;
+  return Implementation::SSE2; // x86-64 基线指令集
+#else
+  return Implementation::Scalar;
+#endif
+}
+
+} // namespace
+
+bool isSupported(Implementation impl)
+{
+  switch (impl)
+  {
+  case Implementation::Scalar:
+    return true;
+  case Implementation::SSE2:
+#ifdef AUDIOMIX_X86
+    return true;
+#else
+    return false;
+#endif
+  case Implementation::AVX2:
+    return activeImplementation() == Implementation::AVX2;
+  }
+  return false;
+}
+
+Implementation activeImplementation()
+{
+  static const Implementation impl = detectImplementation();
+  return impl;
+}
+
+const char *implementationName(Implementation impl)
+{
+  switch (impl)
+  {
+  case Implementation::Scalar:
+    return "scalar";
+  case Implementation::SSE2:
+    return "sse2";
+  case Implementation::AVX2:
+    return "avx2";
+  }
+  return "unknown";
+}
+
+void mixStreamsWith(Implementation impl, int16_t *out,
+                    const int16_t *const *inputs, int inputCount,
+                    int sampleCount)
+{
+  if (sampleCount <= 0)
+    return;
+  if (inputCount <= 0)
+  {
+    std::memset(out, 0, static_cast<size_t>(sampleCount) * sizeof(int16_t));
+    return;
+  }
+
+#ifdef AUDIOMIX_X86
+  if (impl == Implementation::AVX2 && isSupported(Implementation::AVX2))
+  {
+    mixAvx2(out, inputs, inputCount, sampleCount);
+    return;
+  }
+  if (impl != Implementation::Scalar)
+  {
+    mixSse2(out, inputs, inputCount, sampleCount);
+    return;
+  }
+#else
+  (void)impl;
+#endif
+  mixScalar(out, inputs, inputCount, 0, sampleCount);
+}
+
+void mixStreams(int16_t *out, const int16_t *const *inputs, int inputCount,
+                int sampleCount)
+{
+  mixStreamsWith(activeImplementation(), out, inputs, inputCount, sampleCount);
+}
+
+void mixMinusStreamsWith(Implementation impl, int16_t *fullOut,
+                         int16_t *const *minusOuts,
+                         const int16_t *const *inputs, int inputCount,
+                         int sampleCount)
+{
+  if (sampleCount <= 0)
+    return;
+  if (inputCount <= 0)
+  {
+    if (fullOut)
+      std::memset(fullOut, 0, static_cast<size_t>(sampleCount) * sizeof(int16_t));
+    return;
+  }
+
+#ifdef AUDIOMIX_X86
+  if (impl == Implementation::AVX2 && isSupported(Implementation::AVX2))
+  {
+    mixMinusAvx2(fullOut, minusOuts, inputs, inputCount, sampleCount);
+    return;
+  }
+  if (impl != Implementation::Scalar)
+  {
+    mixMinusSse2(fullOut, minusOuts, inputs, inputCount, sampleCount);
+    return;
+  }
+#else
+  (void)impl;
+#endif
+  mixMinusScalar(fullOut, minusOuts, inputs, inputCount, 0, sampleCount);
+}
+
+void mixMinusStreams(int16_t *fullOut, int16_t *const *minusOuts,
+                     const int16_t *const *inputs, int inputCount,
+                     int sampleCount)
+{
+  mixMinusStreamsWith(activeImplementation(), fullOut, minusOuts, inputs,
+                      inputCount, sampleCount);
+}
+
+} // namespace AudioMixKernel
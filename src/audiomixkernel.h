@@ -0,0 +1,79 @@
+/**
+ * @file audiomixkernel.h
+ * @brief 多路 int16 PCM 混音内核（SSE2 / AVX2 / 标量，运行期选择）
+ *
+ * 将 N 路等长的 int16 单声道输入逐样本相加，并饱和钳位到 int16 后
+ * 直接写入输出缓冲区：
+ * - 累加在寄存器内以 int32 进行，所有输入相加完毕后再一次性饱和打包，
+ *   结果与「int32 求和 + qBound 钳位」逐位一致，且不需要 int32 中间缓冲
+ * - 首次调用时检测 CPU 特性，依次选择 AVX2 → SSE2 → 标量实现
+ *
+ * mix-minus（N−1）：mixMinusStreams() 在同一遍扫描中先求全体输入的 int32
+ * 总和，再对需要的输入 k 输出「总和 − 第 k 路」，总开销 O(N + 总线数)，
+ * 而非对每个参会者各做一次 N−1 路混音的 O(N²)。
+ */
+
+#ifndef AUDIOMIXKERNEL_H
+#define AUDIOMIXKERNEL_H
+
+#include <cstdint>
+
+namespace AudioMixKernel
+{
+
+enum class Implementation
+{
+  Scalar,
+  SSE2,
+  AVX2
+};
+
+/**
+ * @brief 混合多路输入：out[i] = clamp(Σ inputs[k][i])
+ * @param out 输出缓冲区（可以与某一路输入相同）
+ * @param inputs 输入指针数组，每路至少 sampleCount 个采样
+ * @param inputCount 输入路数；为 0 时输出静音
+ * @param sampleCount 每路采样数
+ */
+void mixStreams(int16_t *out, const int16_t *const *inputs, int inputCount,
+                int sampleCount);
+
+/**
+ * @brief 使用指定实现混音（基准测试 / 对比验证用）
+ *
+ * 指定的实现在当前 CPU 不可用时回退到标量实现。
+ */
+void mixStreamsWith(Implementation impl, int16_t *out,
+                    const int16_t *const *inputs, int inputCount,
+                    int sampleCount);
+
+/**
+ * @brief 同时输出全体混音与各路的 mix-minus：
+ *        fullOut[i] = clamp(Σ inputs[k][i])，
+ *        minusOuts[k][i] = clamp(Σ inputs[j][i] − inputs[k][i])
+ * @param fullOut 全体混音输出，可为 nullptr
+ * @param minusOuts 长度为 inputCount 的指针数组；minusOuts[k] 为 nullptr
+ *        表示第 k 路不需要 mix-minus。输出缓冲不得与任何输入重叠
+ */
+void mixMinusStreams(int16_t *fullOut, int16_t *const *minusOuts,
+                     const int16_t *const *inputs, int inputCount,
+                     int sampleCount);
+
+/** @brief 使用指定实现计算 mix-minus（基准测试 / 对比验证用） */
+void mixMinusStreamsWith(Implementation impl, int16_t *fullOut,
+                         int16_t *const *minusOuts,
+                         const int16_t *const *inputs, int inputCount,
+                         int sampleCount);
+
+/** @brief 当前 CPU 是否支持指定实现 */
+bool isSupported(Implementation impl);
+
+/** @brief mixStreams() 实际使用的实现 */
+Implementation activeImplementation();
+
+/** @brief 实现名称（日志 / 基准测试输出用） */
+const char *implementationName(Implementation impl);
+
+} // namespace AudioMixKernel
+
+#endif // AUDIOMIXKERNEL_H
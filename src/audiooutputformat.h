@@ -0,0 +1,51 @@
+/**
+ * @file audiooutputformat.h
+ * @brief AudioMixer 输出格式描述
+ *
+ * 下游消费者按需登记输出格式（见 AudioMixer::output()），
+ * 混音器对每种不同的格式每周期只转换一次。输出均为单声道。
+ */
+
+#ifndef AUDIOOUTPUTFORMAT_H
+#define AUDIOOUTPUTFORMAT_H
+
+#include <QString>
+#include <cstdint>
+
+struct AudioOutputFormat
+{
+  enum class SampleFormat
+  {
+    Int16,      // 有符号 16 位整数（交错）
+    FloatPlanar // 32 位浮点，[-1, 1]，按声道分平面（单声道即连续浮点数组）
+  };
+
+  int sampleRate = 48000;
+  SampleFormat sampleFormat = SampleFormat::Int16;
+
+  int bytesPerSample() const
+  {
+    return sampleFormat == SampleFormat::Int16
+               ? static_cast<int>(sizeof(int16_t))
+               : static_cast<int>(sizeof(float));
+  }
+
+  bool operator==(const AudioOutputFormat &other) const
+  {
+    return sampleRate == other.sampleRate && sampleFormat == other.sampleFormat;
+  }
+  bool operator!=(const AudioOutputFormat &other) const
+  {
+    return !(*this == other);
+  }
+
+  /** @brief 日志用描述，如 "16000Hz/s16" */
+  QString toString() const
+  {
+    return QString::number(sampleRate) +
+           (sampleFormat == SampleFormat::Int16 ? QStringLiteral("Hz/s16")
+                                                : QStringLiteral("Hz/fltp"));
+  }
+};
+
+#endif // AUDIOOUTPUTFORMAT_H
@@ -0,0 +1,223 @@
+/**
+ * @file audioresampler.cpp
+ * @brief 流式多相重采样器实现
+ */
+
+#include "audioresampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#define RESAMPLER_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+// 每个相位的基础抽头数；降采样时按比例增加以保持过渡带宽度
+constexpr int BASE_TAPS_PER_PHASE = 16;
+// 通带截止频率占较低奈奎斯特频率的比例
+constexpr double ROLLOFF = 0.92;
+// Kaiser 窗参数（约 80dB 阻带衰减）
+constexpr double KAISER_BETA = 8.0;
+constexpr double PI = 3.14159265358979323846;
+
+// 第一类零阶修正贝塞尔函数（级数展开）
+double besselI0(double x)
+{
+  double sum = 1.0;
+  double term = 1.0;
+  const double halfX = x / 2.0;
+  for (int k = 1; k < 50; ++k)
+  {
+    term *= (halfX / k) * (halfX / k);
+    sum += term;
+    if (term < sum * 1e-12)
+      break;
+  }
+  return sum;
+}
+
+float dot(const float *a, const float *b, int n)
+{
+#ifdef RESAMPLER_SSE
+  // 抽头数已补齐为 4 的倍数
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+  int i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4),
+                                       _mm_loadu_ps(b + i + 4)));
+  }
+  for (; i + 4 <= n; i += 4)
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  acc0 = _mm_add_ps(acc0, acc1);
+  // 水平求和
+  __m128 shuf = _mm_shuffle_ps(acc0, acc0, _MM_SHUFFLE(2, 3, 0, 1));
+  __m128 sums = _mm_add_ps(acc0, shuf);
+  shuf = _mm_movehl_ps(shuf, sums);
+  sums = _mm_add_ss(sums, shuf);
+  float result = _mm_cvtss_f32(sums);
+  for (; i < n; ++i)
+    result += a[i] * b[i];
+  return result;
+#else
+  float result = 0.0f;
+  for (int i = 0; i < n; ++i)
+    result += a[i] * b[i];
+  return result;
+#endif
+}
+
+inline int16_t floatToInt16(float v)
+{
+  const long r = std::lrintf(v);
+  return static_cast<int16_t>(std::min(32767L, std::max(-32768L, r)));
+}
+
+} // namespace
+
+// ==================== PolyphaseFilterBank ====================
+
+std::shared_ptr<const PolyphaseFilterBank>
+PolyphaseFilterBank::get(int inRate, int outRate)
+{
+  static std::mutex s_mutex;
+  static std::map<std::pair<int, int>,
+                  std::shared_ptr<const PolyphaseFilterBank>>
+      s_cache;
+
+  std::lock_guard<std::mutex> lock(s_mutex);
+  auto &entry = s_cache[{inRate, outRate}];
+  if (!entry)
+    entry = std::make_shared<const PolyphaseFilterBank>(inRate, outRate);
+  return entry;
+}
+
+PolyphaseFilterBank::PolyphaseFilterBank(int inRate, int outRate)
+    : m_inRate(inRate), m_outRate(outRate)
+{
+  const int g = std::gcd(inRate, outRate);
+  m_up = outRate / g;
+  m_down = inRate / g;
+
+  // 降采样时截止频率降低，需要更多抽头维持同样的过渡带
+  const int decim = (m_down + m_up - 1) / m_up;
+  m_taps = BASE_TAPS_PER_PHASE * std::max(1, decim);
+  m_taps = (m_taps + 3) & ~3; // 补齐为 4 的倍数，便于向量化
+
+  // 原型低通滤波器工作在上采样后的速率 inRate × L
+  const int length = m_up * m_taps;
+  const double center = (length - 1) / 2.0;
+  const double cutoff = ROLLOFF * 0.5 *
+                        std::min(1.0, static_cast<double>(m_up) / m_down) /
+                        m_up; // 归一化到上采样速率（周期/采样）
+
+  std::vector<double> proto(length);
+  double sum = 0.0;
+  const double i0Beta = besselI0(KAISER_BETA);
+  for (int m = 0; m < length; ++m)
+  {
+    const double x = m - center;
+    const double sinc =
+        (x == 0.0) ? 2.0 * cutoff
+                   : std::sin(2.0 * PI * cutoff * x) / (PI * x);
+    const double r = x / (center + 1.0);
+    const double window = besselI0(KAISER_BETA * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0Beta;
+    proto[m] = sinc * window;
+    sum += proto[m];
+  }
+
+  // 归一化使每个相位的直流增益约为 1（插值补偿 L 倍增益）
+  const double gain = m_up / sum;
+
+  // 相位 p 的第 k 个抽头作用于 x[n-k]；按输入时间正序存放以便点积
+  m_coeffs.assign(static_cast<size_t>(m_up) * m_taps, 0.0f);
+  for (int p = 0; p < m_up; ++p)
+  {
+    float *dst = m_coeffs.data() + static_cast<size_t>(p) * m_taps;
+    for (int k = 0; k < m_taps; ++k)
+    {
+      dst[m_taps - 1 - k] =
+          static_cast<float>(proto[static_cast<size_t>(k) * m_up + p] * gain);
+    }
+  }
+}
+
+// ==================== AudioResampler ====================
+
+AudioResampler::AudioResampler(int inRate, int outRate)
+    : m_bank(PolyphaseFilterBank::get(inRate, outRate))
+{
+  reset();
+}
+
+void AudioResampler::reset()
+{
+  // 以 T-1 个零作为初始历史，使第一个输出对齐到第一个输入采样
+  const int history = m_bank->tapsPerPhase() - 1;
+  if (static_cast<int>(m_buf.size()) < history)
+    m_buf.resize(history);
+  std::fill(m_buf.begin(), m_buf.begin() + history, 0.0f);
+  m_bufLen = history;
+  m_time = 0;
+}
+
+int AudioResampler::maxOutputSamples(int inputSamples) const
+{
+  const int64_t span =
+      static_cast<int64_t>(m_bank->tapsPerPhase() + inputSamples) *
+      m_bank->upFactor();
+  return static_cast<int>(span / m_bank->downFactor()) + 2;
+}
+
+int AudioResampler::process(const int16_t *in, int inputSamples, int16_t *out)
+{
+  if (inputSamples <= 0)
+    return 0;
+
+  const int taps = m_bank->tapsPerPhase();
+  const int up = m_bank->upFactor();
+  const int down = m_bank->downFactor();
+
+  // 追加新输入（int16 → float）
+  const int needed = m_bufLen + inputSamples;
+  if (static_cast<int>(m_buf.size()) < needed)
+    m_buf.resize(needed);
+  float *buf = m_buf.data();
+  for (int i = 0; i < inputSamples; ++i)
+    buf[m_bufLen + i] = static_cast<float>(in[i]);
+  m_bufLen = needed;
+
+  int produced = 0;
+  while (true)
+  {
+    const int64_t start = m_time / up;
+    if (start + taps > m_bufLen)
+      break;
+    const int phase = static_cast<int>(m_time % up);
+    out[produced++] = floatToInt16(dot(m_bank->phase(phase), buf + start, taps));
+    m_time += down;
+  }
+
+  // 丢弃不再需要的输入，保留窗口所需的历史（最多 T-1 + 少量采样）
+  const int consumed = static_cast<int>(std::min<int64_t>(m_time / up, m_bufLen));
+  if (consumed > 0)
+  {
+    std::memmove(buf, buf + consumed,
+                 static_cast<size_t>(m_bufLen - consumed) * sizeof(float));
+    m_bufLen -= consumed;
+    m_time -= static_cast<int64_t>(consumed) * up;
+  }
+
+  return produced;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file audioresampler.h
+ * @brief 流式多相（polyphase）重采样器
+ *
+ * 用于把远程参会者的 16kHz / 44.1kHz 等音频转换到混音器输出采样率：
+ * 1. 有理数比例 L/M = outRate/inRate（约分后），Kaiser 窗 sinc 低通原型
+ *    滤波器拆分为 L 个相位，每个输出采样只计算一个相位的 T 个抽头
+ * 2. 滤波器组按 (inRate, outRate) 缓存，所有参会者共享同一份系数
+ * 3. AudioResampler 保存跨块的历史采样和相位，分块处理与一次性处理结果
+ *    完全一致，块边界不产生咔哒声
+ * 4. 抽头点积使用 SSE 向量化（非 x86 平台回退标量实现）
+ */
+
+#ifndef AUDIORESAMPLER_H
+#define AUDIORESAMPLER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief 只读的多相滤波器组（按采样率对缓存共享）
+ */
+class PolyphaseFilterBank
+{
+public:
+  /**
+   * @brief 获取（必要时构建）指定采样率对的滤波器组，线程安全
+   */
+  static std::shared_ptr<const PolyphaseFilterBank> get(int inRate,
+                                                        int outRate);
+
+  int inRate() const { return m_inRate; }
+  int outRate() const { return m_outRate; }
+  int upFactor() const { return m_up; }     // L
+  int downFactor() const { return m_down; } // M
+  int tapsPerPhase() const { return m_taps; }
+
+  /** @brief 第 phase 个相位的系数（长度 tapsPerPhase()，按输入时间正序） */
+  const float *phase(int phase) const
+  {
+    return m_coeffs.data() + static_cast<size_t>(phase) * m_taps;
+  }
+
+  PolyphaseFilterBank(int inRate, int outRate);
+
+private:
+  int m_inRate;
+  int m_outRate;
+  int m_up = 1;
+  int m_down = 1;
+  int m_taps = 0;
+  std::vector<float> m_coeffs; // [phase][tap]，tap 按输入时间正序
+};
+
+/**
+ * @brief 带状态的流式重采样器（单线程使用）
+ */
+class AudioResampler
+{
+public:
+  AudioResampler(int inRate, int outRate);
+
+  int inRate() const { return m_bank->inRate(); }
+  int outRate() const { return m_bank->outRate(); }
+
+  /** @brief 处理 inputSamples 个输入时最多可能产生的输出采样数 */
+  int maxOutputSamples(int inputSamples) const;
+
+  /**
+   * @brief 处理一块单声道 int16 输入
+   * @param out 输出缓冲区，容量至少为 maxOutputSamples(inputSamples)
+   * @return 本次产生的输出采样数
+   */
+  int process(const int16_t *in, int inputSamples, int16_t *out);
+
+  /** @brief 清空历史（流中断后重新开始时调用） */
+  void reset();
+
+private:
+  std::shared_ptr<const PolyphaseFilterBank> m_bank;
+
+  // 输入历史 + 本块输入（float），前 m_bufLen 个有效
+  std::vector<float> m_buf;
+  int m_bufLen = 0;
+
+  // 下一个输出采样在 m_buf 中的位置，以 1/L 输入采样为单位
+  int64_t m_time = 0;
+};
+
+#endif // AUDIORESAMPLER_H
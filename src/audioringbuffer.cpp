@@ -0,0 +1,113 @@
+/**
+ * @file audioringbuffer.cpp
+ * @brief SPSC 无锁 PCM 环形缓冲区实现
+ */
+
+#include "audioringbuffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+size_t roundUpToPowerOfTwo(size_t v)
+{
+  size_t p = 1;
+  while (p < v)
+    p <<= 1;
+  return p;
+}
+} // namespace
+
+AudioRingBuffer::AudioRingBuffer(int minCapacitySamples)
+{
+  const size_t cap =
+      roundUpToPowerOfTwo(static_cast<size_t>(std::max(minCapacitySamples, 2)));
+  m_data.resize(cap);
+  m_mask = cap - 1;
+}
+
+int AudioRingBuffer::available() const
+{
+  const size_t w = m_writeIndex.load(std::memory_order_acquire);
+  const size_t r = m_readIndex.load(std::memory_order_acquire);
+  return static_cast<int>(w - r);
+}
+
+int AudioRingBuffer::freeSpace() const { return capacity() - available(); }
+
+int AudioRingBuffer::write(const int16_t *src, int count)
+{
+  if (count <= 0)
+    return 0;
+
+  // 生产者独占写索引，relaxed 读取即可；读索引需 acquire 以确认消费者已读完
+  const size_t w = m_writeIndex.load(std::memory_order_relaxed);
+  const size_t r = m_readIndex.load(std::memory_order_acquire);
+  const int space = capacity() - static_cast<int>(w - r);
+  const int n = std::min(count, space);
+
+  if (n < count)
+  {
+    m_dropped.fetch_add(static_cast<uint64_t>(count - n),
+                        std::memory_order_relaxed);
+  }
+  if (n <= 0)
+    return 0;
+
+  // 最多分两段拷贝（跨越缓冲区末尾时回绕）
+  const size_t pos = w & m_mask;
+  const size_t first = std::min(static_cast<size_t>(n), m_data.size() - pos);
+  std::memcpy(m_data.data() + pos, src, first * sizeof(int16_t));
+  if (first < static_cast<size_t>(n))
+  {
+    std::memcpy(m_data.data(), src + first,
+                (static_cast<size_t>(n) - first) * sizeof(int16_t));
+  }
+
+  m_writeIndex.store(w + static_cast<size_t>(n), std::memory_order_release);
+  return n;
+}
+
+int AudioRingBuffer::read(int16_t *dst, int count)
+{
+  if (count <= 0)
+    return 0;
+
+  const size_t r = m_readIndex.load(std::memory_order_relaxed);
+  const size_t w = m_writeIndex.load(std::memory_order_acquire);
+  const int n = std::min(count, static_cast<int>(w - r));
+  if (n <= 0)
+    return 0;
+
+  const size_t pos = r & m_mask;
+  const size_t first = std::min(static_cast<size_t>(n), m_data.size() - pos);
+  std::memcpy(dst, m_data.data() + pos, first * sizeof(int16_t));
+  if (first < static_cast<size_t>(n))
+  {
+    std::memcpy(dst + first, m_data.data(),
+                (static_cast<size_t>(n) - first) * sizeof(int16_t));
+  }
+
+  m_readIndex.store(r + static_cast<size_t>(n), std::memory_order_release);
+  return n;
+}
+
+int AudioRingBuffer::skip(int count)
+{
+  if (count <= 0)
+    return 0;
+
+  const size_t r = m_readIndex.load(std::memory_order_relaxed);
+  const size_t w = m_writeIndex.load(std::memory_order_acquire);
+  const int n = std::min(count, static_cast<int>(w - r));
+  if (n <= 0)
+    return 0;
+
+  m_readIndex.store(r + static_cast<size_t>(n), std::memory_order_release);
+  return n;
+}
+
+uint64_t AudioRingBuffer::droppedSamples() const
+{
+  return m_dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,74 @@
+/**
+ * @file audioringbuffer.h
+ * @brief 单生产者/单消费者（SPSC）无锁 PCM 环形缓冲区
+ *
+ * 用于 RemoteAudioPlayer（生产者，播放线程）→ AudioMixer（消费者）之间
+ * 传递 int16_t 采样：
+ * 1. 容量在构造时固定（向上取整到 2 的幂），运行期不再分配内存
+ * 2. 写入 / 读取均为 O(chunk) 的 memcpy，不搬移已缓存数据
+ * 3. 读写索引为单调递增的原子计数器，生产者与消费者互不等待（wait-free）
+ *
+ * 线程约束：write() 只能由同一个生产者线程调用，read()/skip() 只能由
+ * 同一个消费者线程调用；available()/freeSpace() 两端均可调用。
+ */
+
+#ifndef AUDIORINGBUFFER_H
+#define AUDIORINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class AudioRingBuffer
+{
+public:
+  /**
+   * @param minCapacitySamples 最小容量（采样数），实际容量向上取整到 2 的幂
+   */
+  explicit AudioRingBuffer(int minCapacitySamples);
+
+  AudioRingBuffer(const AudioRingBuffer &) = delete;
+  AudioRingBuffer &operator=(const AudioRingBuffer &) = delete;
+
+  /** @brief 实际容量（采样数） */
+  int capacity() const { return static_cast<int>(m_mask + 1); }
+
+  /** @brief 当前可读采样数 */
+  int available() const;
+
+  /** @brief 当前可写采样数 */
+  int freeSpace() const;
+
+  /**
+   * @brief 写入采样（仅生产者线程）
+   * @return 实际写入的采样数；空间不足时多余部分被丢弃并计入 droppedSamples()
+   */
+  int write(const int16_t *src, int count);
+
+  /**
+   * @brief 读取采样（仅消费者线程）
+   * @return 实际读取的采样数（不超过 available()）
+   */
+  int read(int16_t *dst, int count);
+
+  /**
+   * @brief 丢弃最旧的采样（仅消费者线程）
+   * @return 实际丢弃的采样数
+   */
+  int skip(int count);
+
+  /** @brief 因缓冲区已满被丢弃的采样总数 */
+  uint64_t droppedSamples() const;
+
+private:
+  std::vector<int16_t> m_data;
+  size_t m_mask = 0;
+
+  // 读写索引分别位于独立的缓存行，避免生产者/消费者伪共享
+  alignas(64) std::atomic<size_t> m_writeIndex{0};
+  alignas(64) std::atomic<size_t> m_readIndex{0};
+  alignas(64) std::atomic<uint64_t> m_dropped{0};
+};
+
+#endif // AUDIORINGBUFFER_H
@@ -0,0 +1,137 @@
+/**
+ * @file boundedqueue.h
+ * @brief 有界阻塞队列（流水线阶段之间传递数据）
+ *
+ * - push()：队列满时阻塞，形成反压；tryPush()：满时立即返回 false（丢弃）
+ * - pop()：队列空时阻塞；close() 之后取完剩余元素返回 false，消费者据此退出
+ * - 每个元素记录入队时间，pop() 返回其排队时长，供阶段延迟统计
+ *
+ * 容量很小（几帧），用互斥锁 + 条件变量即可，不追求无锁。
+ */
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <chrono>
+#include <deque>
+#include <utility>
+
+template <typename T> class BoundedQueue
+{
+public:
+    explicit BoundedQueue(int capacity) : m_capacity(capacity > 0 ? capacity : 1)
+    {
+    }
+
+    /** @brief 入队，队列满时阻塞；已关闭时返回 false */
+    bool push(T item)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_closed && static_cast<int>(m_items.size()) >= m_capacity)
+            m_notFull.wait(&m_mutex);
+        if (m_closed)
+            return false;
+        enqueueLocked(std::move(item));
+        return true;
+    }
+
+    /** @brief 入队，队列满或已关闭时立即返回 false */
+    bool tryPush(T item)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_closed || static_cast<int>(m_items.size()) >= m_capacity)
+            return false;
+        enqueueLocked(std::move(item));
+        return true;
+    }
+
+    /**
+     * @brief 出队，队列空时阻塞
+     * @param waitUs 输出该元素的排队时长（微秒），可为空
+     * @return 已关闭且取空时返回 false
+     */
+    bool pop(T &item, qint64 *waitUs = nullptr)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_closed && m_items.empty())
+            m_notEmpty.wait(&m_mutex);
+        if (m_items.empty())
+            return false;
+
+        Entry entry = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.wakeOne();
+        locker.unlock();
+
+        if (waitUs)
+        {
+            *waitUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                          Clock::now() - entry.enqueuedAt)
+                          .count();
+        }
+        item = std::move(entry.item);
+        return true;
+    }
+
+    /** @brief 关闭队列：唤醒所有等待者，之后不再接受新元素 */
+    void close()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_notEmpty.wakeAll();
+        m_notFull.wakeAll();
+    }
+
+    /** @brief 清空并重新打开（仅在没有生产者 / 消费者时调用） */
+    void reset()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_items.clear();
+        m_closed = false;
+        m_maxDepth = 0;
+    }
+
+    int size() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return static_cast<int>(m_items.size());
+    }
+
+    /** @brief reset() 以来的最大深度 */
+    int maxDepth() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_maxDepth;
+    }
+
+    int capacity() const { return m_capacity; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        T item;
+        Clock::time_point enqueuedAt;
+    };
+
+    void enqueueLocked(T item)
+    {
+        m_items.push_back({std::move(item), Clock::now()});
+        if (static_cast<int>(m_items.size()) > m_maxDepth)
+            m_maxDepth = static_cast<int>(m_items.size());
+        m_notEmpty.wakeOne();
+    }
+
+    const int m_capacity;
+    mutable QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    std::deque<Entry> m_items;
+    int m_maxDepth = 0;
+    bool m_closed = false;
+};
+
+#endif // BOUNDEDQUEUE_H
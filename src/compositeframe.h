@@ -0,0 +1,45 @@
+/**
+ * @file compositeframe.h
+ * @brief 合成器 YUV 输出帧句柄
+ *
+ * VideoCompositor 在 YUV420P 输出模式下通过 AVFrameRef 发出合成帧：
+ * 句柄持有对合成器画布缓冲的一个 AVBuffer 引用（不拷贝像素），
+ * 最后一个持有者释放时自动 av_frame_free，缓冲随之回到合成器的帧池。
+ * 合成器在缓冲仍被下游持有时不会改写它（写前检查 av_frame_is_writable）。
+ */
+
+#ifndef COMPOSITEFRAME_H
+#define COMPOSITEFRAME_H
+
+#include <QMetaType>
+#include <memory>
+
+extern "C"
+{
+#include <libavutil/frame.h>
+}
+
+using AVFrameRef = std::shared_ptr<AVFrame>;
+
+/**
+ * @brief 创建引用 src 缓冲的新句柄（av_frame_ref，不拷贝像素）
+ * @return src 为空或引用失败时返回空句柄
+ */
+inline AVFrameRef makeAVFrameRef(const AVFrame *src)
+{
+    if (!src)
+        return {};
+    AVFrame *frame = av_frame_alloc();
+    if (!frame)
+        return {};
+    if (av_frame_ref(frame, src) < 0)
+    {
+        av_frame_free(&frame);
+        return {};
+    }
+    return AVFrameRef(frame, [](AVFrame *f) { av_frame_free(&f); });
+}
+
+Q_DECLARE_METATYPE(AVFrameRef)
+
+#endif // COMPOSITEFRAME_H
@@ -0,0 +1,469 @@
+/**
+ * @file encoderprofile.cpp
+ * @brief 录制视频编码配置与实时性校准实现
+ */
+
+#include "encoderprofile.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <algorithm>
+#include <vector>
+
+extern "C"
+{
+#include <libavutil/opt.h>
+}
+
+#ifdef Q_OS_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+
+// 进程累计 CPU 时间（用户 + 内核，所有线程），纳秒；编码器自带线程池，
+// 只统计调用线程会严重低估
+qint64 processCpuNs()
+{
+#ifdef Q_OS_WIN
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return static_cast<qint64>(k.QuadPart + u.QuadPart) * 100;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return (static_cast<qint64>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+                1000000 +
+            usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) *
+           1000;
+#endif
+}
+
+const char *codecKey(EncoderProfile::Codec codec)
+{
+    switch (codec)
+    {
+    case EncoderProfile::Codec::Hevc:
+        return "hevc";
+    case EncoderProfile::Codec::Av1:
+        return "av1";
+    case EncoderProfile::Codec::H264:
+    default:
+        return "h264";
+    }
+}
+
+// 不同源帧数：超过编码器参考帧数即可，避免循环帧被当作静止画面
+constexpr int SYNTHETIC_FRAME_COUNT = 16;
+
+// 合成一帧 3x3 宫格会议画面（YUV420P）：每格为随帧移动的渐变和一个
+// 移动的"人像"椭圆，叠加轻微噪声模拟摄像头画面
+AVFrame *makeSyntheticFrame(int width, int height, int index)
+{
+    AVFrame *frame = av_frame_alloc();
+    if (!frame)
+        return nullptr;
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = width;
+    frame->height = height;
+    if (av_frame_get_buffer(frame, 0) < 0)
+    {
+        av_frame_free(&frame);
+        return nullptr;
+    }
+
+    constexpr int GRID = 3;
+    const int tileW = std::max(1, width / GRID);
+    const int tileH = std::max(1, height / GRID);
+    quint32 noise = 0x9E3779B9u * static_cast<quint32>(index + 1);
+
+    for (int y = 0; y < height; ++y)
+    {
+        uint8_t *luma = frame->data[0] + y * frame->linesize[0];
+        const int ty = std::min(y / tileH, GRID - 1);
+        for (int x = 0; x < width; ++x)
+        {
+            const int tx = std::min(x / tileW, GRID - 1);
+            const int tile = ty * GRID + tx;
+            const int lx = x - tx * tileW;
+            const int ly = y - ty * tileH;
+
+            // 椭圆中心随帧和宫格位置移动
+            const int cx = tileW / 2 + ((index * (3 + tile)) % 21 - 10) * tileW / 80;
+            const int cy = tileH / 2 + ((index * (2 + tile)) % 13 - 6) * tileH / 80;
+            const int dx = (lx - cx) * 100 / std::max(1, tileW / 4);
+            const int dy = (ly - cy) * 100 / std::max(1, tileH / 3);
+            const bool face = dx * dx + dy * dy < 10000;
+
+            noise = noise * 1664525u + 1013904223u;
+            const int grain = static_cast<int>(noise >> 29) - 4;
+            const int base = face ? 170 : 40 + ((lx + ly + index * 4 + tile * 17) & 127);
+            luma[x] = static_cast<uint8_t>(std::clamp(base + grain, 16, 235));
+        }
+    }
+
+    for (int plane = 1; plane <= 2; ++plane)
+    {
+        for (int y = 0; y < height / 2; ++y)
+        {
+            uint8_t *chroma = frame->data[plane] + y * frame->linesize[plane];
+            const int ty = std::min(y * 2 / tileH, GRID - 1);
+            for (int x = 0; x < width / 2; ++x)
+            {
+                const int tx = std::min(x * 2 / tileW, GRID - 1);
+                const int tint = ((ty * GRID + tx) * 23 + plane * 41) % 64;
+                chroma[x] = static_cast<uint8_t>(96 + tint);
+            }
+        }
+    }
+    return frame;
+}
+
+// 收取编码器输出的全部 packet，返回字节数
+qint64 drainPackets(AVCodecContext *ctx, AVPacket *pkt)
+{
+    qint64 bytes = 0;
+    while (avcodec_receive_packet(ctx, pkt) >= 0)
+    {
+        bytes += pkt->size;
+        av_packet_unref(pkt);
+    }
+    return bytes;
+}
+
+} // namespace
+
+// ==============================================================================
+// EncoderProfile
+// ==============================================================================
+
+const char *EncoderProfile::encoderName() const
+{
+    switch (codec)
+    {
+    case Codec::Hevc:
+        return "libx265";
+    case Codec::Av1:
+        return "libsvtav1";
+    case Codec::H264:
+    default:
+        return "libx264";
+    }
+}
+
+bool EncoderProfile::isAvailable() const
+{
+    return avcodec_find_encoder_by_name(encoderName()) != nullptr;
+}
+
+QString EncoderProfile::toString() const
+{
+    const QString rate = rateControl == RateControl::Crf
+                             ? QString("crf%1").arg(crf)
+                             : QString("%1k").arg(bitrateKbps);
+    return QString("%1/%2/%3/t%4")
+        .arg(QString::fromLatin1(codecKey(codec)), preset, rate)
+        .arg(threads);
+}
+
+EncoderProfile EncoderProfile::fromString(const QString &text, bool *ok)
+{
+    EncoderProfile profile;
+    const QStringList parts = text.trimmed().split('/');
+    bool valid = parts.size() == 4 && !parts[1].isEmpty();
+
+    if (valid)
+    {
+        if (parts[0] == "h264")
+            profile.codec = Codec::H264;
+        else if (parts[0] == "hevc")
+            profile.codec = Codec::Hevc;
+        else if (parts[0] == "av1")
+            profile.codec = Codec::Av1;
+        else
+            valid = false;
+    }
+    if (valid)
+    {
+        profile.preset = parts[1];
+        bool numOk = false;
+        if (parts[2].startsWith("crf"))
+        {
+            profile.rateControl = RateControl::Crf;
+            profile.crf = parts[2].mid(3).toInt(&numOk);
+        }
+        else if (parts[2].endsWith('k'))
+        {
+            profile.rateControl = RateControl::Bitrate;
+            profile.bitrateKbps = parts[2].chopped(1).toInt(&numOk);
+            numOk = numOk && profile.bitrateKbps > 0;
+        }
+        valid = numOk;
+    }
+    if (valid)
+    {
+        bool numOk = false;
+        profile.threads =
+            parts[3].startsWith('t') ? parts[3].mid(1).toInt(&numOk) : 0;
+        valid = numOk && profile.threads >= 0;
+    }
+
+    if (ok)
+        *ok = valid;
+    return valid ? profile : EncoderProfile();
+}
+
+QList<EncoderProfile> EncoderProfile::defaultCandidates()
+{
+    auto make = [](Codec codec, const char *preset, int crf)
+    {
+        EncoderProfile p;
+        p.codec = codec;
+        p.preset = QString::fromLatin1(preset);
+        p.crf = crf;
+        return p;
+    };
+    // 各编码器的 crf 取大致相当的画质
+    return {make(Codec::H264, "fast", 23),      make(Codec::H264, "veryfast", 23),
+            make(Codec::H264, "superfast", 23), make(Codec::H264, "ultrafast", 23),
+            make(Codec::Hevc, "veryfast", 28),  make(Codec::Hevc, "ultrafast", 28),
+            make(Codec::Av1, "10", 35),         make(Codec::Av1, "12", 35)};
+}
+
+bool EncoderProfile::operator==(const EncoderProfile &other) const
+{
+    return codec == other.codec && preset == other.preset &&
+           rateControl == other.rateControl && crf == other.crf &&
+           bitrateKbps == other.bitrateKbps && threads == other.threads;
+}
+
+// ==============================================================================
+// 打开编码器
+// ==============================================================================
+
+AVCodecContext *openVideoEncoder(const EncoderProfile &profile, int width,
+                                 int height, int fps, AVRational timeBase,
+                                 int gopSize, bool globalHeader)
+{
+    const AVCodec *codec = avcodec_find_encoder_by_name(profile.encoderName());
+    if (!codec)
+    {
+        qWarning() << "[EncoderProfile] 未找到编码器:" << profile.encoderName();
+        return nullptr;
+    }
+
+    AVCodecContext *ctx = avcodec_alloc_context3(codec);
+    if (!ctx)
+        return nullptr;
+    ctx->width = width;
+    ctx->height = height;
+    ctx->time_base = timeBase;
+    ctx->framerate = {fps, 1};
+    ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+    ctx->gop_size = gopSize;
+    ctx->max_b_frames = 0; // 简化: 不使用 B 帧
+    ctx->thread_count = profile.threads;
+    if (globalHeader)
+        ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+    av_opt_set(ctx->priv_data, "preset", profile.preset.toUtf8().constData(), 0);
+
+    switch (profile.codec)
+    {
+    case EncoderProfile::Codec::H264:
+        av_opt_set(ctx->priv_data, "tune", "zerolatency", 0);
+        // 帧级多线程：zerolatency 默认用切片线程，单帧延迟低但
+        // 并行度受切片数限制；录制只需吞吐，显式指定帧线程（多几帧编码延迟）
+        ctx->thread_type = FF_THREAD_FRAME;
+        break;
+    case EncoderProfile::Codec::Hevc:
+        av_opt_set(ctx->priv_data, "tune", "zerolatency", 0);
+        // Apple 播放器只识别 hvc1 标签的 HEVC MP4
+        ctx->codec_tag = MKTAG('h', 'v', 'c', '1');
+        break;
+    case EncoderProfile::Codec::Av1:
+        // SVT-AV1 不读取 thread_count，线程数通过 lp（并行度）传入
+        if (profile.threads > 0)
+        {
+            av_opt_set(ctx->priv_data, "svtav1-params",
+                       QString("lp=%1").arg(profile.threads).toUtf8().constData(),
+                       0);
+        }
+        break;
+    }
+
+    if (profile.rateControl == EncoderProfile::RateControl::Crf)
+    {
+        ctx->bit_rate = 0;
+        av_opt_set_int(ctx->priv_data, "crf", profile.crf, 0);
+    }
+    else
+    {
+        // 平均码率 + VBV：峰值不超过目标码率，缓冲 2 秒
+        ctx->bit_rate = static_cast<int64_t>(profile.bitrateKbps) * 1000;
+        ctx->rc_max_rate = ctx->bit_rate;
+        ctx->rc_buffer_size = static_cast<int>(ctx->bit_rate * 2);
+    }
+
+    const int ret = avcodec_open2(ctx, codec, nullptr);
+    if (ret < 0)
+    {
+        qWarning() << "[EncoderProfile] 编码器打开失败:" << profile.toString()
+                   << ret;
+        avcodec_free_context(&ctx);
+        return nullptr;
+    }
+    return ctx;
+}
+
+// ==============================================================================
+// EncoderCalibrator
+// ==============================================================================
+
+EncoderCalibrator::EncoderCalibrator(int width, int height, int fps)
+    : m_width(width), m_height(height), m_fps(std::max(1, fps))
+{
+}
+
+void EncoderCalibrator::setDurationSeconds(int seconds)
+{
+    m_durationSeconds = std::max(1, seconds);
+}
+
+void EncoderCalibrator::setRealtimeMargin(double margin)
+{
+    m_realtimeMargin = std::max(1.0, margin);
+}
+
+void EncoderCalibrator::setCancelFlag(const std::atomic<bool> *cancelled)
+{
+    m_cancelled = cancelled;
+}
+
+EncoderCalibrator::Result
+EncoderCalibrator::measure(const EncoderProfile &profile) const
+{
+    Result result;
+    result.profile = profile;
+
+    AVCodecContext *ctx = openVideoEncoder(profile, m_width, m_height, m_fps,
+                                           {1, m_fps}, m_fps * 2, true);
+    if (!ctx)
+        return result;
+    result.available = true;
+
+    // 预先生成源帧，计时只包含编码
+    std::vector<AVFrame *> frames;
+    for (int i = 0; i < SYNTHETIC_FRAME_COUNT; ++i)
+    {
+        if (AVFrame *frame = makeSyntheticFrame(m_width, m_height, i))
+            frames.push_back(frame);
+    }
+    AVPacket *pkt = av_packet_alloc();
+
+    if (!frames.empty() && pkt)
+    {
+        const int total = m_fps * m_durationSeconds;
+        QElapsedTimer wall;
+        wall.start();
+        const qint64 cpuStart = processCpuNs();
+
+        for (int i = 0; i < total; ++i)
+        {
+            if (isCancelled())
+            {
+                result.available = false; // 中断的测量不参与选择
+                break;
+            }
+            AVFrame *frame = frames[static_cast<size_t>(i) % frames.size()];
+            frame->pts = i;
+            if (avcodec_send_frame(ctx, frame) < 0)
+                break;
+            result.bytes += drainPackets(ctx, pkt);
+        }
+        avcodec_send_frame(ctx, nullptr);
+        result.bytes += drainPackets(ctx, pkt);
+
+        if (result.available)
+        {
+            const double seconds = wall.nsecsElapsed() / 1e9;
+            const double cpuMs = (processCpuNs() - cpuStart) / 1e6;
+            result.encodeFps = seconds > 0.0 ? total / seconds : 0.0;
+            result.cpuMsPerFrame = cpuMs / total;
+            result.realtime = result.encodeFps >= m_fps * m_realtimeMargin;
+        }
+    }
+
+    av_packet_free(&pkt);
+    for (AVFrame *frame : frames)
+        av_frame_free(&frame);
+    avcodec_free_context(&ctx);
+
+    qDebug() << "[EncoderCalibrator]" << profile.toString()
+             << "fps:" << result.encodeFps
+             << "cpu ms/帧:" << result.cpuMsPerFrame
+             << "字节:" << result.bytes << "实时:" << result.realtime;
+    return result;
+}
+
+QList<EncoderCalibrator::Result>
+EncoderCalibrator::run(const QList<EncoderProfile> &candidates) const
+{
+    QList<Result> results;
+    for (const EncoderProfile &profile : candidates)
+    {
+        if (isCancelled())
+            break;
+        results.append(measure(profile));
+    }
+    return results;
+}
+
+EncoderProfile EncoderCalibrator::pick(const QList<Result> &results,
+                                       const EncoderProfile &fallback)
+{
+    const Result *best = nullptr;
+    for (const Result &r : results)
+    {
+        if (r.available && r.realtime &&
+            (!best || r.cpuMsPerFrame < best->cpuMsPerFrame))
+            best = &r;
+    }
+    if (best)
+        return best->profile;
+
+    // 没有配置能跑满实时：选吞吐最高的，尽量减少丢帧
+    for (const Result &r : results)
+    {
+        if (r.available && (!best || r.encodeFps > best->encodeFps))
+            best = &r;
+    }
+    if (best)
+    {
+        qWarning() << "[EncoderCalibrator] 没有配置能跑满实时, 选用最快的:"
+                   << best->profile.toString() << best->encodeFps << "fps";
+        return best->profile;
+    }
+    return fallback;
+}
+
+EncoderProfile
+EncoderCalibrator::calibrate(const QList<EncoderProfile> &candidates) const
+{
+    const EncoderProfile profile = pick(run(candidates));
+    qDebug() << "[EncoderCalibrator]" << m_width << "x" << m_height << "@"
+             << m_fps << "fps 选用:" << profile.toString();
+    return profile;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file encoderprofile.h
+ * @brief 录制视频编码配置与实时性校准
+ *
+ * EncoderProfile 描述一组视频编码参数（编码器 / 预设 / 码控 / 线程数）。
+ * MeetingRecorder 与 EncoderCalibrator 都通过 openVideoEncoder() 打开编码器，
+ * 校准测到的就是录制时实际使用的配置。
+ *
+ * EncoderCalibrator 用合成的会议画面（多宫格、带运动和噪声）逐个试编码候选
+ * 配置，记录墙钟吞吐和进程 CPU 时间，在能稳定跑满实时（留有余量）的配置中
+ * 选 CPU 开销最小的一个。
+ */
+
+#ifndef ENCODERPROFILE_H
+#define ENCODERPROFILE_H
+
+#include <QList>
+#include <QString>
+#include <atomic>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+}
+
+struct EncoderProfile
+{
+    enum class Codec
+    {
+        H264, // libx264
+        Hevc, // libx265
+        Av1   // libsvtav1
+    };
+
+    enum class RateControl
+    {
+        Crf,    // 恒定质量（crf）
+        Bitrate // 平均码率，VBV 限制峰值
+    };
+
+    Codec codec = Codec::H264;
+    QString preset = QStringLiteral("fast"); // x264 / x265 为名称，SVT-AV1 为 0~13
+    RateControl rateControl = RateControl::Crf;
+    int crf = 23;
+    int bitrateKbps = 4000;
+    int threads = 0; // 0 = 编码器自动
+
+    /** @brief FFmpeg 编码器名 */
+    const char *encoderName() const;
+
+    /** @brief 当前 FFmpeg 构建是否包含该编码器 */
+    bool isAvailable() const;
+
+    /** @brief 序列化，如 "h264/fast/crf23/t0"、"av1/10/4000k/t8" */
+    QString toString() const;
+
+    /** @brief 解析 toString() 的结果，失败时返回默认配置并置 *ok = false */
+    static EncoderProfile fromString(const QString &text, bool *ok = nullptr);
+
+    /** @brief 校准的默认候选（H.264 / HEVC / AV1 各若干预设） */
+    static QList<EncoderProfile> defaultCandidates();
+
+    bool operator==(const EncoderProfile &other) const;
+    bool operator!=(const EncoderProfile &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief 按 profile 创建并打开视频编码器（YUV420P 输入，不使用 B 帧）
+ * @param timeBase 编码器时间基
+ * @param gopSize 关键帧间隔（帧）
+ * @param globalHeader 容器要求全局头（MP4 等）时为 true
+ * @return 失败（编码器不存在或打开失败）返回 nullptr
+ */
+AVCodecContext *openVideoEncoder(const EncoderProfile &profile, int width,
+                                 int height, int fps, AVRational timeBase,
+                                 int gopSize, bool globalHeader);
+
+class EncoderCalibrator
+{
+public:
+    static constexpr int DEFAULT_DURATION_SECONDS = 3;
+    // 吞吐需达到目标帧率的倍数：录制时合成、转换和音频也要占用 CPU
+    static constexpr double DEFAULT_REALTIME_MARGIN = 1.25;
+
+    /**
+     * @brief 单个配置的校准结果
+     */
+    struct Result
+    {
+        EncoderProfile profile;
+        bool available = false;     // 编码器存在且能打开
+        double encodeFps = 0.0;     // 墙钟吞吐（帧 / 秒）
+        double cpuMsPerFrame = 0.0; // 进程 CPU 时间（含编码器线程）
+        qint64 bytes = 0;           // 输出总字节数（压缩效率参考）
+        bool realtime = false;      // encodeFps >= fps * 余量
+    };
+
+    EncoderCalibrator(int width, int height, int fps);
+
+    void setDurationSeconds(int seconds);
+    void setRealtimeMargin(double margin);
+
+    /**
+     * @brief 取消标志（可为空，生命周期须长于测量过程）
+     *
+     * 置位后 measure() 在下一帧停止、run() 不再测量后续候选，
+     * 被中断的配置视为不可用；用于在后台测量时尽快退出。
+     */
+    void setCancelFlag(const std::atomic<bool> *cancelled);
+
+    /** @brief 编码 durationSeconds 秒合成画面，测量单个配置（阻塞） */
+    Result measure(const EncoderProfile &profile) const;
+
+    /** @brief 依次测量所有候选（阻塞，耗时约 候选数 × durationSeconds） */
+    QList<Result> run(const QList<EncoderProfile> &candidates) const;
+
+    /**
+     * @brief 选出能跑满实时且 CPU 开销最小的配置
+     *
+     * 没有配置能跑满实时时选吞吐最高的；没有可用编码器时返回 fallback。
+     */
+    static EncoderProfile pick(const QList<Result> &results,
+                               const EncoderProfile &fallback = EncoderProfile());
+
+    /** @brief run() + pick() */
+    EncoderProfile calibrate(const QList<EncoderProfile> &candidates =
+                                 EncoderProfile::defaultCandidates()) const;
+
+private:
+    int m_width;
+    int m_height;
+    int m_fps;
+    int m_durationSeconds = DEFAULT_DURATION_SECONDS;
+    double m_realtimeMargin = DEFAULT_REALTIME_MARGIN;
+    const std::atomic<bool> *m_cancelled = nullptr;
+
+    bool isCancelled() const
+    {
+        return m_cancelled && m_cancelled->load(std::memory_order_relaxed);
+    }
+};
+
+#endif // ENCODERPROFILE_H
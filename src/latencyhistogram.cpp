@@ -0,0 +1,81 @@
+/**
+ * @file latencyhistogram.cpp
+ * @brief 无锁延迟直方图实现
+ */
+
+#include "latencyhistogram.h"
+#include <algorithm>
+
+namespace
+{
+// 各桶上界（微秒，不含）；最后一个桶无上界
+constexpr qint64 BUCKET_BOUNDS_US[LatencyHistogram::BUCKET_COUNT - 1] = {
+    50, 100, 250, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000};
+} // namespace
+
+qint64 LatencyHistogram::bucketUpperBoundUs(int bucket)
+{
+  if (bucket < 0 || bucket >= BUCKET_COUNT - 1)
+    return -1;
+  return BUCKET_BOUNDS_US[bucket];
+}
+
+void LatencyHistogram::record(qint64 valueUs)
+{
+  const qint64 v = std::max<qint64>(0, valueUs);
+
+  int bucket = 0;
+  while (bucket < BUCKET_COUNT - 1 && v >= BUCKET_BOUNDS_US[bucket])
+    ++bucket;
+
+  m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  m_totalUs.fetch_add(static_cast<quint64>(v), std::memory_order_relaxed);
+
+  qint64 prevMax = m_maxUs.load(std::memory_order_relaxed);
+  while (v > prevMax &&
+         !m_maxUs.compare_exchange_weak(prevMax, v, std::memory_order_relaxed))
+  {
+  }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+  Snapshot s;
+  for (int i = 0; i < BUCKET_COUNT; ++i)
+    s.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+  s.count = m_count.load(std::memory_order_relaxed);
+  s.totalUs = m_totalUs.load(std::memory_order_relaxed);
+  s.maxUs = m_maxUs.load(std::memory_order_relaxed);
+  return s;
+}
+
+void LatencyHistogram::reset()
+{
+  for (auto &b : m_buckets)
+    b.store(0, std::memory_order_relaxed);
+  m_count.store(0, std::memory_order_relaxed);
+  m_totalUs.store(0, std::memory_order_relaxed);
+  m_maxUs.store(0, std::memory_order_relaxed);
+}
+
+qint64 LatencyHistogram::Snapshot::percentileUs(double p) const
+{
+  if (count == 0)
+    return 0;
+
+  const quint64 rank = static_cast<quint64>(
+      std::clamp(p, 0.0, 1.0) * static_cast<double>(count - 1));
+  quint64 seen = 0;
+  for (int i = 0; i < BUCKET_COUNT; ++i)
+  {
+    seen += buckets[i];
+    if (seen > rank)
+    {
+      // 最后一个桶没有上界，用观测到的最大值代替
+      const qint64 bound = bucketUpperBoundUs(i);
+      return bound < 0 ? maxUs : std::min(bound, maxUs);
+    }
+  }
+  return maxUs;
+}
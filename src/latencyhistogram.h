@@ -0,0 +1,61 @@
+/**
+ * @file latencyhistogram.h
+ * @brief 无锁延迟直方图
+ *
+ * 用于统计周期性任务的调度延迟（如 AudioMixer 混音周期的迟到时间）：
+ * - record() 只做几次 relaxed 原子加，可在实时线程中调用
+ * - snapshot() 可在任意线程读取，返回各桶计数、最大值、均值和分位数
+ *
+ * 桶边界按对数间隔固定（50us ~ 100ms），最后一个桶收纳更大的值。
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+
+class LatencyHistogram
+{
+public:
+  static constexpr int BUCKET_COUNT = 12;
+
+  /**
+   * @brief 直方图快照（值均为微秒）
+   */
+  struct Snapshot
+  {
+    std::array<quint64, BUCKET_COUNT> buckets{};
+    quint64 count = 0;
+    quint64 totalUs = 0;
+    qint64 maxUs = 0;
+
+    double meanUs() const
+    {
+      return count > 0 ? static_cast<double>(totalUs) / count : 0.0;
+    }
+
+    /**
+     * @brief 分位数估计（返回所在桶的上界，p ∈ [0, 1]）
+     */
+    qint64 percentileUs(double p) const;
+  };
+
+  /** @brief 第 bucket 个桶的上界（不含）；最后一个桶返回 -1 表示无上界 */
+  static qint64 bucketUpperBoundUs(int bucket);
+
+  /** @brief 记录一个样本（负值按 0 计），实时线程安全 */
+  void record(qint64 valueUs);
+
+  Snapshot snapshot() const;
+  void reset();
+
+private:
+  std::array<std::atomic<quint64>, BUCKET_COUNT> m_buckets{};
+  std::atomic<quint64> m_count{0};
+  std::atomic<quint64> m_totalUs{0};
+  std::atomic<qint64> m_maxUs{0};
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -3,6 +3,7 @@
 #include <QQmlApplicationEngine> // QML引擎：负责加载、解析和管理QML文件，是QML应用的核心
 #include <QQmlContext>           // QML上下文：用于在C++和QML之间共享数据和对象
 #include <QQuickStyle>           // 样式设置：用于设置Qt Quick Controls 2的视觉样式（如Material、Fusion等）
+#include <QSettings>
 #include <QTimer>
 
 // 业务逻辑类：会议控制器、参与者模型、聊天模型
@@ -73,6 +74,13 @@ int main(int argc, char *argv[])
   ChatModel chatModel;
   AIAssistant aiAssistant;
   AudioMixer audioMixer;
+  // top-N 混音默认关闭（混合全部参会者）；大房间可在设置中开启，
+  // 只混合最响的几位说话人，其余输入仅推进读位置
+  {
+    QSettings audioSettings("MeetingApp", "Audio");
+    audioMixer.setMaxActiveSpeakers(
+        audioSettings.value("maxActiveSpeakers", 0).toInt());
+  }
 
   // ========== 7. 上下文属性设置 ==========
   // 将C++对象注册为QML全局属性，使其可以在QML中直接访问
@@ -182,9 +190,14 @@ int main(int argc, char *argv[])
     QObject::connect(mc, &MediaCapture::rawAudioCaptured, &audioMixer,
                      &AudioMixer::feedLocalAudio);
   }
-  // AudioMixer 混合输出 → AIAssistant
-  QObject::connect(&audioMixer, &AudioMixer::mixedAudioReady, &aiAssistant,
-                   &AIAssistant::feedAudioData);
+  // AudioMixer 混合输出 → AIAssistant（登记 ASR 所需的 16kHz int16 输出，
+  // 重采样在混音线程完成）。pushAsrAudio 写入 SPSC 环形缓冲，直接在混音
+  // 线程调用，GUI 线程每秒取出追加，不经事件循环逐周期排队；audioMixer
+  // 在 aiAssistant 之后声明，先析构（停止混音线程），不会调用到已销毁的对象
+  AudioMixerOutput *asrAudio = audioMixer.output(
+      {16000, AudioOutputFormat::SampleFormat::Int16});
+  QObject::connect(asrAudio, &AudioMixerOutput::audioReady, &aiAssistant,
+                   &AIAssistant::pushAsrAudio, Qt::DirectConnection);
 
   // 远程参会者音频 → AudioMixer（在 track 订阅/取消时动态连接）
   LiveKitManager *lkm = meetingController.liveKitManager();
@@ -204,14 +217,16 @@ int main(int argc, char *argv[])
                        if (lkm->remoteAudioPlayers().contains(participantIdentity)) {
                          auto player = lkm->remoteAudioPlayers()[participantIdentity];
                          if (player) {
+                           // DirectConnection：在播放线程中直接写入该参会者的
+                           // SPSC 环形缓冲区（播放线程即唯一生产者），不经过主线程
+                           auto input = audioMixer.remoteInput(participantIdentity);
                            QObject::connect(
                                player.get(), &RemoteAudioPlayer::audioDataReady,
                                &audioMixer,
-                               [&audioMixer, participantIdentity](
-                                   QByteArray data, int sampleRate, int channels) {
-                                 audioMixer.feedRemoteAudio(participantIdentity,
-                                                           data, sampleRate, channels);
-                               });
+                               [input](QByteArray data, int sampleRate, int channels) {
+                                 input->push(data, sampleRate, channels);
+                               },
+                               Qt::DirectConnection);
                            qDebug() << "[main] 远程音频已连接到 AudioMixer:"
                                     << participantIdentity;
                          }
@@ -233,6 +248,13 @@ int main(int argc, char *argv[])
                        vc->feedFrame("local", frame,
                                      meetingController.userName());
                      });
+    // 合成器单元格尺寸 → 采集端预缩放
+    QObject::connect(vc, &VideoCompositor::tileSizeChanged, mc,
+                     [mc](const QString &participantId, const QSize &size)
+                     {
+                       if (participantId == "local")
+                         mc->setCompositorFrameSize(size);
+                     });
   }
 
   // 屏幕共享帧 → VideoCompositor
@@ -270,6 +292,15 @@ int main(int argc, char *argv[])
                   [vc](const QString &pid, const QImage &frame) {
                     vc->feedFrame(pid, frame, pid);
                   });
+              // 合成器单元格尺寸 → 渲染线程预缩放
+              RemoteVideoRenderer *r = renderer.get();
+              r->setCompositorFrameSize(vc->tileSize(renderKey));
+              QObject::connect(
+                  vc, &VideoCompositor::tileSizeChanged, r,
+                  [r, renderKey](const QString &pid, const QSize &size) {
+                    if (pid == renderKey)
+                      r->setCompositorFrameSize(size);
+                  });
               qDebug() << "[main] 远程视频已连接到 VideoCompositor:"
                        << renderKey;
             }
@@ -284,9 +315,17 @@ int main(int argc, char *argv[])
                      vc->removeParticipant(participantIdentity + "::screen");
                    });
 
+  // 当前说话人 → VideoCompositor（驱动演讲者布局的主画面）
+  QObject::connect(&audioMixer, &AudioMixer::activeSpeakersChanged, vc,
+                   &VideoCompositor::setActiveSpeakers);
+
   // AudioMixer 混合音频 → MeetingRecorder（录制音轨）
-  QObject::connect(&audioMixer, &AudioMixer::mixedAudioReady, mr,
-                   &MeetingRecorder::feedAudioData);
+  // 登记 AAC 编码器原生的 48kHz float planar 输出，录制端不再做格式转换；
+  // feedPlanarAudio 自身加锁，直接在混音线程调用，不经 GUI 事件循环排队
+  AudioMixerOutput *recordAudio = audioMixer.output(
+      {48000, AudioOutputFormat::SampleFormat::FloatPlanar});
+  QObject::connect(recordAudio, &AudioMixerOutput::audioReady, mr,
+                   &MeetingRecorder::feedPlanarAudio, Qt::DirectConnection);
 
   // 离开会议时自动停止视频录制
   QObject::connect(lkm, &LiveKitManager::disconnected, &meetingController,
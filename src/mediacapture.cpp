@@ -31,6 +31,29 @@ void VideoFrameHandler::setEnabled(bool enabled)
   qDebug() << "[VideoFrameHandler] 已" << (enabled ? "启用" : "禁用");
 }
 
+void VideoFrameHandler::setCompositorFrameSize(const QSize &size)
+{
+  if (m_compositorFrameSize == size)
+    return;
+  m_compositorFrameSize = size;
+  qDebug() << "[VideoFrameHandler] 合成器帧尺寸:" << size;
+}
+
+void VideoFrameHandler::emitCompositorFrame(const QImage &bgra)
+{
+  // 在采集线程上用面积平均缩放到单元格尺寸，合成器拿到即可直接绘制
+  QImage image;
+  if (m_compositorFrameSize.isValid() &&
+      (bgra.width() > m_compositorFrameSize.width() ||
+       bgra.height() > m_compositorFrameSize.height()))
+    image = bgra.scaled(m_compositorFrameSize, Qt::KeepAspectRatio,
+                        Qt::SmoothTransformation);
+  else
+    image = bgra.copy(); // bgra 可能引用临时缓冲，需深拷贝
+  if (!image.isNull())
+    emit localVideoFrameReady(image);
+}
+
 void VideoFrameHandler::handleVideoFrame(const QVideoFrame &frame)
 {
   if (!m_enabled || !m_videoSource)
@@ -77,6 +100,7 @@ void VideoFrameHandler::handleVideoFrame(const QVideoFrame &frame)
 
   // 【优化】尝试直接从 QVideoFrame 获取 BGRA/ARGB 数据，避免多次拷贝
   bool directCopy = false;
+  bool compositorFed = false; // 已从转换结果给合成器供帧，无需再 toImage
   if (format == QVideoFrameFormat::Format_BGRA8888 ||
       format == QVideoFrameFormat::Format_ARGB8888 ||
       format == QVideoFrameFormat::Format_BGRX8888 ||
@@ -125,6 +149,17 @@ void VideoFrameHandler::handleVideoFrame(const QVideoFrame &frame)
         }
       }
       directCopy = true;
+
+      // BGRA / BGRX 与 ARGB32 内存布局一致，直接从 LiveKit 帧缩放给合成器
+      if (compositorFrameWanted() &&
+          (format == QVideoFrameFormat::Format_BGRA8888 ||
+           format == QVideoFrameFormat::Format_BGRX8888))
+      {
+        emitCompositorFrame(QImage(lkFrame.data(), width, height,
+                                   static_cast<int>(expectedBytesPerLine),
+                                   QImage::Format_ARGB32));
+        compositorFed = true;
+      }
     }
   }
   // 【优化】YUYV (YUY2) 直接转换为 BGRA，避免走 toImage() 慢速路径。
@@ -187,6 +222,14 @@ void VideoFrameHandler::handleVideoFrame(const QVideoFrame &frame)
           qWarning() << "[VideoFrameHandler] 捕获帧异常(YUYV):" << e.what();
       }
       directCopy = true;
+
+      // 复用刚转换好的 BGRA 帧给合成器，不再走 toImage
+      if (compositorFrameWanted())
+      {
+        emitCompositorFrame(QImage(lkFrame.data(), width, height, width * 4,
+                                   QImage::Format_ARGB32));
+        compositorFed = true;
+      }
     }
   }
 
@@ -225,17 +268,24 @@ void VideoFrameHandler::handleVideoFrame(const QVideoFrame &frame)
           qWarning() << "[VideoFrameHandler] 捕获帧异常:" << e.what();
         }
       }
+
+      if (compositorFrameWanted())
+      {
+        emitCompositorFrame(argbImage);
+        compositorFed = true;
+      }
     }
   }
 
   mappedFrame.unmap();
 
-  // 发出本地视频帧信号供 VideoCompositor 使用
+  // 发出本地视频帧信号供 VideoCompositor 使用（以上路径都没有供帧时）
+  if (!compositorFed && compositorFrameWanted())
   {
     QImage image = frame.toImage();
     if (!image.isNull())
     {
-      emit localVideoFrameReady(image);
+      emitCompositorFrame(image);
     }
   }
 
@@ -607,6 +657,11 @@ std::shared_ptr<livekit::LocalAudioTrack> MediaCapture::getAudioTrack()
 // 重建 LiveKit 轨道（离开房间后调用）
 // =============================================================================
 
+void MediaCapture::setCompositorFrameSize(const QSize &size)
+{
+  m_videoHandler->setCompositorFrameSize(size);
+}
+
 void MediaCapture::recreateVideoTrack()
 {
   if (m_lkVideoSource)
@@ -55,6 +55,13 @@ public:
   void setEnabled(bool enabled);
   bool isEnabled() const { return m_enabled; }
 
+  /**
+   * @brief 设置发给 VideoCompositor 的帧尺寸（与 handleVideoFrame 同线程）
+   * @param size 合成器单元格尺寸：有效时 localVideoFrameReady 输出等比缩放
+   *        到该尺寸以内的帧；QSize(0, 0) 表示暂停供帧；无效表示原始分辨率
+   */
+  void setCompositorFrameSize(const QSize &size);
+
 public slots:
   void handleVideoFrame(const QVideoFrame &frame);
 
@@ -64,8 +71,16 @@ signals:
   void localVideoFrameReady(const QImage &frame);
 
 private:
+  // 按合成器单元格尺寸缩放后发出 localVideoFrameReady（bgra 可以是临时视图）
+  void emitCompositorFrame(const QImage &bgra);
+  bool compositorFrameWanted() const
+  {
+    return !(m_compositorFrameSize.isValid() && m_compositorFrameSize.isEmpty());
+  }
+
   std::shared_ptr<livekit::VideoSource> m_videoSource;
   bool m_enabled = false;
+  QSize m_compositorFrameSize;
   int m_frameCount = 0;
   std::chrono::steady_clock::time_point m_lastFrameTime; // 【优化】帧率控制
 };
@@ -204,6 +219,9 @@ public:
     return m_lkAudioSource;
   }
 
+  // 设置本地画面在 VideoCompositor 中的单元格尺寸（转发给 VideoFrameHandler）
+  void setCompositorFrameSize(const QSize &size);
+
   // 重建 LiveKit Track（离开房间后需要重建，旧 Track 不能复用）
   void recreateVideoTrack();
   void recreateAudioTrack();
@@ -1,4 +1,5 @@
 #include "meetingcontroller.h"
+#include "encoderprofile.h"
 #include "livekitmanager.h"
 #include "meetingrecorder.h"
 #include "videocompositor.h"
@@ -16,6 +17,7 @@
 #include <QSettings>
 #include <QStandardPaths>
 #include <QTimer>
+#include <QtConcurrent/QtConcurrent>
 
 MeetingController::MeetingController(QObject *parent)
     : QObject(parent), m_isMicOn(false), m_isCameraOn(false),
@@ -32,9 +34,20 @@ MeetingController::MeetingController(QObject *parent)
           &MeetingController::updateMeetingDuration);
 
   // VideoCompositor → MeetingRecorder
+  // 合成器直接输出 YUV420P，录制器无需再做整帧颜色转换
+  m_videoCompositor->setOutputFormat(VideoCompositor::OutputFormat::Yuv420p);
+  // 合成耗时超出预算时自动降低帧率；合成器只在录制时运行，编码器尺寸在
+  // 开始录制时固定，因此不降分辨率，避免录制器再把小画面放大回去
+  m_videoCompositor->setAdaptiveQuality(true);
+  m_videoCompositor->setAdaptiveResolution(false);
+  connect(m_videoCompositor, &VideoCompositor::compositeYuvFrameReady,
+          m_meetingRecorder, &MeetingRecorder::feedYuvFrame);
   connect(m_videoCompositor, &VideoCompositor::compositeFrameReady,
           m_meetingRecorder, &MeetingRecorder::feedVideoFrame);
 
+  // 分片 MP4 输出：程序异常退出时录制文件仍可播放到最后一个分片
+  m_meetingRecorder->setFragmentedOutput(true);
+
   // MeetingRecorder 信号转发
   connect(m_meetingRecorder, &MeetingRecorder::recordingChanged, this,
           &MeetingController::videoRecordingChanged);
@@ -44,6 +57,13 @@ MeetingController::MeetingController(QObject *parent)
   // 设置 LiveKit 信号连接
   setupLiveKitConnections();
 
+  // 首次运行：等启动完成后在后台选出本机的录制编码配置；
+  // 会议中不校准（占满 CPU 影响音视频），离开会议后再补做
+  QTimer::singleShot(AUTO_CALIBRATION_DELAY_MS, this,
+                     &MeetingController::calibrateEncoderIfNeeded);
+  connect(this, &MeetingController::meetingLeft, this,
+          &MeetingController::calibrateEncoderIfNeeded);
+
   qDebug() << "[MeetingController] 初始化完成，LiveKit 管理器已创建";
 }
 
@@ -53,6 +73,9 @@ MeetingController::~MeetingController()
   {
     m_durationTimer->stop();
   }
+
+  // 校准任务引用了本对象的成员：请求取消并等待后台线程退出
+  cancelEncoderCalibration();
 }
 
 // Getter实现
@@ -439,6 +462,13 @@ void MeetingController::copyToClipboard(const QString &text)
 
 void MeetingController::switchView(const QString &viewType)
 {
+  // 录制画面的布局跟随界面视图。界面尚无翻页 / 固定参会者的控件，
+  // 画廊视图仍录制为全员网格，避免分页布局静默丢掉第一页之后的参会者
+  if (viewType == "speaker")
+    m_videoCompositor->setLayoutMode(VideoCompositor::LayoutMode::Speaker);
+  else if (viewType == "grid" || viewType == "gallery")
+    m_videoCompositor->setLayoutMode(VideoCompositor::LayoutMode::Grid);
+
   emit showMessage("切换到" + viewType + "视图");
 }
 
@@ -681,10 +711,30 @@ void MeetingController::startVideoRecording()
       QString("meeting_%1_%2.mp4").arg(m_meetingId, timestamp);
   QString outputPath = outputDir + "/" + fileName;
 
+  // 使用校准保存的编码配置（未校准时为默认 H.264 配置）
+  QSettings settings("MeetingApp", "Recording");
+  const QString savedProfile = settings.value("encoderProfile").toString();
+  if (!savedProfile.isEmpty())
+  {
+    bool ok = false;
+    const EncoderProfile profile = EncoderProfile::fromString(savedProfile, &ok);
+    if (ok)
+      m_meetingRecorder->setEncoderProfile(profile);
+    else
+      qWarning() << "[MeetingController] 忽略无效的编码配置:" << savedProfile;
+  }
+
+  // 校准会占满 CPU 并与录制争抢编码器资源：直接取消（取消检查按帧进行，很快返回），
+  // 未保存配置时下次启动会重新校准
+  cancelEncoderCalibration();
+
   // 先启动录制器（initFFmpeg 会阻塞主线程数百毫秒）
   // 再启动合成器，避免合成器定时器在 initFFmpeg 期间排队大量事件
   // 导致视频 PTS 级联偏移、音画不同步
-  if (!m_meetingRecorder->startRecording(outputPath))
+  // 编码器分辨率 / 帧率与合成器输出保持一致
+  if (!m_meetingRecorder->startRecording(
+          outputPath, m_videoCompositor->outputWidth(),
+          m_videoCompositor->outputHeight(), m_videoCompositor->outputFps()))
   {
     emit showMessage("视频录制启动失败");
     return;
@@ -720,3 +770,71 @@ void MeetingController::toggleVideoRecording()
     startVideoRecording();
   }
 }
+
+void MeetingController::calibrateRecordingEncoder()
+{
+  if (m_calibrationWatcher && m_calibrationWatcher->isRunning())
+    return;
+  if (m_meetingRecorder->isRecording())
+  {
+    // 校准会占满 CPU，录制中测到的结果也不准确
+    emit showMessage("请先停止录制再进行编码器测试");
+    return;
+  }
+
+  if (!m_calibrationWatcher)
+  {
+    // 结果经 QFutureWatcher 回到主线程；watcher 归本对象所有，
+    // 析构时会先等待后台任务结束
+    m_calibrationWatcher = new QFutureWatcher<EncoderProfile>(this);
+    connect(m_calibrationWatcher, &QFutureWatcher<EncoderProfile>::finished,
+            this, [this]()
+            {
+      // 被取消的校准只测了部分候选，结果不可靠，不保存
+      if (m_cancelCalibration.load())
+      {
+        qDebug() << "[MeetingController] 录制编码器校准已取消";
+        return;
+      }
+      const EncoderProfile profile = m_calibrationWatcher->result();
+      QSettings settings("MeetingApp", "Recording");
+      settings.setValue("encoderProfile", profile.toString());
+      m_meetingRecorder->setEncoderProfile(profile);
+      qDebug() << "[MeetingController] 录制编码配置:" << profile.toString();
+      emit showMessage("录制编码配置: " + profile.toString()); });
+  }
+
+  emit showMessage("正在测试录制编码性能...");
+
+  // 按合成器当前输出规格测试；每个候选编码约 3 秒，放到后台线程避免阻塞 UI
+  const int width = m_videoCompositor->outputWidth();
+  const int height = m_videoCompositor->outputHeight();
+  const int fps = m_videoCompositor->outputFps();
+  m_cancelCalibration.store(false);
+  const std::atomic<bool> *cancelled = &m_cancelCalibration;
+  m_calibrationWatcher->setFuture(
+      QtConcurrent::run([width, height, fps, cancelled]()
+                        {
+        EncoderCalibrator calibrator(width, height, fps);
+        calibrator.setCancelFlag(cancelled);
+        return calibrator.calibrate(); }));
+}
+
+void MeetingController::calibrateEncoderIfNeeded()
+{
+  QSettings settings("MeetingApp", "Recording");
+  if (settings.contains("encoderProfile"))
+    return;
+  if (m_isInMeeting || m_meetingRecorder->isRecording())
+    return;
+  qDebug() << "[MeetingController] 尚未校准录制编码器，开始后台校准";
+  calibrateRecordingEncoder();
+}
+
+void MeetingController::cancelEncoderCalibration()
+{
+  if (!m_calibrationWatcher || !m_calibrationWatcher->isRunning())
+    return;
+  m_cancelCalibration.store(true);
+  m_calibrationWatcher->waitForFinished();
+}
@@ -1,15 +1,18 @@
 #ifndef MEETINGCONTROLLER_H
 #define MEETINGCONTROLLER_H
 
+#include <QFutureWatcher>
 #include <QObject>
 #include <QString>
 #include <QVariantList>
+#include <atomic>
 
 // 前向声明
 // 指针使得你可以优雅地使用前置声明代替 #include，从此远离“循环包含报错”的噩梦。
 class LiveKitManager;
 class VideoCompositor;
 class MeetingRecorder;
+struct EncoderProfile;
 
 class MeetingController : public QObject {
   Q_OBJECT
@@ -123,6 +126,8 @@ public slots:
   Q_INVOKABLE void startVideoRecording();
   Q_INVOKABLE void stopVideoRecording();
   Q_INVOKABLE void toggleVideoRecording();
+  // 在后台线程试编码各候选配置，选出本机能实时录制且 CPU 占用最低的编码配置
+  Q_INVOKABLE void calibrateRecordingEncoder();
 
   // 保存密码功能
   Q_INVOKABLE void saveCredentials(const QString &username,
@@ -176,6 +181,12 @@ private:
   void startDurationTimer();
   void stopDurationTimer();
   void setupLiveKitConnections(); // 新增：设置 LiveKit 信号连接
+  // 尚未保存编码配置时在后台校准一次（启动后延迟触发）
+  void calibrateEncoderIfNeeded();
+  // 取消进行中的校准并等待后台线程退出（结果不保存）
+  void cancelEncoderCalibration();
+
+  static constexpr int AUTO_CALIBRATION_DELAY_MS = 5000;
 
 private:
   bool m_isMicOn;
@@ -197,6 +208,9 @@ private:
   // 视频录制
   VideoCompositor *m_videoCompositor;
   MeetingRecorder *m_meetingRecorder;
+  // 录制编码器校准（后台线程）：析构时置取消标志并等待结束
+  QFutureWatcher<EncoderProfile> *m_calibrationWatcher = nullptr;
+  std::atomic<bool> m_cancelCalibration{false};
 
   // 用户密码（用于认证）
   QString m_userPassword;
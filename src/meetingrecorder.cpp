@@ -6,9 +6,17 @@
 #include "meetingrecorder.h"
 #include <QDebug>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
 #include <QTimer>
 #include <cstring>
 
+extern "C"
+{
+#include <libavutil/pixdesc.h>
+}
+
 MeetingRecorder::MeetingRecorder(QObject *parent) : QObject(parent)
 {
     qDebug() << "[MeetingRecorder] 初始化完成";
@@ -23,6 +31,15 @@ MeetingRecorder::~MeetingRecorder()
     qDebug() << "[MeetingRecorder] 销毁";
 }
 
+namespace
+{
+// QImage 包装为 AVBuffer 时的释放回调：最后一个引用释放时删除持有的 QImage
+void releaseImageBuffer(void *opaque, uint8_t *)
+{
+    delete static_cast<QImage *>(opaque);
+}
+} // namespace
+
 bool MeetingRecorder::startRecording(const QString &outputPath, int width,
                                      int height, int fps,
                                      int audioSampleRate)
@@ -56,36 +73,38 @@ bool MeetingRecorder::startRecording(const QString &outputPath, int width,
     m_audioTimeInitialized = false;
     m_wallClock.start();
 
-    // 清空队列
+    // 清空队列与统计
+    m_videoQueue.reset();
+    m_encodeQueue.reset();
+    m_videoFramesDropped.store(0);
+    for (int stage = 0; stage < STAGE_COUNT; ++stage)
     {
-        QMutexLocker locker(&m_videoMutex);
-        m_videoQueue.clear();
+        m_stageWait[stage].reset();
+        m_stageProcess[stage].reset();
     }
     {
         QMutexLocker locker(&m_audioMutex);
         m_audioBuffer.clear();
         m_audioEncodeBuf.clear();
+        m_audioPendingSinceUs = -1;
+        m_audioMaxDepth = 0;
     }
-    // 清空 packet 队列
-    {
-        QMutexLocker locker(&m_packetMutex);
-        while (!m_videoPackets.isEmpty()) {
-            AVPacket *pkt = m_videoPackets.dequeue();
-            av_packet_free(&pkt);
-        }
-        while (!m_audioPackets.isEmpty()) {
-            AVPacket *pkt = m_audioPackets.dequeue();
-            av_packet_free(&pkt);
-        }
-    }
+    m_interleaver.reset();
+    m_interleaver.setMaxLookaheadUs(PACKET_LOOKAHEAD_US);
+    m_muxWakeup.tryAcquire(m_muxWakeup.available());
 
     m_recording.store(true);
     emit recordingChanged();
 
-    // 在独立线程中运行编码循环
-    m_encodingThread = QThread::create([this]()
-                                       { encodingLoop(); });
-    m_encodingThread->start();
+    // 每个阶段一个线程（下游先启动）
+    m_muxThread = QThread::create([this]() { muxLoop(); });
+    m_audioEncodeThread = QThread::create([this]() { audioEncodeLoop(); });
+    m_videoEncodeThread = QThread::create([this]() { videoEncodeLoop(); });
+    m_convertThread = QThread::create([this]() { convertLoop(); });
+    m_muxThread->start();
+    m_audioEncodeThread->start();
+    m_videoEncodeThread->start();
+    m_convertThread->start();
 
     qDebug() << "[MeetingRecorder] 开始录制:" << outputPath
              << width << "x" << height << "@" << fps << "fps";
@@ -100,21 +119,31 @@ void MeetingRecorder::stopRecording()
     qDebug() << "[MeetingRecorder] 停止录制...";
     m_recording.store(false);
 
-    // 唤醒编码线程
-    m_encodeCondition.wakeAll();
+    // 关闭输入：convert 处理完剩余帧后关闭 m_encodeQueue，视频编码随之 flush；
+    // 音频编码处理完剩余采样后 flush；两路都 flush 后 mux 写完剩余 packet 退出
+    m_videoQueue.close();
+    {
+        QMutexLocker locker(&m_audioMutex);
+        m_audioCondition.wakeAll();
+    }
 
-    // 等待编码线程结束（flush 已在 encodingLoop 末尾完成）
-    if (m_encodingThread)
+    // 按流水线顺序等待各阶段结束
+    for (QThread **thread : {&m_convertThread, &m_videoEncodeThread,
+                             &m_audioEncodeThread, &m_muxThread})
     {
-        m_encodingThread->wait(10000); // 最多等 10 秒
-        delete m_encodingThread;
-        m_encodingThread = nullptr;
+        if (*thread)
+        {
+            (*thread)->wait(10000); // 每个阶段最多等 10 秒
+            delete *thread;
+            *thread = nullptr;
+        }
     }
 
+    logPipelineStats();
     cleanupFFmpeg();
 
     emit recordingChanged();
-    emit recordingStopped(m_outputPath);
+    emit recordingStopped(segmentingEnabled() ? m_playlistPath : m_outputPath);
 
     qDebug() << "[MeetingRecorder] 录制已停止, 文件:" << m_outputPath
              << "时长:" << m_durationSeconds.load() << "秒";
@@ -129,13 +158,23 @@ void MeetingRecorder::feedVideoFrame(const QImage &frame, qint64 timestampUs)
     // 使用统一挂钟时间戳，确保与音频共享同一时间原点
     qint64 wallTimeUs = m_wallClock.nsecsElapsed() / 1000;
 
-    QMutexLocker locker(&m_videoMutex);
-    // 限制队列长度，防止编码跟不上时堆积
-    if (m_videoQueue.size() < 60)
-    {
-        m_videoQueue.enqueue({frame, wallTimeUs});
-    }
-    m_encodeCondition.wakeOne();
+    // 队列满说明转换 / 编码跟不上，丢弃新帧而不是阻塞合成线程
+    if (!m_videoQueue.tryPush({frame, AVFrameRef(), wallTimeUs}))
+        m_videoFramesDropped.fetch_add(1);
+}
+
+void MeetingRecorder::feedYuvFrame(const AVFrameRef &frame, qint64 timestampUs)
+{
+    Q_UNUSED(timestampUs)
+    if (!m_recording.load() || !frame)
+        return;
+
+    // 使用统一挂钟时间戳，确保与音频共享同一时间原点
+    qint64 wallTimeUs = m_wallClock.nsecsElapsed() / 1000;
+
+    // 队列满说明转换 / 编码跟不上，丢弃新帧而不是阻塞合成线程
+    if (!m_videoQueue.tryPush({QImage(), frame, wallTimeUs}))
+        m_videoFramesDropped.fetch_add(1);
 }
 
 void MeetingRecorder::feedAudioData(const QByteArray &pcmData, int sampleRate,
@@ -146,117 +185,286 @@ void MeetingRecorder::feedAudioData(const QByteArray &pcmData, int sampleRate,
     if (!m_recording.load() || pcmData.isEmpty())
         return;
 
+    const auto *src = reinterpret_cast<const int16_t *>(pcmData.constData());
+    const int sampleCount =
+        static_cast<int>(pcmData.size()) / static_cast<int>(sizeof(int16_t));
+
     QMutexLocker locker(&m_audioMutex);
+    initAudioTimeLocked();
 
-    // 首次音频到达：用挂钟时间初始化音频 PTS 起点，与视频对齐
-    if (!m_audioTimeInitialized)
+    // int16 → float（AAC 编码器使用 float planar，单声道即连续数组）
+    const int offset = static_cast<int>(m_audioBuffer.size());
+    m_audioBuffer.resize(offset + sampleCount * static_cast<int>(sizeof(float)));
+    float *dst = reinterpret_cast<float *>(m_audioBuffer.data() + offset);
+    constexpr float scale = 1.0f / 32768.0f;
+    for (int i = 0; i < sampleCount; ++i)
+        dst[i] = static_cast<float>(src[i]) * scale;
+
+    audioAppendedLocked();
+}
+
+void MeetingRecorder::feedPlanarAudio(const QByteArray &fltpData,
+                                      int sampleRate, int channels)
+{
+    Q_UNUSED(sampleRate)
+    if (!m_recording.load() || fltpData.isEmpty())
+        return;
+    if (channels != 1)
+    {
+        qWarning() << "[MeetingRecorder] feedPlanarAudio 仅支持单声道, channels="
+                   << channels;
+        return;
+    }
+
+    QMutexLocker locker(&m_audioMutex);
+    initAudioTimeLocked();
+    m_audioBuffer.append(fltpData);
+    audioAppendedLocked();
+}
+
+void MeetingRecorder::setFragmentedOutput(bool enabled)
+{
+    if (m_recording.load())
+    {
+        qWarning() << "[MeetingRecorder] 录制中不能切换输出模式";
+        return;
+    }
+    m_fragmented = enabled;
+}
+
+void MeetingRecorder::setFragmentDurationMs(int ms)
+{
+    if (m_recording.load())
+    {
+        qWarning() << "[MeetingRecorder] 录制中不能修改分片时长";
+        return;
+    }
+    m_fragmentDurationMs = qMax(MIN_FRAGMENT_DURATION_MS, ms);
+}
+
+void MeetingRecorder::setEncoderProfile(const EncoderProfile &profile)
+{
+    if (m_recording.load())
     {
-        qint64 wallTimeUs = m_wallClock.nsecsElapsed() / 1000;
-        m_audioSampleCount =
-            wallTimeUs * m_audioSampleRate / 1000000;
-        m_audioTimeInitialized = true;
-        qDebug() << "[MeetingRecorder] 首次音频到达, wallTime="
-                 << wallTimeUs << "us, 初始 audioPts=" << m_audioSampleCount;
+        qWarning() << "[MeetingRecorder] 录制中不能修改编码配置";
+        return;
     }
+    m_encoderProfile = profile;
+}
 
-    m_audioBuffer.append(pcmData);
-    m_encodeCondition.wakeOne();
+void MeetingRecorder::initAudioTimeLocked()
+{
+    // 首次音频到达：用挂钟时间初始化音频 PTS 起点，与视频对齐
+    if (m_audioTimeInitialized)
+        return;
+
+    qint64 wallTimeUs = m_wallClock.nsecsElapsed() / 1000;
+    m_audioSampleCount =
+        wallTimeUs * m_audioSampleRate / 1000000;
+    m_audioTimeInitialized = true;
+    qDebug() << "[MeetingRecorder] 首次音频到达, wallTime="
+             << wallTimeUs << "us, 初始 audioPts=" << m_audioSampleCount;
+}
+
+void MeetingRecorder::audioAppendedLocked()
+{
+    if (m_audioPendingSinceUs < 0)
+        m_audioPendingSinceUs = m_wallClock.nsecsElapsed() / 1000;
+    if (m_audioFrameSize > 0)
+    {
+        const int depth = static_cast<int>(m_audioBuffer.size()) /
+                          static_cast<int>(sizeof(float)) / m_audioFrameSize;
+        m_audioMaxDepth = qMax(m_audioMaxDepth, depth);
+    }
+    m_audioCondition.wakeOne();
 }
 
 // ==============================================================================
-// 编码线程主循环
+// 流水线各阶段
 // ==============================================================================
 
-void MeetingRecorder::encodingLoop()
+void MeetingRecorder::convertLoop()
 {
-    qDebug() << "[MeetingRecorder] 编码线程启动";
+    qDebug() << "[MeetingRecorder] convert 线程启动";
 
-    while (m_recording.load())
+    VideoQueueItem item;
+    qint64 waitUs = 0;
+    while (m_videoQueue.pop(item, &waitUs))
     {
-        // 处理视频帧
+        m_stageWait[StageConvert].record(waitUs);
+        QElapsedTimer timer;
+        timer.start();
+        AVFrameRef yuv = convertQueuedVideo(item);
+        m_stageProcess[StageConvert].record(timer.nsecsElapsed() / 1000);
+
+        const qint64 timestampUs = item.timestampUs;
+        item = VideoQueueItem(); // 尽早释放源帧（合成器可回收其缓冲）
+        if (yuv)
         {
-            QMutexLocker locker(&m_videoMutex);
-            while (!m_videoQueue.isEmpty())
-            {
-                auto [frame, ts] = m_videoQueue.dequeue();
-                locker.unlock();
-                encodeVideoFrame(frame, ts);
-                locker.relock();
-            }
+            // 编码跟不上时在此阻塞，上游输入队列随之填满并开始丢帧
+            m_encodeQueue.push({QImage(), std::move(yuv), timestampUs});
         }
+    }
 
-        // 处理音频数据
-        {
-            QMutexLocker locker(&m_audioMutex);
-            if (!m_audioBuffer.isEmpty())
-            {
-                QByteArray data = m_audioBuffer;
-                m_audioBuffer.clear();
-                locker.unlock();
-
-                const auto *samples =
-                    reinterpret_cast<const int16_t *>(data.constData());
-                int sampleCount =
-                    static_cast<int>(data.size()) / static_cast<int>(sizeof(int16_t));
-                encodeAudioSamples(samples, sampleCount);
-            }
-        }
+    m_encodeQueue.close();
+    qDebug() << "[MeetingRecorder] convert 线程结束, 丢弃视频帧:"
+             << m_videoFramesDropped.load();
+}
+
+void MeetingRecorder::videoEncodeLoop()
+{
+    qDebug() << "[MeetingRecorder] 视频编码线程启动";
+
+    VideoQueueItem item;
+    qint64 waitUs = 0;
+    while (m_encodeQueue.pop(item, &waitUs))
+    {
+        m_stageWait[StageVideoEncode].record(waitUs);
+        QElapsedTimer timer;
+        timer.start();
+        sendVideoFrame(item.yuv.get(), item.timestampUs);
+        m_stageProcess[StageVideoEncode].record(timer.nsecsElapsed() / 1000);
+        item.yuv.reset(); // 归还转换帧池 / 合成器缓冲
+    }
+
+    // Flush 视频编码器 —— 将剩余包存入队列
+    if (m_videoCodecCtx)
+    {
+        avcodec_send_frame(m_videoCodecCtx, nullptr);
+        drainEncoder(m_videoCodecCtx, LaneVideo);
+    }
+    finishLane(LaneVideo);
+
+    qDebug() << "[MeetingRecorder] 视频编码线程结束, 视频帧:"
+             << m_videoFrameCount;
+}
+
+void MeetingRecorder::audioEncodeLoop()
+{
+    qDebug() << "[MeetingRecorder] 音频编码线程启动";
+
+    QMutexLocker locker(&m_audioMutex);
+    while (true)
+    {
+        while (m_recording.load() && m_audioBuffer.isEmpty())
+            m_audioCondition.wait(&m_audioMutex);
+        if (m_audioBuffer.isEmpty())
+            break; // 已停止且没有剩余数据
+
+        QByteArray data;
+        data.swap(m_audioBuffer);
+        const qint64 waitUs =
+            m_wallClock.nsecsElapsed() / 1000 - m_audioPendingSinceUs;
+        m_audioPendingSinceUs = -1;
+        locker.unlock();
+
+        m_stageWait[StageAudioEncode].record(waitUs);
+        QElapsedTimer timer;
+        timer.start();
+        const auto *samples = reinterpret_cast<const float *>(data.constData());
+        int sampleCount =
+            static_cast<int>(data.size()) / static_cast<int>(sizeof(float));
+        encodeAudioSamples(samples, sampleCount);
+        m_stageProcess[StageAudioEncode].record(timer.nsecsElapsed() / 1000);
+
+        locker.relock();
+    }
+    locker.unlock();
+
+    // Flush 音频编码器 —— 将剩余包存入队列
+    if (m_audioCodecCtx)
+    {
+        avcodec_send_frame(m_audioCodecCtx, nullptr);
+        drainEncoder(m_audioCodecCtx, LaneAudio);
+    }
+    finishLane(LaneAudio);
+
+    qDebug() << "[MeetingRecorder] 音频编码线程结束, 音频样本:"
+             << m_audioSampleCount;
+}
+
+void MeetingRecorder::muxLoop()
+{
+    qDebug() << "[MeetingRecorder] mux 线程启动";
+
+    QElapsedTimer statsTimer;
+    statsTimer.start();
+
+    // 两路编码器都 flush 且交织器取空后退出（结束的通道不再阻塞另一路）
+    while (!m_interleaver.isDrained())
+    {
+        // 等待新 packet，超时唤醒用于更新录制时长；多次唤醒合并处理
+        m_muxWakeup.tryAcquire(1, 200);
+        m_muxWakeup.tryAcquire(m_muxWakeup.available());
 
-        // 交织写入：每轮编码后，按 DTS 归并两个队列的 packet 写入文件
         writeInterleavedPackets();
 
         // 更新时长（基于挂钟）
+        int seconds = static_cast<int>(m_wallClock.elapsed() / 1000);
+        if (seconds != m_durationSeconds.load())
         {
-            int seconds = static_cast<int>(m_wallClock.elapsed() / 1000);
-            if (seconds != m_durationSeconds.load())
-            {
-                m_durationSeconds.store(seconds);
-                QMetaObject::invokeMethod(this, [this]()
-                                          { emit durationChanged(); }, Qt::QueuedConnection);
-            }
+            m_durationSeconds.store(seconds);
+            QMetaObject::invokeMethod(this, [this]()
+                                      { emit durationChanged(); }, Qt::QueuedConnection);
         }
 
-        // 等待新数据
-        QMutexLocker condLocker(&m_conditionMutex);
-        if (m_recording.load())
+        if (statsTimer.elapsed() >= STATS_LOG_INTERVAL_MS)
         {
-            m_encodeCondition.wait(&m_conditionMutex, 30); // 最多等 30ms
+            logPipelineStats();
+            statsTimer.restart();
         }
     }
 
-    // 处理剩余原始数据
+    qDebug() << "[MeetingRecorder] mux 线程结束";
+}
+
+QList<MeetingRecorder::PipelineStageStats> MeetingRecorder::pipelineStats() const
+{
+    QList<PipelineStageStats> stats;
+    auto addStage = [&](Stage stage, const QString &name, int depth,
+                        int maxDepth)
     {
-        QMutexLocker locker(&m_videoMutex);
-        while (!m_videoQueue.isEmpty())
-        {
-            auto [frame, ts] = m_videoQueue.dequeue();
-            locker.unlock();
-            encodeVideoFrame(frame, ts);
-            locker.relock();
-        }
-    }
+        PipelineStageStats s;
+        s.name = name;
+        s.queueDepth = depth;
+        s.maxQueueDepth = maxDepth;
+        s.wait = m_stageWait[stage].snapshot();
+        s.process = m_stageProcess[stage].snapshot();
+        stats.append(s);
+    };
+
+    addStage(StageConvert, QStringLiteral("convert"), m_videoQueue.size(),
+             m_videoQueue.maxDepth());
+    addStage(StageVideoEncode, QStringLiteral("video_encode"),
+             m_encodeQueue.size(), m_encodeQueue.maxDepth());
     {
         QMutexLocker locker(&m_audioMutex);
-        if (!m_audioBuffer.isEmpty())
-        {
-            QByteArray data = m_audioBuffer;
-            m_audioBuffer.clear();
-            locker.unlock();
-
-            const auto *samples =
-                reinterpret_cast<const int16_t *>(data.constData());
-            int sampleCount =
-                static_cast<int>(data.size()) / static_cast<int>(sizeof(int16_t));
-            encodeAudioSamples(samples, sampleCount);
-        }
+        const int depth =
+            m_audioFrameSize > 0
+                ? static_cast<int>(m_audioBuffer.size()) /
+                      static_cast<int>(sizeof(float)) / m_audioFrameSize
+                : 0;
+        addStage(StageAudioEncode, QStringLiteral("audio_encode"), depth,
+                 m_audioMaxDepth);
     }
+    addStage(StageMux, QStringLiteral("mux"), m_interleaver.size(),
+             m_interleaver.maxDepth());
+    return stats;
+}
 
-    // flush 编码器并将剩余 packets 排序写入
-    flushEncoders();
-    flushPacketQueues();
-
-    qDebug() << "[MeetingRecorder] 编码线程结束, 视频帧:" << m_videoFrameCount
-             << "音频样本:" << m_audioSampleCount;
+void MeetingRecorder::logPipelineStats() const
+{
+    for (const PipelineStageStats &s : pipelineStats())
+    {
+        qDebug() << "[MeetingRecorder] 阶段" << s.name << "队列:" << s.queueDepth
+                 << "峰值:" << s.maxQueueDepth
+                 << "排队 p50/p95/max(us):" << s.wait.percentileUs(0.5)
+                 << s.wait.percentileUs(0.95) << s.wait.maxUs
+                 << "处理 p50/p95/max(us):" << s.process.percentileUs(0.5)
+                 << s.process.percentileUs(0.95) << s.process.maxUs;
+    }
+    qDebug() << "[MeetingRecorder] 输入队列满丢弃视频帧:"
+             << m_videoFramesDropped.load();
 }
 
 // ==============================================================================
@@ -268,89 +476,54 @@ bool MeetingRecorder::initFFmpeg(const QString &outputPath, int width,
 {
     int ret;
 
-    // 创建输出格式上下文
-    ret = avformat_alloc_output_context2(&m_formatCtx, nullptr, nullptr,
-                                         outputPath.toUtf8().constData());
-    if (ret < 0 || !m_formatCtx)
+    // 按文件名确定输出容器（分段时每段重新创建输出上下文，编码器只创建一次）
+    m_outputFormat =
+        av_guess_format(nullptr, outputPath.toUtf8().constData(), nullptr);
+    if (!m_outputFormat)
     {
-        qWarning() << "[MeetingRecorder] avformat_alloc_output_context2 失败";
+        qWarning() << "[MeetingRecorder] 无法识别输出格式:" << outputPath;
         return false;
     }
+    const bool globalHeader = m_outputFormat->flags & AVFMT_GLOBALHEADER;
 
     // ==================== 视频流 ====================
-    const AVCodec *videoCodec = avcodec_find_encoder(AV_CODEC_ID_H264);
-    if (!videoCodec)
-    {
-        qWarning() << "[MeetingRecorder] 未找到 H.264 编码器";
-        cleanupFFmpeg();
-        return false;
-    }
-
-    m_videoStream = avformat_new_stream(m_formatCtx, nullptr);
-    if (!m_videoStream)
-    {
-        cleanupFFmpeg();
-        return false;
-    }
-
-    m_videoCodecCtx = avcodec_alloc_context3(videoCodec);
-    m_videoCodecCtx->codec_id = AV_CODEC_ID_H264;
-    m_videoCodecCtx->codec_type = AVMEDIA_TYPE_VIDEO;
-    m_videoCodecCtx->width = width;
-    m_videoCodecCtx->height = height;
-    m_videoCodecCtx->time_base = {1, VIDEO_TIME_BASE};
-    m_videoCodecCtx->framerate = {fps, 1};
-    m_videoCodecCtx->pix_fmt = AV_PIX_FMT_YUV420P;
-    m_videoCodecCtx->gop_size = fps * 2; // 每 2 秒一个关键帧
-    m_videoCodecCtx->max_b_frames = 0;   // 简化: 不使用 B 帧
-
-    // libx264 preset
-    av_opt_set(m_videoCodecCtx->priv_data, "preset", "fast", 0);
-    av_opt_set(m_videoCodecCtx->priv_data, "tune", "zerolatency", 0);
-
-    // CRF 模式，质量 23（默认）
-    m_videoCodecCtx->bit_rate = 0;
-    av_opt_set(m_videoCodecCtx->priv_data, "crf", "23", 0);
-
-    if (m_formatCtx->oformat->flags & AVFMT_GLOBALHEADER)
+    EncoderProfile profile = m_encoderProfile;
+    if (!profile.isAvailable())
     {
-        m_videoCodecCtx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        qWarning() << "[MeetingRecorder] 编码器不可用, 回退到默认配置:"
+                   << profile.toString();
+        profile = EncoderProfile();
     }
 
-    ret = avcodec_open2(m_videoCodecCtx, videoCodec, nullptr);
-    if (ret < 0)
+    // 每 2 秒一个关键帧；分片输出时 GOP 与分片时长一致，每个分片以关键帧开始
+    const int gopSize =
+        m_fragmented ? qMax(1, fps * m_fragmentDurationMs / 1000) : fps * 2;
+    m_videoCodecCtx = openVideoEncoder(profile, width, height, fps,
+                                       {1, VIDEO_TIME_BASE}, gopSize,
+                                       globalHeader);
+    if (!m_videoCodecCtx)
     {
-        qWarning() << "[MeetingRecorder] 视频编码器打开失败:" << ret;
+        qWarning() << "[MeetingRecorder] 视频编码器打开失败:"
+                   << profile.toString();
         cleanupFFmpeg();
         return false;
     }
+    qDebug() << "[MeetingRecorder] 视频编码配置:" << profile.toString();
 
-    ret = avcodec_parameters_from_context(m_videoStream->codecpar,
-                                          m_videoCodecCtx);
+    // 快照编码参数：每个输出文件的视频流都从这里复制
+    m_videoParams = avcodec_parameters_alloc();
+    ret = m_videoParams ? avcodec_parameters_from_context(m_videoParams,
+                                                          m_videoCodecCtx)
+                        : AVERROR(ENOMEM);
     if (ret < 0)
     {
         cleanupFFmpeg();
         return false;
     }
-    m_videoStream->time_base = m_videoCodecCtx->time_base;
 
-    // 分配视频帧（YUV420P）
-    m_videoFrame = av_frame_alloc();
-    m_videoFrame->format = AV_PIX_FMT_YUV420P;
-    m_videoFrame->width = width;
-    m_videoFrame->height = height;
-    av_frame_get_buffer(m_videoFrame, 0);
-
-    // 创建 SWS 上下文（BGRA → YUV420P）
-    m_swsCtx = sws_getContext(width, height, AV_PIX_FMT_BGRA, width, height,
-                              AV_PIX_FMT_YUV420P, SWS_FAST_BILINEAR, nullptr,
-                              nullptr, nullptr);
-    if (!m_swsCtx)
-    {
-        qWarning() << "[MeetingRecorder] sws_getContext 失败";
-        cleanupFFmpeg();
-        return false;
-    }
+    // 送编码器使用的空壳帧（只做 av_frame_ref，不分配像素）；
+    // BGRA → YUV420P 转换上下文由 convert 线程按源格式按需创建
+    m_sendFrame = av_frame_alloc();
 
     // ==================== 音频流 ====================
     const AVCodec *audioCodec = avcodec_find_encoder(AV_CODEC_ID_AAC);
@@ -361,13 +534,6 @@ bool MeetingRecorder::initFFmpeg(const QString &outputPath, int width,
         return false;
     }
 
-    m_audioStream = avformat_new_stream(m_formatCtx, nullptr);
-    if (!m_audioStream)
-    {
-        cleanupFFmpeg();
-        return false;
-    }
-
     m_audioCodecCtx = avcodec_alloc_context3(audioCodec);
     m_audioCodecCtx->codec_id = AV_CODEC_ID_AAC;
     m_audioCodecCtx->codec_type = AVMEDIA_TYPE_AUDIO;
@@ -377,7 +543,7 @@ bool MeetingRecorder::initFFmpeg(const QString &outputPath, int width,
     m_audioCodecCtx->bit_rate = 128000;
     m_audioCodecCtx->time_base = {1, audioSampleRate};
 
-    if (m_formatCtx->oformat->flags & AVFMT_GLOBALHEADER)
+    if (globalHeader)
     {
         m_audioCodecCtx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
     }
@@ -390,14 +556,15 @@ bool MeetingRecorder::initFFmpeg(const QString &outputPath, int width,
         return false;
     }
 
-    ret = avcodec_parameters_from_context(m_audioStream->codecpar,
-                                          m_audioCodecCtx);
+    m_audioParams = avcodec_parameters_alloc();
+    ret = m_audioParams ? avcodec_parameters_from_context(m_audioParams,
+                                                          m_audioCodecCtx)
+                        : AVERROR(ENOMEM);
     if (ret < 0)
     {
         cleanupFFmpeg();
         return false;
     }
-    m_audioStream->time_base = m_audioCodecCtx->time_base;
 
     m_audioFrameSize = m_audioCodecCtx->frame_size;
     if (m_audioFrameSize <= 0)
@@ -411,66 +578,49 @@ bool MeetingRecorder::initFFmpeg(const QString &outputPath, int width,
     m_audioFrame->nb_samples = m_audioFrameSize;
     av_frame_get_buffer(m_audioFrame, 0);
 
-    // 创建 SWR 上下文（int16 → float planar）
-    ret = swr_alloc_set_opts2(
-        &m_swrCtx,
-        &m_audioCodecCtx->ch_layout, AV_SAMPLE_FMT_FLTP, audioSampleRate,
-        &m_audioCodecCtx->ch_layout, AV_SAMPLE_FMT_S16, audioSampleRate,
-        0, nullptr);
-    if (ret < 0 || !m_swrCtx)
-    {
-        qWarning() << "[MeetingRecorder] swr_alloc_set_opts2 失败";
-        cleanupFFmpeg();
-        return false;
-    }
-    swr_init(m_swrCtx);
-
     // ==================== 打开输出文件 ====================
-    if (!(m_formatCtx->oformat->flags & AVFMT_NOFILE))
+    m_segments.clear();
+    m_segmentIndex = 0;
+    m_segmentTsOffsetUs = 0; // 第一段沿用录制挂钟时间戳，与不分段时一致
+    m_segmentFirstUs = -1;
+    m_segmentLastUs = -1;
+    m_playlistPath.clear();
+    if (segmentingEnabled())
     {
-        ret = avio_open(&m_formatCtx->pb, outputPath.toUtf8().constData(),
-                        AVIO_FLAG_WRITE);
-        if (ret < 0)
-        {
-            qWarning() << "[MeetingRecorder] avio_open 失败:" << outputPath;
-            cleanupFFmpeg();
-            return false;
-        }
+        const QFileInfo info(outputPath);
+        m_playlistPath =
+            info.absolutePath() + "/" + info.completeBaseName() + ".m3u";
+        qDebug() << "[MeetingRecorder] 分段录制: 每" << m_segmentDurationSec
+                 << "秒 /" << m_segmentMaxBytes << "字节, 播放列表:"
+                 << m_playlistPath;
     }
-
-    // 写文件头
-    ret = avformat_write_header(m_formatCtx, nullptr);
-    if (ret < 0)
+    if (!openOutput(segmentingEnabled() ? segmentPath(0) : outputPath))
     {
-        qWarning() << "[MeetingRecorder] avformat_write_header 失败:" << ret;
         cleanupFFmpeg();
         return false;
     }
 
     qDebug() << "[MeetingRecorder] FFmpeg 初始化成功:"
              << width << "x" << height << "@" << fps
-             << "audio:" << audioSampleRate << "Hz";
+             << "audio:" << audioSampleRate << "Hz"
+             << (m_fragmented ? QStringLiteral("fMP4 分片 %1ms")
+                                    .arg(m_fragmentDurationMs)
+                              : QStringLiteral("MP4"));
     return true;
 }
 
 void MeetingRecorder::cleanupFFmpeg()
 {
-    // 释放队列中残留的 AVPacket（防止内存泄漏）
-    {
-        QMutexLocker locker(&m_packetMutex);
-        while (!m_videoPackets.isEmpty()) {
-            AVPacket *pkt = m_videoPackets.dequeue();
-            av_packet_free(&pkt);
-        }
-        while (!m_audioPackets.isEmpty()) {
-            AVPacket *pkt = m_audioPackets.dequeue();
-            av_packet_free(&pkt);
-        }
-    }
+    // 释放交织器中残留的 AVPacket（防止内存泄漏）
+    m_interleaver.reset();
 
-    if (m_formatCtx && m_formatCtx->pb)
+    // 写入文件尾；分段时同时登记最后一段并更新播放列表
+    if (m_formatCtx)
     {
-        av_write_trailer(m_formatCtx);
+        if (segmentingEnabled())
+            finishSegment();
+        else
+            closeOutput();
     }
 
     if (m_swsCtx)
@@ -478,14 +628,20 @@ void MeetingRecorder::cleanupFFmpeg()
         sws_freeContext(m_swsCtx);
         m_swsCtx = nullptr;
     }
-    if (m_swrCtx)
+    if (m_yuvSwsCtx)
+    {
+        sws_freeContext(m_yuvSwsCtx);
+        m_yuvSwsCtx = nullptr;
+    }
+    if (m_sendFrame)
     {
-        swr_free(&m_swrCtx);
+        av_frame_free(&m_sendFrame);
     }
-    if (m_videoFrame)
+    for (AVFrame *frame : m_convertFrames)
     {
-        av_frame_free(&m_videoFrame);
+        av_frame_free(&frame);
     }
+    m_convertFrames.clear();
     if (m_audioFrame)
     {
         av_frame_free(&m_audioFrame);
@@ -498,57 +654,365 @@ void MeetingRecorder::cleanupFFmpeg()
     {
         avcodec_free_context(&m_audioCodecCtx);
     }
-    if (m_formatCtx)
+    avcodec_parameters_free(&m_videoParams);
+    avcodec_parameters_free(&m_audioParams);
+}
+
+bool MeetingRecorder::openOutput(const QString &path)
+{
+    int ret = avformat_alloc_output_context2(&m_formatCtx, m_outputFormat,
+                                             nullptr, path.toUtf8().constData());
+    if (ret < 0 || !m_formatCtx)
+    {
+        qWarning() << "[MeetingRecorder] avformat_alloc_output_context2 失败";
+        return false;
+    }
+
+    // 流顺序与交织器通道一致（stream index == PacketLane）
+    AVStream *videoStream = avformat_new_stream(m_formatCtx, nullptr);
+    AVStream *audioStream = avformat_new_stream(m_formatCtx, nullptr);
+    if (!videoStream || !audioStream ||
+        avcodec_parameters_copy(videoStream->codecpar, m_videoParams) < 0 ||
+        avcodec_parameters_copy(audioStream->codecpar, m_audioParams) < 0)
+    {
+        closeOutput();
+        return false;
+    }
+    videoStream->time_base = {1, VIDEO_TIME_BASE};
+    audioStream->time_base = {1, m_audioSampleRate};
+
+    if (!(m_formatCtx->oformat->flags & AVFMT_NOFILE))
     {
-        if (m_formatCtx->pb && !(m_formatCtx->oformat->flags & AVFMT_NOFILE))
+        ret = avio_open(&m_formatCtx->pb, path.toUtf8().constData(),
+                        AVIO_FLAG_WRITE);
+        if (ret < 0)
         {
-            avio_closep(&m_formatCtx->pb);
+            qWarning() << "[MeetingRecorder] avio_open 失败:" << path;
+            closeOutput();
+            return false;
         }
-        avformat_free_context(m_formatCtx);
-        m_formatCtx = nullptr;
     }
+
+    // 分片 MP4：
+    // - frag_keyframe：每个视频关键帧开始新分片（GOP = 分片时长）
+    // - empty_moov：不含样本的 moov 写在文件开头，结尾无需回写索引，
+    //   也就不需要 faststart 那样的二次搬移
+    // - default_base_moof：分片内数据偏移相对 moof，CMAF / MSE 播放要求
+    // - frag_duration：合成器停止、只有音频时按时长兜底切分（取两倍分片时长，
+    //   避免抢在关键帧之前切出不以关键帧开头的分片）
+    // 每个分片写完后 movenc 会 flush AVIO，进程崩溃时文件可播放到最后一个分片
+    AVDictionary *muxOptions = nullptr;
+    if (m_fragmented)
+    {
+        av_dict_set(&muxOptions, "movflags",
+                    "frag_keyframe+empty_moov+default_base_moof", 0);
+        av_dict_set_int(&muxOptions, "frag_duration",
+                        static_cast<int64_t>(m_fragmentDurationMs) * 2 * 1000, 0);
+    }
+
+    // 写文件头
+    ret = avformat_write_header(m_formatCtx, &muxOptions);
+    if (muxOptions)
+    {
+        // 未被容器消费的选项（如输出不是 MP4 / MOV）
+        qWarning() << "[MeetingRecorder] 容器不支持分片输出, 已忽略:"
+                   << m_formatCtx->oformat->name;
+        av_dict_free(&muxOptions);
+    }
+    if (ret < 0)
+    {
+        qWarning() << "[MeetingRecorder] avformat_write_header 失败:" << ret;
+        closeOutput();
+        return false;
+    }
+
+    m_outputHeaderWritten = true;
+    m_currentOutputPath = path;
+    return true;
+}
+
+void MeetingRecorder::closeOutput()
+{
+    if (!m_formatCtx)
+        return;
+
+    if (m_outputHeaderWritten)
+    {
+        av_write_trailer(m_formatCtx);
+        m_outputHeaderWritten = false;
+    }
+    if (m_formatCtx->pb && !(m_formatCtx->oformat->flags & AVFMT_NOFILE))
+    {
+        avio_closep(&m_formatCtx->pb);
+    }
+    avformat_free_context(m_formatCtx);
+    m_formatCtx = nullptr;
 }
 
 // ==============================================================================
-// 编码
+// 分段录制（mux 线程）
 // ==============================================================================
 
-bool MeetingRecorder::encodeVideoFrame(const QImage &frame,
-                                       qint64 timestampUs)
+void MeetingRecorder::setSegmentDurationSeconds(int seconds)
+{
+    if (m_recording.load())
+    {
+        qWarning() << "[MeetingRecorder] 录制中不能修改分段设置";
+        return;
+    }
+    m_segmentDurationSec = qMax(0, seconds);
+}
+
+void MeetingRecorder::setSegmentMaxBytes(qint64 bytes)
+{
+    if (m_recording.load())
+    {
+        qWarning() << "[MeetingRecorder] 录制中不能修改分段设置";
+        return;
+    }
+    m_segmentMaxBytes = qMax<qint64>(0, bytes);
+}
+
+QString MeetingRecorder::segmentPath(int index) const
 {
-    if (!m_videoCodecCtx || !m_formatCtx)
+    // meeting_x.mp4 → meeting_x_000.mp4, meeting_x_001.mp4, ...
+    const QFileInfo info(m_outputPath);
+    return info.absolutePath() + "/" +
+           QString("%1_%2.%3")
+               .arg(info.completeBaseName())
+               .arg(index, 3, 10, QChar('0'))
+               .arg(info.suffix());
+}
+
+bool MeetingRecorder::segmentRotationDue(qint64 dtsUs) const
+{
+    if (!m_formatCtx || m_segmentFirstUs < 0)
         return false;
+    const qint64 maxDurationUs =
+        static_cast<qint64>(m_segmentDurationSec) * 1000000;
+    if (maxDurationUs > 0 && dtsUs - m_segmentFirstUs >= maxDurationUs)
+        return true;
+    // 已写出字节数（含 AVIO 缓冲；fMP4 当前分片尚在内存中，按上一分片计）
+    return m_segmentMaxBytes > 0 && m_formatCtx->pb &&
+           avio_tell(m_formatCtx->pb) >= m_segmentMaxBytes;
+}
 
-    // 确保帧格式正确
-    QImage bgraFrame;
-    if (frame.format() == QImage::Format_ARGB32 ||
-        frame.format() == QImage::Format_ARGB32_Premultiplied)
+void MeetingRecorder::rotateSegment(qint64 keyframeDtsUs)
+{
+    // 只在 mux 线程中切换输出文件：编码线程继续向交织器写 packet，
+    // 切换期间（写文件尾 + 打开新文件）的 packet 在交织器中排队，不阻塞编码
+    finishSegment();
+
+    ++m_segmentIndex;
+    m_segmentTsOffsetUs = keyframeDtsUs; // 新段时间戳从 0 开始
+    m_segmentFirstUs = -1;
+    m_segmentLastUs = -1;
+    if (!openOutput(segmentPath(m_segmentIndex)))
     {
-        // QImage ARGB32 在内存中实际上是 BGRA（小端）
-        bgraFrame = frame;
+        qWarning() << "[MeetingRecorder] 打开新分段失败, 后续数据将丢弃:"
+                   << segmentPath(m_segmentIndex);
+        QMetaObject::invokeMethod(this, [this]()
+                                  { emit errorOccurred("录制分段文件创建失败"); },
+                                  Qt::QueuedConnection);
     }
-    else
+}
+
+void MeetingRecorder::finishSegment()
+{
+    if (!m_formatCtx)
+        return;
+
+    const QString path = m_currentOutputPath;
+    closeOutput();
+
+    SegmentInfo segment;
+    segment.fileName = QFileInfo(path).fileName();
+    segment.durationSeconds =
+        m_segmentFirstUs >= 0
+            ? static_cast<double>(m_segmentLastUs - m_segmentFirstUs) / 1e6
+            : 0.0;
+    segment.bytes = QFileInfo(path).size();
+    m_segments.append(segment);
+    writePlaylist();
+
+    qDebug() << "[MeetingRecorder] 分段完成:" << segment.fileName
+             << "时长:" << segment.durationSeconds << "秒"
+             << "大小:" << segment.bytes << "字节";
+    QMetaObject::invokeMethod(this, [this, path]()
+                              { emit segmentFinished(path); },
+                              Qt::QueuedConnection);
+}
+
+void MeetingRecorder::writePlaylist() const
+{
+    // 扩展 M3U：按顺序列出各分段（相对路径），常见播放器可连续播放
+    QFile file(m_playlistPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        qWarning() << "[MeetingRecorder] 无法写入播放列表:" << m_playlistPath;
+        return;
+    }
+    QTextStream out(&file);
+    out << "#EXTM3U\n";
+    for (const SegmentInfo &segment : m_segments)
     {
-        bgraFrame = frame.convertToFormat(QImage::Format_ARGB32);
+        out << "#EXTINF:" << QString::number(segment.durationSeconds, 'f', 3)
+            << "," << segment.fileName << "\n"
+            << segment.fileName << "\n";
     }
+}
+
+// ==============================================================================
+// 编码
+// ==============================================================================
 
-    // 缩放到目标分辨率（如果需要）
-    if (bgraFrame.width() != m_videoWidth ||
-        bgraFrame.height() != m_videoHeight)
+AVFrameRef MeetingRecorder::convertQueuedVideo(const VideoQueueItem &item)
+{
+    if (item.yuv)
     {
-        bgraFrame =
-            bgraFrame.scaled(m_videoWidth, m_videoHeight, Qt::IgnoreAspectRatio,
-                             Qt::SmoothTransformation);
+        const AVFrame *frame = item.yuv.get();
+        if (frame->format == AV_PIX_FMT_YUV420P &&
+            frame->width == m_videoWidth && frame->height == m_videoHeight)
+        {
+            // 尺寸与格式一致：直接引用合成器缓冲送编码器，无转换无拷贝
+            return item.yuv;
+        }
+
+        // 尺寸不一致：YUV → YUV 缩放到录制分辨率
+        if (!ensureSwsContext(m_yuvSwsCtx, frame->width, frame->height,
+                              static_cast<AVPixelFormat>(frame->format)))
+            return {};
+        AVFrame *dst = acquireConvertFrame();
+        if (!dst || sws_scale_frame(m_yuvSwsCtx, dst, frame) < 0)
+        {
+            qWarning() << "[MeetingRecorder] YUV sws_scale_frame 失败";
+            return {};
+        }
+        return makeAVFrameRef(dst);
     }
 
-    // BGRA → YUV420P
-    av_frame_make_writable(m_videoFrame);
+    if (item.image.isNull())
+        return {};
 
-    const uint8_t *srcData[1] = {bgraFrame.constBits()};
-    int srcLinesize[1] = {static_cast<int>(bgraFrame.bytesPerLine())};
+    // 确保帧格式正确：QImage ARGB32 / RGB32 在内存中实际上是 BGRA（小端）
+    QImage bgraFrame = item.image;
+    if (bgraFrame.format() != QImage::Format_ARGB32 &&
+        bgraFrame.format() != QImage::Format_ARGB32_Premultiplied &&
+        bgraFrame.format() != QImage::Format_RGB32)
+    {
+        bgraFrame = bgraFrame.convertToFormat(QImage::Format_ARGB32);
+    }
 
-    sws_scale(m_swsCtx, srcData, srcLinesize, 0, m_videoHeight,
-              m_videoFrame->data, m_videoFrame->linesize);
+    // sws_scale_frame 只对引用计数帧免拷贝：用 AVBuffer 包装 QImage 的像素，
+    // 引用释放时再删除持有的 QImage
+    AVFrame *src = av_frame_alloc();
+    if (!src)
+        return {};
+    auto *holder = new QImage(bgraFrame);
+    src->buf[0] = av_buffer_create(const_cast<uint8_t *>(holder->constBits()),
+                                   static_cast<size_t>(holder->sizeInBytes()),
+                                   releaseImageBuffer, holder,
+                                   AV_BUFFER_FLAG_READONLY);
+    if (!src->buf[0])
+    {
+        delete holder;
+        av_frame_free(&src);
+        return {};
+    }
+    src->data[0] = src->buf[0]->data;
+    src->linesize[0] = static_cast<int>(holder->bytesPerLine());
+    src->format = AV_PIX_FMT_BGRA;
+    src->width = holder->width();
+    src->height = holder->height();
+
+    // BGRA → YUV420P（尺寸不一致时同一趟完成缩放）
+    AVFrameRef result;
+    if (ensureSwsContext(m_swsCtx, src->width, src->height, AV_PIX_FMT_BGRA))
+    {
+        AVFrame *dst = acquireConvertFrame();
+        if (dst && sws_scale_frame(m_swsCtx, dst, src) >= 0)
+            result = makeAVFrameRef(dst);
+        else
+            qWarning() << "[MeetingRecorder] sws_scale_frame 失败";
+    }
+    av_frame_free(&src);
+    return result;
+}
+
+bool MeetingRecorder::ensureSwsContext(SwsContext *&ctx, int srcWidth,
+                                       int srcHeight, AVPixelFormat srcFormat)
+{
+    if (ctx)
+    {
+        int64_t w = 0, h = 0, format = AV_PIX_FMT_NONE;
+        av_opt_get_int(ctx, "srcw", 0, &w);
+        av_opt_get_int(ctx, "srch", 0, &h);
+        av_opt_get_int(ctx, "src_format", 0, &format);
+        if (w == srcWidth && h == srcHeight && format == srcFormat)
+            return true;
+        sws_freeContext(ctx);
+        ctx = nullptr;
+    }
+
+    // sws_getContext 不能设置线程数，改用 AVOption 配置；
+    // 切片多线程只在 sws_scale_frame 路径生效
+    ctx = sws_alloc_context();
+    if (!ctx)
+        return false;
+    av_opt_set_int(ctx, "srcw", srcWidth, 0);
+    av_opt_set_int(ctx, "srch", srcHeight, 0);
+    av_opt_set_int(ctx, "src_format", srcFormat, 0);
+    av_opt_set_int(ctx, "dstw", m_videoWidth, 0);
+    av_opt_set_int(ctx, "dsth", m_videoHeight, 0);
+    av_opt_set_int(ctx, "dst_format", AV_PIX_FMT_YUV420P, 0);
+    av_opt_set_int(ctx, "sws_flags", SWS_FAST_BILINEAR, 0);
+    av_opt_set_int(ctx, "threads", 0, 0); // 0 = 按 CPU 核数自动
+    if (sws_init_context(ctx, nullptr, nullptr) < 0)
+    {
+        qWarning() << "[MeetingRecorder] sws_init_context 失败:" << srcWidth
+                   << "x" << srcHeight << av_get_pix_fmt_name(srcFormat);
+        sws_freeContext(ctx);
+        ctx = nullptr;
+        return false;
+    }
+    return true;
+}
+
+AVFrame *MeetingRecorder::acquireConvertFrame()
+{
+    // 池中帧只剩池自身一个引用时即可复用；池大小受两级队列容量限制
+    for (AVFrame *frame : m_convertFrames)
+    {
+        if (av_frame_is_writable(frame))
+            return frame;
+    }
+
+    AVFrame *frame = av_frame_alloc();
+    if (!frame)
+        return nullptr;
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = m_videoWidth;
+    frame->height = m_videoHeight;
+    if (av_frame_get_buffer(frame, 0) < 0)
+    {
+        av_frame_free(&frame);
+        return nullptr;
+    }
+    m_convertFrames.push_back(frame);
+    return frame;
+}
+
+bool MeetingRecorder::sendVideoFrame(const AVFrame *frame, qint64 timestampUs)
+{
+    // 不检查 m_formatCtx：它只归 mux 线程所有，分段切换时会被重建；
+    // 编码器在线程启动前创建、线程结束后释放，切换期间的 packet 在交织器中排队
+    if (!m_videoCodecCtx || !frame)
+        return false;
+
+    // 引用队列中的帧送编码器（不拷贝像素），PTS 写在自己的引用上
+    av_frame_unref(m_sendFrame);
+    if (av_frame_ref(m_sendFrame, frame) < 0)
+        return false;
 
     // 使用挂钟时间戳计算 PTS（time_base = 1/90000），避免低精度导致 DTS 重复
     int64_t pts = timestampUs * VIDEO_TIME_BASE / 1000000;
@@ -561,58 +1025,35 @@ bool MeetingRecorder::encodeVideoFrame(const QImage &frame,
         pts = m_lastVideoPts + 1;
     }
     m_lastVideoPts = pts;
-    m_videoFrame->pts = pts;
+    m_sendFrame->pts = pts;
     m_videoFrameCount++;
 
     // 发送帧到编码器
-    int ret = avcodec_send_frame(m_videoCodecCtx, m_videoFrame);
+    int ret = avcodec_send_frame(m_videoCodecCtx, m_sendFrame);
+    av_frame_unref(m_sendFrame);
     if (ret < 0)
     {
         qWarning() << "[MeetingRecorder] avcodec_send_frame(video) 失败:" << ret;
         return false;
     }
 
-    // 读取编码后的数据包，存入队列（不直接写文件）
-    AVPacket *pkt = av_packet_alloc();
-    while (ret >= 0)
-    {
-        ret = avcodec_receive_packet(m_videoCodecCtx, pkt);
-        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
-            break;
-        if (ret < 0)
-        {
-            av_packet_free(&pkt);
-            return false;
-        }
-
-        // 时间基转换
-        av_packet_rescale_ts(pkt, m_videoCodecCtx->time_base,
-                             m_videoStream->time_base);
-        pkt->stream_index = m_videoStream->index;
-
-        // 克隆并入队
-        AVPacket *clone = av_packet_clone(pkt);
-        {
-            QMutexLocker locker(&m_packetMutex);
-            m_videoPackets.enqueue(clone);
-        }
-    }
-    av_packet_free(&pkt);
+    // 读取编码后的数据包，存入队列（由 mux 线程写文件）
+    drainEncoder(m_videoCodecCtx, LaneVideo);
     return true;
 }
 
-bool MeetingRecorder::encodeAudioSamples(const int16_t *samples,
+bool MeetingRecorder::encodeAudioSamples(const float *samples,
                                          int sampleCount)
 {
-    if (!m_audioCodecCtx || !m_formatCtx || sampleCount <= 0)
+    if (!m_audioCodecCtx || sampleCount <= 0)
         return false;
 
     // 追加到编码缓冲区
     m_audioEncodeBuf.append(reinterpret_cast<const char *>(samples),
-                            sampleCount * static_cast<int>(sizeof(int16_t)));
+                            sampleCount * static_cast<int>(sizeof(float)));
 
     const int frameSizeBytes =
-        m_audioFrameSize * static_cast<int>(sizeof(int16_t));
+        m_audioFrameSize * static_cast<int>(sizeof(float));
 
     // 每凑齐一帧就编码
     while (m_audioEncodeBuf.size() >= frameSizeBytes)
@@ -620,18 +1061,9 @@ bool MeetingRecorder::encodeAudioSamples(const int16_t *samples,
         av_frame_make_writable(m_audioFrame);
         m_audioFrame->nb_samples = m_audioFrameSize;
 
-        // 使用 SWR 将 int16 转为 float planar
-        const uint8_t *inData[1] = {
-            reinterpret_cast<const uint8_t *>(m_audioEncodeBuf.constData())};
-
-        int converted = swr_convert(m_swrCtx, m_audioFrame->data,
-                                    m_audioFrameSize, inData, m_audioFrameSize);
-        if (converted < 0)
-        {
-            qWarning() << "[MeetingRecorder] swr_convert 失败";
-            m_audioEncodeBuf.remove(0, frameSizeBytes);
-            continue;
-        }
+        // 输入已是单声道 float，直接拷贝到编码帧的第 0 个平面
+        std::memcpy(m_audioFrame->data[0], m_audioEncodeBuf.constData(),
+                    static_cast<size_t>(frameSizeBytes));
 
         m_audioFrame->pts = m_audioSampleCount;
         m_audioSampleCount += m_audioFrameSize;
@@ -644,91 +1076,55 @@ bool MeetingRecorder::encodeAudioSamples(const int16_t *samples,
             continue;
         }
 
-        AVPacket *pkt = av_packet_alloc();
-        while (ret >= 0)
-        {
-            ret = avcodec_receive_packet(m_audioCodecCtx, pkt);
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
-                break;
-            if (ret < 0)
-            {
-                av_packet_free(&pkt);
-                m_audioEncodeBuf.remove(0, frameSizeBytes);
-                return false;
-            }
-
-            av_packet_rescale_ts(pkt, m_audioCodecCtx->time_base,
-                                 m_audioStream->time_base);
-            pkt->stream_index = m_audioStream->index;
-
-            // 克隆并入队
-            AVPacket *clone = av_packet_clone(pkt);
-            {
-                QMutexLocker locker(&m_packetMutex);
-                m_audioPackets.enqueue(clone);
-            }
-        }
-        av_packet_free(&pkt);
+        drainEncoder(m_audioCodecCtx, LaneAudio);
         m_audioEncodeBuf.remove(0, frameSizeBytes);
     }
 
     return true;
 }
 
-void MeetingRecorder::flushEncoders()
+void MeetingRecorder::drainEncoder(AVCodecContext *codecCtx, PacketLane lane)
 {
-    if (!m_formatCtx)
-        return;
-
-    // Flush 视频编码器 —— 将剩余包存入队列
-    if (m_videoCodecCtx)
+    bool received = false;
+    AVPacket *pkt = av_packet_alloc();
+    while (pkt)
     {
-        avcodec_send_frame(m_videoCodecCtx, nullptr);
-        AVPacket *pkt = av_packet_alloc();
-        int ret = 0;
-        while (ret >= 0)
+        int ret = avcodec_receive_packet(codecCtx, pkt);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+            break;
+        if (ret < 0)
         {
-            ret = avcodec_receive_packet(m_videoCodecCtx, pkt);
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
-                break;
-            if (ret < 0)
-                break;
-            av_packet_rescale_ts(pkt, m_videoCodecCtx->time_base,
-                                 m_videoStream->time_base);
-            pkt->stream_index = m_videoStream->index;
-            AVPacket *clone = av_packet_clone(pkt);
-            {
-                QMutexLocker locker(&m_packetMutex);
-                m_videoPackets.enqueue(clone);
-            }
+            qWarning() << "[MeetingRecorder] avcodec_receive_packet 失败:" << ret;
+            break;
         }
-        av_packet_free(&pkt);
-    }
 
-    // Flush 音频编码器 —— 将剩余包存入队列
-    if (m_audioCodecCtx)
-    {
-        avcodec_send_frame(m_audioCodecCtx, nullptr);
-        AVPacket *pkt = av_packet_alloc();
-        int ret = 0;
-        while (ret >= 0)
+        // 保持编码器时间基，由 mux 线程按当前输出文件的流时间基转换
+        // （分段切换时输出流会重建，编码线程不访问输出上下文）
+        pkt->time_base = codecCtx->time_base;
+        pkt->stream_index = lane;
+
+        // packet 直接入队（所有权交给 mux 线程），下一轮重新分配
+        const PacketInterleaver::Entry entry{
+            pkt, packetDtsInUs(pkt), m_wallClock.nsecsElapsed() / 1000};
+        while (!m_interleaver.push(lane, entry))
         {
-            ret = avcodec_receive_packet(m_audioCodecCtx, pkt);
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
-                break;
-            if (ret < 0)
-                break;
-            av_packet_rescale_ts(pkt, m_audioCodecCtx->time_base,
-                                 m_audioStream->time_base);
-            pkt->stream_index = m_audioStream->index;
-            AVPacket *clone = av_packet_clone(pkt);
-            {
-                QMutexLocker locker(&m_packetMutex);
-                m_audioPackets.enqueue(clone);
-            }
+            // 通道已满：mux 跟不上写盘，短暂等待形成反压
+            m_muxWakeup.release();
+            QThread::usleep(500);
         }
-        av_packet_free(&pkt);
+        received = true;
+        pkt = av_packet_alloc();
     }
+    av_packet_free(&pkt);
+
+    if (received)
+        m_muxWakeup.release();
+}
+
+void MeetingRecorder::finishLane(PacketLane lane)
+{
+    m_interleaver.finish(lane);
+    m_muxWakeup.release();
 }
 
 // ==============================================================================
@@ -737,66 +1133,58 @@ void MeetingRecorder::flushEncoders()
 
 int64_t MeetingRecorder::packetDtsInUs(const AVPacket *pkt) const
 {
-    // 根据 stream_index 确定是视频还是音频，将 DTS 转换为微秒
-    AVRational tb;
-    if (pkt->stream_index == m_videoStream->index)
-        tb = m_videoStream->time_base;
-    else
-        tb = m_audioStream->time_base;
-
+    // packet 仍为编码器时间基，将 DTS 转换为微秒（用于跨流比较）
     int64_t dts = (pkt->dts != AV_NOPTS_VALUE) ? pkt->dts : pkt->pts;
-    // dts * tb.num / tb.den 转换为秒，再乘 1000000 转微秒
-    return av_rescale_q(dts, tb, {1, 1000000});
+    return av_rescale_q(dts, pkt->time_base, {1, 1000000});
 }
 
 void MeetingRecorder::writeInterleavedPackets()
 {
-    QMutexLocker lock(&m_packetMutex);
+    // 交织器按时间戳决定写入顺序：另一路有更晚的包、已结束，
+    // 或已沉默超过水位线时即可写出，不再要求两侧同时有包
+    PacketInterleaver::Entry queued;
+    while (m_interleaver.pop(queued))
+        writeQueuedPacket(queued);
+}
 
-    // 只有在两侧都有包时才归并写入，确保全局时间单调递增
-    while (!m_videoPackets.isEmpty() && !m_audioPackets.isEmpty())
+void MeetingRecorder::writeQueuedPacket(PacketInterleaver::Entry &queued)
+{
+    m_stageWait[StageMux].record(m_wallClock.nsecsElapsed() / 1000 -
+                                 queued.queuedAtUs);
+    QElapsedTimer timer;
+    timer.start();
+
+    AVPacket *pkt = queued.packet;
+    // 分段：到达时长 / 大小上限后，在视频关键帧处切换到新文件
+    if (segmentingEnabled() && pkt->stream_index == LaneVideo &&
+        (pkt->flags & AV_PKT_FLAG_KEY) && segmentRotationDue(queued.dtsUs))
     {
-        int64_t vDts = packetDtsInUs(m_videoPackets.head());
-        int64_t aDts = packetDtsInUs(m_audioPackets.head());
+        rotateSegment(queued.dtsUs);
+    }
 
-        AVPacket *pkt = (vDts <= aDts)
-                            ? m_videoPackets.dequeue()
-                            : m_audioPackets.dequeue();
+    if (m_formatCtx)
+    {
+        if (m_segmentFirstUs < 0)
+            m_segmentFirstUs = queued.dtsUs;
+        m_segmentLastUs = qMax(m_segmentLastUs, queued.dtsUs);
 
-        lock.unlock();
+        // 每段时间戳从段起点开始，分段可独立播放
+        if (m_segmentTsOffsetUs > 0)
         {
-            QMutexLocker muxLock(&m_muxMutex);
-            av_interleaved_write_frame(m_formatCtx, pkt);
+            const int64_t offset =
+                av_rescale_q(m_segmentTsOffsetUs, {1, 1000000}, pkt->time_base);
+            if (pkt->pts != AV_NOPTS_VALUE)
+                pkt->pts -= offset;
+            if (pkt->dts != AV_NOPTS_VALUE)
+                pkt->dts -= offset;
         }
-        av_packet_free(&pkt);
-        lock.relock();
-    }
-}
-
-void MeetingRecorder::flushPacketQueues()
-{
-    QMutexLocker lock(&m_packetMutex);
 
-    // 收尾阶段：将两个队列剩余的 packets 合并、按 DTS 排序后写入
-    QList<AVPacket *> remaining;
-    while (!m_videoPackets.isEmpty())
-        remaining.append(m_videoPackets.dequeue());
-    while (!m_audioPackets.isEmpty())
-        remaining.append(m_audioPackets.dequeue());
-
-    // 按 DTS 排序
-    std::sort(remaining.begin(), remaining.end(),
-              [this](const AVPacket *a, const AVPacket *b)
-              {
-                  return packetDtsInUs(a) < packetDtsInUs(b);
-              });
-
-    lock.unlock();
-
-    QMutexLocker muxLock(&m_muxMutex);
-    for (AVPacket *pkt : remaining)
-    {
+        AVStream *stream = m_formatCtx->streams[pkt->stream_index];
+        av_packet_rescale_ts(pkt, pkt->time_base, stream->time_base);
+        pkt->time_base = stream->time_base;
         av_interleaved_write_frame(m_formatCtx, pkt);
-        av_packet_free(&pkt);
     }
+
+    m_stageProcess[StageMux].record(timer.nsecsElapsed() / 1000);
+    av_packet_free(&queued.packet);
 }
@@ -5,8 +5,27 @@
  * 负责：
  * 1. 接收 VideoCompositor 输出的合成视频帧
  * 2. 接收 AudioMixer 输出的混合音频数据
- * 3. 使用 FFmpeg 将音视频编码为单个 MP4 文件（H.264 + AAC）
+ * 3. 使用 FFmpeg 将音视频编码为单个 MP4 文件（H.264 / HEVC / AV1 + AAC，见 EncoderProfile）
  * 4. 编码运行在后台线程中，不阻塞 UI
+ * 5. 可选分片 MP4（fMP4）输出：进程崩溃或停止超时也能播放到最后一个分片
+ * 6. 可选分段录制：按时长 / 大小在关键帧处切换文件，并维护 M3U 播放列表
+ *
+ * 编码流水线（每个阶段一个线程，阶段之间是有界队列）：
+ *
+ *   feedVideoFrame / feedYuvFrame
+ *        │ m_videoQueue（满时丢帧）
+ *   [convert]      BGRA → YUV420P / 缩放（sws 切片多线程）；YUV 直通不转换
+ *        │ m_encodeQueue（满时阻塞 convert，形成反压）
+ *   [video encode] EncoderProfile 选定的编码器（默认 libx264 帧级多线程）
+ *        │                                   feedAudioData / feedPlanarAudio
+ *        │                                        │ m_audioBuffer
+ *        │                                   [audio encode] AAC
+ *        ▼                                        ▼
+ *        └────────── PacketInterleaver（无锁，按 DTS 排序）
+ *   [mux]          按时间戳交织写入文件，并更新录制时长
+ *
+ * 各阶段的输入队列深度、排队时长和处理时长见 pipelineStats()，
+ * 录制期间每 STATS_LOG_INTERVAL_MS 打印一次，停止时打印汇总。
  */
 
 #ifndef MEETINGRECORDER_H
@@ -14,14 +33,22 @@
 
 #include <QElapsedTimer>
 #include <QImage>
+#include <QList>
 #include <QMutex>
 #include <QObject>
 #include <QString>
 #include <QThread>
-#include <QQueue>
+#include <QSemaphore>
 #include <QWaitCondition>
 #include <atomic>
 #include <memory>
+#include <vector>
+
+#include "boundedqueue.h"
+#include "compositeframe.h"
+#include "encoderprofile.h"
+#include "latencyhistogram.h"
+#include "packetinterleaver.h"
 
 // FFmpeg headers (C API)
 extern "C"
@@ -31,7 +58,6 @@ extern "C"
 #include <libavutil/avutil.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
-#include <libswresample/swresample.h>
 #include <libswscale/swscale.h>
 }
 
@@ -48,6 +74,70 @@ public:
     bool isRecording() const { return m_recording.load(); }
     int durationSeconds() const { return m_durationSeconds.load(); }
 
+    /**
+     * @brief 流水线单个阶段的统计
+     */
+    struct PipelineStageStats
+    {
+        QString name;
+        int queueDepth = 0;    // 阶段输入队列当前深度（音频为待编码的 AAC 帧数）
+        int maxQueueDepth = 0; // 本次录制以来的最大深度
+        LatencyHistogram::Snapshot wait;    // 排队时长
+        LatencyHistogram::Snapshot process; // 处理时长
+    };
+
+    /** @brief 各阶段统计（convert / video_encode / audio_encode / mux，任意线程） */
+    QList<PipelineStageStats> pipelineStats() const;
+
+    static constexpr int DEFAULT_FRAGMENT_DURATION_MS = 2000;
+    static constexpr int MIN_FRAGMENT_DURATION_MS = 500;
+
+    /**
+     * @brief 分片 MP4 输出（fMP4，moov 在文件开头，之后每个分片一组 moof + mdat）
+     *
+     * 文件随录制不断变为可播放、可拖动，不依赖结束时写入的 moov，
+     * 也不需要录制后再做 remux。仅对 MP4 / MOV 容器生效，录制开始前设置。
+     */
+    void setFragmentedOutput(bool enabled);
+    bool fragmentedOutput() const { return m_fragmented; }
+
+    /**
+     * @brief 分片时长（毫秒，最小 MIN_FRAGMENT_DURATION_MS），录制开始前设置
+     *
+     * 同时作为关键帧间隔：越短崩溃时丢失越少、拖动越精细，但压缩率略降。
+     */
+    void setFragmentDurationMs(int ms);
+    int fragmentDurationMs() const { return m_fragmentDurationMs; }
+
+    /**
+     * @brief 分段录制：每段最长时长（秒，0 = 不按时长分段），录制开始前设置
+     *
+     * 与 setSegmentMaxBytes 任一启用即进入分段模式：输出为
+     * <名称>_000.mp4、<名称>_001.mp4 ...，每段在视频关键帧处开始、时间戳从 0
+     * 开始，可独立播放；同目录下的 <名称>.m3u 按顺序列出已完成的分段。
+     * 切换在 mux 线程中完成，期间编码线程继续工作。
+     */
+    void setSegmentDurationSeconds(int seconds);
+    int segmentDurationSeconds() const { return m_segmentDurationSec; }
+
+    /** @brief 分段录制：每段最大字节数（近似，0 = 不按大小分段），录制开始前设置 */
+    void setSegmentMaxBytes(qint64 bytes);
+    qint64 segmentMaxBytes() const { return m_segmentMaxBytes; }
+
+    bool segmentingEnabled() const
+    {
+        return m_segmentDurationSec > 0 || m_segmentMaxBytes > 0;
+    }
+
+    /**
+     * @brief 视频编码配置（编码器 / 预设 / 码控 / 线程数），录制开始前设置
+     *
+     * 可用 EncoderCalibrator 按本机性能选出；编码器在当前 FFmpeg 构建中
+     * 不可用时回退到默认配置（libx264 fast, crf 23）。
+     */
+    void setEncoderProfile(const EncoderProfile &profile);
+    EncoderProfile encoderProfile() const { return m_encoderProfile; }
+
 public slots:
     /**
      * @brief 开始录制
@@ -75,39 +165,123 @@ public slots:
     void feedVideoFrame(const QImage &frame, qint64 timestampUs);
 
     /**
-     * @brief 输入混合音频数据
+     * @brief 输入合成视频帧（YUV420P，编码器原生格式）
+     *
+     * 连接到 VideoCompositor::compositeYuvFrameReady（YUV420P 输出模式），
+     * 尺寸与录制分辨率一致时直接送编码器，不做颜色转换和拷贝。
+     * @param frame YUV420P 帧句柄（只读，编码完成后释放引用）
+     * @param timestampUs 时间戳（微秒）
+     */
+    void feedYuvFrame(const AVFrameRef &frame, qint64 timestampUs);
+
+    /**
+     * @brief 输入混合音频数据（int16，转换为 float 后缓存）
      * @param pcmData int16_t PCM 数据
      * @param sampleRate 采样率
      * @param channels 声道数
      */
     void feedAudioData(const QByteArray &pcmData, int sampleRate, int channels);
 
+    /**
+     * @brief 输入混合音频数据（单声道 float planar，AAC 编码器原生格式）
+     *
+     * 推荐连接到 AudioMixer::output({48000, FloatPlanar}) 的 audioReady，
+     * 编码线程直接拷贝进 AVFrame，无需再做格式转换。
+     * @param fltpData float 采样
+     * @param sampleRate 采样率（应与 startRecording 的 audioSampleRate 一致）
+     * @param channels 声道数（仅支持 1）
+     */
+    void feedPlanarAudio(const QByteArray &fltpData, int sampleRate,
+                         int channels);
+
 signals:
     void recordingChanged();
     void durationChanged();
     void errorOccurred(const QString &error);
+    // 分段模式下 filePath 为播放列表路径
     void recordingStopped(const QString &filePath);
+    // 分段模式下每完成一个分段文件发出一次（含最后一段）
+    void segmentFinished(const QString &filePath);
 
 private:
-    // 编码线程入口
-    void encodingLoop();
+    // 视频队列项：QImage 或 YUV420P 帧二选一
+    struct VideoQueueItem
+    {
+        QImage image;
+        AVFrameRef yuv;
+        qint64 timestampUs = 0;
+    };
+
+    // 流水线阶段
+    enum Stage
+    {
+        StageConvert,
+        StageVideoEncode,
+        StageAudioEncode,
+        StageMux,
+        STAGE_COUNT
+    };
+
+    // PacketInterleaver 通道
+    enum PacketLane
+    {
+        LaneVideo,
+        LaneAudio,
+        LANE_COUNT
+    };
+
+    // 各阶段线程入口
+    void convertLoop();
+    void videoEncodeLoop();
+    void audioEncodeLoop();
+    void muxLoop();
+
+    // 打印各阶段统计
+    void logPipelineStats() const;
 
     // 初始化 FFmpeg 输出上下文和编码器
     bool initFFmpeg(const QString &outputPath, int width, int height, int fps,
                     int audioSampleRate);
     void cleanupFFmpeg();
+    // 创建输出上下文、按编码参数建流并写文件头（失败时自行清理）
+    bool openOutput(const QString &path);
+    // 写文件尾并关闭当前输出
+    void closeOutput();
 
-    // 编码单帧视频
-    bool encodeVideoFrame(const QImage &frame, qint64 timestampUs);
-    // 编码音频数据
-    bool encodeAudioSamples(const int16_t *samples, int sampleCount);
-    // flush 编码器
-    void flushEncoders();
+    // 分段录制（mux 线程）
+    QString segmentPath(int index) const;
+    bool segmentRotationDue(qint64 dtsUs) const;
+    // 关闭当前分段并打开下一段（在视频关键帧处调用）
+    void rotateSegment(qint64 keyframeDtsUs);
+    // 关闭当前分段，登记到播放列表
+    void finishSegment();
+    void writePlaylist() const;
 
-    // 交织写入：按 DTS 归并两个 packet 队列写入文件
+    // convert 阶段：把队列项转换为录制分辨率的 YUV420P 帧（直通时不转换）
+    AVFrameRef convertQueuedVideo(const VideoQueueItem &item);
+    // 按源尺寸 / 格式（重新）创建到录制分辨率 YUV420P 的转换上下文
+    bool ensureSwsContext(SwsContext *&ctx, int srcWidth, int srcHeight,
+                          AVPixelFormat srcFormat);
+    // 从转换帧池取一块可写帧（编码器释放引用后复用）
+    AVFrame *acquireConvertFrame();
+    // 设置 PTS 后送入视频编码器，并收取 packet 入队
+    bool sendVideoFrame(const AVFrame *frame, qint64 timestampUs);
+    // 编码音频数据（单声道 float）
+    bool encodeAudioSamples(const float *samples, int sampleCount);
+
+    // 首次音频到达时初始化音频 PTS 起点（须持有 m_audioMutex）
+    void initAudioTimeLocked();
+    // 采样追加到 m_audioBuffer 后更新统计并唤醒音频编码线程（须持有 m_audioMutex）
+    void audioAppendedLocked();
+    // 收取编码器输出的全部 packet 放入交织器通道（flush 时传 nullptr 帧）
+    void drainEncoder(AVCodecContext *codecCtx, PacketLane lane);
+    // 编码器 flush 完成：关闭交织器通道并唤醒 mux
+    void finishLane(PacketLane lane);
+
+    // 交织写入：取出交织器中所有可写的 packet 写入文件（mux 线程）
     void writeInterleavedPackets();
-    // 收尾：将剩余 packets 合并排序后全部写入
-    void flushPacketQueues();
+    // 写入单个 packet 并释放（记录 mux 阶段统计）
+    void writeQueuedPacket(PacketInterleaver::Entry &queued);
     // 将 packet 的 DTS 转换为统一微秒时间（用于跨流比较）
     int64_t packetDtsInUs(const AVPacket *pkt) const;
 
@@ -116,35 +290,74 @@ private:
     std::atomic<int> m_durationSeconds{0};
     QString m_outputPath;
 
-    // 编码线程
-    QThread *m_encodingThread = nullptr;
+    // 输出容器模式（仅在未录制时修改）
+    bool m_fragmented = false;
+    int m_fragmentDurationMs = DEFAULT_FRAGMENT_DURATION_MS;
+    int m_segmentDurationSec = 0;
+    qint64 m_segmentMaxBytes = 0;
+    EncoderProfile m_encoderProfile;
+
+    // 分段状态（录制期间只由 mux 线程访问）
+    struct SegmentInfo
+    {
+        QString fileName;
+        double durationSeconds = 0.0;
+        qint64 bytes = 0;
+    };
+    QList<SegmentInfo> m_segments;
+    QString m_playlistPath;
+    QString m_currentOutputPath;
+    int m_segmentIndex = 0;
+    qint64 m_segmentTsOffsetUs = 0; // 本段时间戳起点（微秒）
+    qint64 m_segmentFirstUs = -1;   // 本段第一个 packet 的 DTS
+    qint64 m_segmentLastUs = -1;    // 本段最新 packet 的 DTS
+
+    // 流水线线程
+    QThread *m_convertThread = nullptr;
+    QThread *m_videoEncodeThread = nullptr;
+    QThread *m_audioEncodeThread = nullptr;
+    QThread *m_muxThread = nullptr;
 
-    // 线程安全的帧队列
-    QMutex m_videoMutex;
-    QQueue<QPair<QImage, qint64>> m_videoQueue;
+    // 队列容量：输入队列满时丢帧；编码队列满时阻塞 convert
+    static constexpr int VIDEO_QUEUE_CAPACITY = 16;
+    static constexpr int ENCODE_QUEUE_CAPACITY = 4;
+    static constexpr int STATS_LOG_INTERVAL_MS = 10000;
 
-    QMutex m_audioMutex;
-    QByteArray m_audioBuffer;
+    // convert 输入（合成帧）与 video encode 输入（YUV420P 帧）
+    BoundedQueue<VideoQueueItem> m_videoQueue{VIDEO_QUEUE_CAPACITY};
+    BoundedQueue<VideoQueueItem> m_encodeQueue{ENCODE_QUEUE_CAPACITY};
+    std::atomic<quint64> m_videoFramesDropped{0};
 
-    // 编码后的 Packet 队列（替代直接写文件）
-    QMutex m_packetMutex;
-    QQueue<AVPacket *> m_videoPackets;
-    QQueue<AVPacket *> m_audioPackets;
+    mutable QMutex m_audioMutex;
+    QWaitCondition m_audioCondition;
+    QByteArray m_audioBuffer;          // 待编码的单声道 float 采样
+    qint64 m_audioPendingSinceUs = -1; // m_audioBuffer 中最早数据的到达时间
+    int m_audioMaxDepth = 0;
 
-    // 写文件锁（保证 av_interleaved_write_frame 串行调用）
-    QMutex m_muxMutex;
+    // 编码后的 packet（两路编码线程写入，mux 线程按时间戳交织取出）。
+    // 一路静默超过 PACKET_LOOKAHEAD_US 后不再等它，排队内存有界；
+    // 文件只由 mux 线程写入，无需写文件锁
+    static constexpr qint64 PACKET_LOOKAHEAD_US = 2000000;
+    PacketInterleaver m_interleaver{LANE_COUNT};
+    QSemaphore m_muxWakeup; // 有新 packet / 通道结束时唤醒 mux
 
-    QWaitCondition m_encodeCondition;
-    QMutex m_conditionMutex;
+    // 各阶段延迟统计（排队 / 处理）
+    LatencyHistogram m_stageWait[STAGE_COUNT];
+    LatencyHistogram m_stageProcess[STAGE_COUNT];
 
-    // FFmpeg 上下文
+    // FFmpeg 上下文（录制期间输出上下文只由 mux 线程访问，分段时每段重建；
+    // 编码线程只使用编码器上下文，不读取 m_formatCtx）
+    const AVOutputFormat *m_outputFormat = nullptr;
     AVFormatContext *m_formatCtx = nullptr;
+    bool m_outputHeaderWritten = false;
 
     // 视频编码
     AVCodecContext *m_videoCodecCtx = nullptr;
-    AVStream *m_videoStream = nullptr;
-    SwsContext *m_swsCtx = nullptr;
-    AVFrame *m_videoFrame = nullptr;
+    AVCodecParameters *m_videoParams = nullptr; // 每个输出文件的视频流参数
+    SwsContext *m_swsCtx = nullptr;    // BGRA → YUV420P（按需创建，convert 线程）
+    SwsContext *m_yuvSwsCtx = nullptr; // YUV 输入尺寸不一致时缩放（按需创建）
+    std::vector<AVFrame *> m_convertFrames; // convert 输出帧池
+    AVFrame *m_sendFrame = nullptr;    // 引用队列中的帧送编码器（不拷贝）
     int64_t m_videoFrameCount = 0;
     int64_t m_lastVideoPts = -1; // 保证 PTS 严格单调递增
     int m_videoWidth = 1920;
@@ -154,14 +367,13 @@ private:
 
     // 音频编码
     AVCodecContext *m_audioCodecCtx = nullptr;
-    AVStream *m_audioStream = nullptr;
-    SwrContext *m_swrCtx = nullptr;
+    AVCodecParameters *m_audioParams = nullptr;
     AVFrame *m_audioFrame = nullptr;
     int64_t m_audioSampleCount = 0;
     int m_audioSampleRate = 48000;
     int m_audioFrameSize = 0; // AAC encoder 一帧的 sample 数
 
-    // 音频临时缓冲（积攒到 m_audioFrameSize 后送编码）
+    // 音频临时缓冲（float，积攒到 m_audioFrameSize 后送编码）
     QByteArray m_audioEncodeBuf;
 
     // 音视频同步：共享挂钟
@@ -0,0 +1,176 @@
+/**
+ * @file packetinterleaver.cpp
+ * @brief 按时间戳交织多路编码 packet 的无锁队列实现
+ */
+
+#include "packetinterleaver.h"
+#include <algorithm>
+
+namespace
+{
+size_t roundUpToPowerOfTwo(size_t v)
+{
+    size_t p = 1;
+    while (p < v)
+        p <<= 1;
+    return p;
+}
+} // namespace
+
+PacketInterleaver::PacketInterleaver(int laneCount, int minLaneCapacity)
+{
+    const size_t cap =
+        roundUpToPowerOfTwo(static_cast<size_t>(std::max(minLaneCapacity, 2)));
+    for (int i = 0; i < std::max(laneCount, 1); ++i)
+    {
+        auto lane = std::make_unique<Lane>();
+        lane->entries.resize(cap);
+        lane->mask = cap - 1;
+        m_lanes.push_back(std::move(lane));
+    }
+}
+
+PacketInterleaver::~PacketInterleaver()
+{
+    reset();
+}
+
+void PacketInterleaver::setMaxLookaheadUs(qint64 us)
+{
+    m_maxLookaheadUs.store(std::max<qint64>(us, 0), std::memory_order_relaxed);
+}
+
+qint64 PacketInterleaver::maxLookaheadUs() const
+{
+    return m_maxLookaheadUs.load(std::memory_order_relaxed);
+}
+
+bool PacketInterleaver::push(int lane, const Entry &entry)
+{
+    Lane &l = *m_lanes[lane];
+
+    // 生产者独占写索引，relaxed 读取即可；读索引需 acquire 以确认消费者已取走
+    const size_t w = l.writeIndex.load(std::memory_order_relaxed);
+    const size_t r = l.readIndex.load(std::memory_order_acquire);
+    if (w - r > l.mask)
+        return false;
+
+    l.entries[w & l.mask] = entry;
+    if (entry.dtsUs > l.newestDtsUs.load(std::memory_order_relaxed))
+        l.newestDtsUs.store(entry.dtsUs, std::memory_order_relaxed);
+    l.writeIndex.store(w + 1, std::memory_order_release);
+
+    const int depth = size();
+    int prev = m_maxDepth.load(std::memory_order_relaxed);
+    while (depth > prev &&
+           !m_maxDepth.compare_exchange_weak(prev, depth,
+                                             std::memory_order_relaxed))
+    {
+    }
+    return true;
+}
+
+void PacketInterleaver::finish(int lane)
+{
+    m_lanes[lane]->finished.store(true, std::memory_order_release);
+}
+
+bool PacketInterleaver::pop(Entry &entry)
+{
+    int best = -1;
+    qint64 bestDts = 0;
+    qint64 newestDts = std::numeric_limits<qint64>::min();
+    bool anyFull = false;
+    bool waitingOnLane = false; // 有通道既为空又未结束
+
+    for (size_t i = 0; i < m_lanes.size(); ++i)
+    {
+        Lane &l = *m_lanes[i];
+        // 先读 finished 再读写索引：finish() 之前入队的 packet 此时必然可见
+        const bool finished = l.finished.load(std::memory_order_acquire);
+        const size_t w = l.writeIndex.load(std::memory_order_acquire);
+        const size_t r = l.readIndex.load(std::memory_order_relaxed);
+        newestDts =
+            std::max(newestDts, l.newestDtsUs.load(std::memory_order_relaxed));
+
+        if (w == r)
+        {
+            if (!finished)
+                waitingOnLane = true;
+            continue;
+        }
+        if (w - r > l.mask)
+            anyFull = true;
+        const qint64 dts = l.entries[r & l.mask].dtsUs;
+        if (best < 0 || dts < bestDts)
+        {
+            best = static_cast<int>(i);
+            bestDts = dts;
+        }
+    }
+
+    if (best < 0)
+        return false;
+
+    // 空通道未结束时，只有落后水位线或有通道已满才不再等它
+    if (waitingOnLane && !anyFull &&
+        bestDts > newestDts - m_maxLookaheadUs.load(std::memory_order_relaxed))
+        return false;
+
+    Lane &l = *m_lanes[best];
+    const size_t r = l.readIndex.load(std::memory_order_relaxed);
+    entry = l.entries[r & l.mask];
+    l.entries[r & l.mask] = Entry();
+    l.readIndex.store(r + 1, std::memory_order_release);
+    return true;
+}
+
+bool PacketInterleaver::isDrained() const
+{
+    for (const auto &lane : m_lanes)
+    {
+        if (!lane->finished.load(std::memory_order_acquire))
+            return false;
+        if (lane->writeIndex.load(std::memory_order_acquire) !=
+            lane->readIndex.load(std::memory_order_acquire))
+            return false;
+    }
+    return true;
+}
+
+int PacketInterleaver::size() const
+{
+    size_t total = 0;
+    for (const auto &lane : m_lanes)
+    {
+        // 先读读索引：消费者只会追赶写索引，这样差值不会下溢
+        const size_t r = lane->readIndex.load(std::memory_order_acquire);
+        total += lane->writeIndex.load(std::memory_order_acquire) - r;
+    }
+    return static_cast<int>(total);
+}
+
+int PacketInterleaver::maxDepth() const
+{
+    return m_maxDepth.load(std::memory_order_relaxed);
+}
+
+void PacketInterleaver::reset()
+{
+    for (auto &lane : m_lanes)
+    {
+        const size_t w = lane->writeIndex.load(std::memory_order_acquire);
+        for (size_t r = lane->readIndex.load(std::memory_order_acquire); r != w;
+             ++r)
+        {
+            av_packet_free(&lane->entries[r & lane->mask].packet);
+        }
+        std::fill(lane->entries.begin(), lane->entries.end(), Entry());
+        lane->writeIndex.store(0, std::memory_order_relaxed);
+        lane->readIndex.store(0, std::memory_order_relaxed);
+        lane->newestDtsUs.store(std::numeric_limits<qint64>::min(),
+                                std::memory_order_relaxed);
+        lane->finished.store(false, std::memory_order_release);
+    }
+    m_maxDepth.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,108 @@
+/**
+ * @file packetinterleaver.h
+ * @brief 按时间戳交织多路编码 packet 的无锁队列
+ *
+ * MeetingRecorder 的视频 / 音频编码线程各自写入一条通道（lane），
+ * mux 线程按 DTS 从小到大取出写文件：
+ * 1. 每条通道是固定容量的 SPSC 环形缓冲区，运行期不分配内存，总内存有界
+ * 2. 取出最小 DTS 的队首 packet 需满足以下之一：
+ *    - 其余通道都有排队的 packet（队首 DTS 不会更小），或已结束
+ *    - 该 packet 比所有通道中最新的 DTS 早 maxLookahead 以上（水位线），
+ *      即空通道已沉默太久（麦克风静音、摄像头关闭），不再等它
+ *    - 某条通道已满（兜底，保证生产者不会被永久阻塞）
+ * 3. 读写索引为单调递增的原子计数器，生产者与消费者互不等待
+ *
+ * 线程约束：push()/finish() 对同一通道只能由同一个生产者线程调用，
+ * pop() 只能由同一个消费者线程调用；reset() 只能在没有生产者 / 消费者时调用。
+ */
+
+#ifndef PACKETINTERLEAVER_H
+#define PACKETINTERLEAVER_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+
+extern "C"
+{
+#include <libavcodec/packet.h>
+}
+
+class PacketInterleaver
+{
+public:
+    static constexpr int DEFAULT_LANE_CAPACITY = 512;
+    static constexpr qint64 DEFAULT_MAX_LOOKAHEAD_US = 2000000;
+
+    /** @brief 排队中的 packet（所有权随之转移） */
+    struct Entry
+    {
+        AVPacket *packet = nullptr;
+        qint64 dtsUs = 0;      // 统一到微秒的 DTS，用于跨通道比较
+        qint64 queuedAtUs = 0; // 入队时间（调用方时钟，用于排队时长统计）
+    };
+
+    /**
+     * @param laneCount 通道数（每路编码流一条）
+     * @param minLaneCapacity 每条通道的最小容量，实际容量向上取整到 2 的幂
+     */
+    explicit PacketInterleaver(int laneCount,
+                               int minLaneCapacity = DEFAULT_LANE_CAPACITY);
+    ~PacketInterleaver();
+
+    PacketInterleaver(const PacketInterleaver &) = delete;
+    PacketInterleaver &operator=(const PacketInterleaver &) = delete;
+
+    /** @brief 水位线：空通道最多等待多久（按 DTS 计），任意线程 */
+    void setMaxLookaheadUs(qint64 us);
+    qint64 maxLookaheadUs() const;
+
+    /**
+     * @brief 入队（仅该通道的生产者线程）
+     * @return 通道已满时返回 false，packet 所有权仍归调用方
+     */
+    bool push(int lane, const Entry &entry);
+
+    /** @brief 标记通道结束，之后不再阻塞其他通道（仅该通道的生产者线程） */
+    void finish(int lane);
+
+    /**
+     * @brief 取出下一个可写的 packet（仅消费者线程）
+     * @return 没有满足交织条件的 packet 时返回 false
+     */
+    bool pop(Entry &entry);
+
+    /** @brief 所有通道都已结束且已取空 */
+    bool isDrained() const;
+
+    /** @brief 当前排队 packet 总数 */
+    int size() const;
+
+    /** @brief reset() 以来的最大排队总数 */
+    int maxDepth() const;
+
+    /** @brief 释放残留 packet 并清空状态（仅在没有生产者 / 消费者时调用） */
+    void reset();
+
+private:
+    struct Lane
+    {
+        std::vector<Entry> entries;
+        size_t mask = 0;
+
+        // 读写索引分别位于独立的缓存行，避免生产者/消费者伪共享
+        alignas(64) std::atomic<size_t> writeIndex{0};
+        alignas(64) std::atomic<size_t> readIndex{0};
+        std::atomic<qint64> newestDtsUs{std::numeric_limits<qint64>::min()};
+        std::atomic<bool> finished{false};
+    };
+
+    std::vector<std::unique_ptr<Lane>> m_lanes;
+    std::atomic<qint64> m_maxLookaheadUs{DEFAULT_MAX_LOOKAHEAD_US};
+    std::atomic<int> m_maxDepth{0};
+};
+
+#endif // PACKETINTERLEAVER_H
@@ -30,6 +30,16 @@ void RemoteVideoRenderer::setExternalVideoSink(QVideoSink *sink)
   qDebug() << "[RemoteVideoRenderer] 设置外部视频 Sink:" << sink;
 }
 
+void RemoteVideoRenderer::setCompositorFrameSize(const QSize &size)
+{
+  QMutexLocker locker(&m_mutex);
+  if (m_compositorFrameSize == size)
+    return;
+  m_compositorFrameSize = size;
+  qDebug() << "[RemoteVideoRenderer] 合成器帧尺寸:" << size
+           << "participantId=" << m_participantId;
+}
+
 void RemoteVideoRenderer::clearExternalVideoSink()
 {
   QPointer<QVideoSink> sinkPointer;
@@ -171,9 +181,11 @@ void RemoteVideoRenderer::renderLoop()
       // 原代码持锁期间调用 setVideoFrame，与主线程的 setExternalVideoSink
       // 产生锁竞争，Qt 图形管线的回调也可能造成次生锁争抢，导致卡顿。
       QPointer<QVideoSink> sinkPointer;
+      QSize compositorSize;
       {
         QMutexLocker locker(&m_mutex);
         sinkPointer = m_externalSink;
+        compositorSize = m_compositorFrameSize;
       }
       if (sinkPointer)
       {
@@ -181,13 +193,30 @@ void RemoteVideoRenderer::renderLoop()
         sinkPointer->setVideoFrame(qtFrame);
       }
 
-      // 发出视频帧信号供 VideoCompositor 使用
+      // 发出视频帧信号供 VideoCompositor 使用：直接从 SDK 的 BGRA 缓冲
+      // 在本线程缩放到合成器单元格尺寸（面积平均），合成时无需再缩放；
+      // 合成器当前不显示本路时（尺寸为空）不供帧
+      const bool compositorHidden =
+          compositorSize.isValid() && compositorSize.isEmpty();
       if (!m_participantId.isEmpty())
       {
-        QImage image = qtFrame.toImage();
-        if (!image.isNull())
+        if (!compositorHidden)
         {
-          emit videoFrameReady(m_participantId, image);
+          const int width = event.frame.width();
+          const int height = event.frame.height();
+          const QImage view(event.frame.data(), width, height, width * 4,
+                            QImage::Format_ARGB32);
+          QImage image;
+          if (compositorSize.isValid() && (width > compositorSize.width() ||
+                                           height > compositorSize.height()))
+            image = view.scaled(compositorSize, Qt::KeepAspectRatio,
+                                Qt::SmoothTransformation);
+          else
+            image = view.copy(); // view 引用 SDK 缓冲，需深拷贝
+          if (!image.isNull())
+          {
+            emit videoFrameReady(m_participantId, image);
+          }
         }
       }
       else if (frameCount % 100 == 1)
@@ -82,6 +82,14 @@ public:
    */
   bool isRunning() const { return m_running.load(); }
 
+  /**
+   * @brief 设置发给 VideoCompositor 的帧尺寸（线程安全）
+   * @param size 合成器单元格尺寸：有效时 videoFrameReady 输出等比缩放到
+   *        该尺寸以内的帧；QSize(0, 0) 表示合成器不需要本路画面，暂停供帧；
+   *        无效 QSize 表示输出原始分辨率
+   */
+  void setCompositorFrameSize(const QSize &size);
+
 signals:
   void frameReady();
   void errorOccurred(const QString &error);
@@ -111,6 +119,9 @@ private:
   // 使用 QPointer 避免悬垂指针，当 QML VideoSink 销毁时自动变为 null
   QPointer<QVideoSink> m_externalSink;
 
+  // 合成器单元格尺寸（受 m_mutex 保护）
+  QSize m_compositorFrameSize;
+
   // 状态
   std::atomic<bool> m_running{false};
   QString m_participantId;
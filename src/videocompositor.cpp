@@ -6,20 +6,123 @@
 #include "videocompositor.h"
 #include <QDebug>
 #include <QPainter>
+#include <QThread>
 #include <QFont>
+#include <QtConcurrent/QtConcurrentMap>
 #include <cmath>
+#include <cstring>
+#include <utility>
+
+extern "C"
+{
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+namespace
+{
+// BT.601 limited range（与 libswscale 对 YUV420P 的默认转换一致）
+inline uint8_t rgbToY(int r, int g, int b)
+{
+    return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+inline uint8_t rgbToU(int r, int g, int b)
+{
+    return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) +
+                                128);
+}
+inline uint8_t rgbToV(int r, int g, int b)
+{
+    return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) +
+                                128);
+}
+
+inline uint8_t clampByte(int value)
+{
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// 用纯色填充 YUV420P 帧的 rect 区域（rect 按偶数像素对齐）
+void fillYuvRect(AVFrame *frame, const QRect &rect, const QColor &color)
+{
+    if (rect.isEmpty())
+        return;
+    const int r = color.red(), g = color.green(), b = color.blue();
+    const uint8_t values[3] = {rgbToY(r, g, b), rgbToU(r, g, b),
+                               rgbToV(r, g, b)};
+    for (int plane = 0; plane < 3; ++plane)
+    {
+        const int shift = plane == 0 ? 0 : 1;
+        const int x = rect.x() >> shift;
+        const int w = (rect.width() + shift) >> shift;
+        const int y0 = rect.y() >> shift;
+        const int y1 = (rect.y() + rect.height() + shift) >> shift;
+        for (int y = y0; y < y1; ++y)
+            std::memset(frame->data[plane] + y * frame->linesize[plane] + x,
+                        values[plane], static_cast<size_t>(w));
+    }
+}
+
+// 用纯色填充整个 YUV420P 帧
+void fillYuv(AVFrame *frame, const QColor &color)
+{
+    fillYuvRect(frame, QRect(0, 0, frame->width, frame->height), color);
+}
+
+// QImage 像素格式 → libswscale 源格式；不直接支持的格式返回 AV_PIX_FMT_NONE
+AVPixelFormat swsSourceFormat(QImage::Format format)
+{
+    switch (format)
+    {
+    // ARGB32 / RGB32 在内存中实际上是 BGRA（小端），源帧不透明时
+    // premultiplied 与非 premultiplied 相同
+    case QImage::Format_ARGB32:
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        return AV_PIX_FMT_BGRA;
+    case QImage::Format_RGB888:
+        return AV_PIX_FMT_RGB24;
+    case QImage::Format_RGBX8888:
+    case QImage::Format_RGBA8888:
+        return AV_PIX_FMT_RGBA;
+    case QImage::Format_Grayscale8:
+        return AV_PIX_FMT_GRAY8;
+    default:
+        return AV_PIX_FMT_NONE;
+    }
+}
+} // namespace
+
+// 帧率优先下调（对观感影响较小），其次降低分辨率
+const VideoCompositor::QualityTier VideoCompositor::QUALITY_TIERS[] = {
+    {1920, 1080, 30}, {1920, 1080, 20}, {1280, 720, 20},
+    {1280, 720, 15},  {960, 540, 15},   {640, 360, 10},
+};
 
 VideoCompositor::VideoCompositor(QObject *parent) : QObject(parent)
 {
     m_timer = new QTimer(this);
     m_timer->setTimerType(Qt::PreciseTimer);
     connect(m_timer, &QTimer::timeout, this, &VideoCompositor::onTimer);
-    qDebug() << "[VideoCompositor] 初始化完成";
+
+    m_renderPool.setObjectName(QStringLiteral("VideoCompositorRender"));
+    m_renderPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+    m_startTime = std::chrono::steady_clock::now();
+    applyQualityLevelLocked(0);
+
+    qDebug() << "[VideoCompositor] 初始化完成, 绘制线程:"
+             << m_renderPool.maxThreadCount();
 }
 
 VideoCompositor::~VideoCompositor()
 {
     stop();
+    for (auto it = m_frames.begin(); it != m_frames.end(); ++it)
+        releaseScaler(it.value());
+    av_frame_free(&m_yuvCanvas);
+    for (AVFrame *frame : m_yuvPool)
+        av_frame_free(&frame);
+    m_yuvPool.clear();
     qDebug() << "[VideoCompositor] 销毁";
 }
 
@@ -29,8 +132,13 @@ void VideoCompositor::start()
         return;
     m_running = true;
     m_startTime = std::chrono::steady_clock::now();
-    m_timer->start(1000 / OUTPUT_FPS);
-    qDebug() << "[VideoCompositor] 开始合成, FPS:" << OUTPUT_FPS;
+
+    const int width = outputWidth();
+    const int height = outputHeight();
+    const int fps = outputFps();
+    m_timer->start(1000 / fps);
+    qDebug() << "[VideoCompositor] 开始合成:" << width << "x" << height << "@"
+             << fps << "fps";
 }
 
 void VideoCompositor::stop()
@@ -39,7 +147,438 @@ void VideoCompositor::stop()
         return;
     m_running = false;
     m_timer->stop();
-    qDebug() << "[VideoCompositor] 停止合成";
+    qDebug() << "[VideoCompositor] 停止合成, 重绘单元格:" << tilesRenderedCount()
+             << "跳过:" << tilesSkippedCount()
+             << "帧池耗尽跳过帧:" << framesSkippedCount();
+    const auto dropped = droppedFrameCounts();
+    for (auto it = dropped.cbegin(); it != dropped.cend(); ++it)
+    {
+        if (it.value() > 0)
+            qDebug() << "[VideoCompositor] 合成前丢弃帧:" << it.key() << it.value();
+    }
+
+    // 下次开始（及录制器初始化）从设置值起步，自适应再按实际负载调整
+    bool changed = false;
+    QualityTier geometry;
+    {
+        QMutexLocker locker(&m_mutex);
+        changed = applyQualityLevelLocked(0);
+        geometry = m_current;
+        m_overBudgetTicks = 0;
+        m_underBudgetTicks = 0;
+    }
+    if (changed)
+        emit outputGeometryChanged(geometry.width, geometry.height,
+                                   geometry.fps);
+}
+
+void VideoCompositor::setOutputFormat(OutputFormat format)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_outputFormat == format)
+        return;
+    m_outputFormat = format;
+    m_fullRedraw = true; // 新格式的画布需要完整生成一次
+    qDebug() << "[VideoCompositor] 输出格式:"
+             << (format == OutputFormat::Yuv420p ? "YUV420P" : "ARGB32");
+}
+
+VideoCompositor::OutputFormat VideoCompositor::outputFormat() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_outputFormat;
+}
+
+void VideoCompositor::setLayoutMode(LayoutMode mode)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_layoutMode == mode)
+        return;
+    m_layoutMode = mode;
+    invalidateLayoutLocked();
+    qDebug() << "[VideoCompositor] 布局:" << static_cast<int>(mode);
+}
+
+VideoCompositor::LayoutMode VideoCompositor::layoutMode() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_layoutMode;
+}
+
+void VideoCompositor::setPinnedParticipant(const QString &participantId)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_pinnedId == participantId)
+        return;
+    m_pinnedId = participantId;
+    if (m_layoutMode == LayoutMode::Pinned)
+        invalidateLayoutLocked();
+}
+
+QString VideoCompositor::pinnedParticipant() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pinnedId;
+}
+
+void VideoCompositor::setPageSize(int size)
+{
+    QMutexLocker locker(&m_mutex);
+    size = qMax(1, size);
+    if (m_pageSize == size)
+        return;
+    m_pageSize = size;
+    if (m_layoutMode == LayoutMode::Paginated)
+        invalidateLayoutLocked();
+}
+
+int VideoCompositor::pageSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pageSize;
+}
+
+void VideoCompositor::setPage(int page)
+{
+    QMutexLocker locker(&m_mutex);
+    const int pages = qMax(1, (static_cast<int>(m_frames.size()) + m_pageSize - 1) /
+                                  m_pageSize);
+    page = qBound(0, page, pages - 1);
+    if (m_page == page)
+        return;
+    m_page = page;
+    if (m_layoutMode == LayoutMode::Paginated)
+        invalidateLayoutLocked();
+}
+
+int VideoCompositor::page() const
+{
+    QMutexLocker locker(&m_mutex);
+    const int pages = qMax(1, (static_cast<int>(m_frames.size()) + m_pageSize - 1) /
+                                  m_pageSize);
+    return qMin(m_page, pages - 1);
+}
+
+int VideoCompositor::pageCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return qMax(1, (static_cast<int>(m_frames.size()) + m_pageSize - 1) /
+                       m_pageSize);
+}
+
+void VideoCompositor::setActiveSpeakers(const QStringList &participantIds)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // 没有人说话时保持上一位说话人，避免主画面来回跳
+    QStringList speakers;
+    for (const QString &id : participantIds)
+    {
+        const QString tileId = resolveTileIdLocked(id);
+        if (!tileId.isEmpty() && !speakers.contains(tileId))
+            speakers.append(tileId);
+    }
+    if (speakers.isEmpty())
+        return;
+
+    // 最近发言顺序：本次说话人按电平顺序排到最前
+    for (auto it = speakers.crbegin(); it != speakers.crend(); ++it)
+    {
+        m_recentSpeakers.removeAll(*it);
+        m_recentSpeakers.prepend(*it);
+    }
+    while (m_recentSpeakers.size() > FILMSTRIP_MAX * 4)
+        m_recentSpeakers.removeLast();
+
+    // 只有主画面换人时才重新布局（侧栏顺序随下次布局更新）
+    if (speakers.first() != m_speakerFocus)
+    {
+        m_speakerFocus = speakers.first();
+        if (m_layoutMode == LayoutMode::Speaker)
+            invalidateLayoutLocked();
+    }
+}
+
+QString VideoCompositor::resolveTileIdLocked(const QString &id) const
+{
+    if (id.isEmpty())
+        return QString();
+    if (m_frames.contains(id))
+        return id;
+
+    // 参会者 identity → 画面标识（优先摄像头）
+    const QString camera = id + QStringLiteral("::camera");
+    if (m_frames.contains(camera))
+        return camera;
+    const QString screen = id + QStringLiteral("::screen");
+    if (m_frames.contains(screen))
+        return screen;
+    return QString();
+}
+
+void VideoCompositor::invalidateLayoutLocked()
+{
+    m_layout.clear();
+    m_lastParticipantCount = 0;
+    m_fullRedraw = true;
+}
+
+void VideoCompositor::setOutputGeometry(int width, int height, int fps)
+{
+    // YUV420P 要求偶数宽高
+    width = qMax(16, width & ~1);
+    height = qMax(16, height & ~1);
+    fps = qBound(1, fps, 60);
+
+    bool changed = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_configured = {width, height, fps};
+        changed = applyQualityLevelLocked(0);
+        m_overBudgetTicks = 0;
+        m_underBudgetTicks = 0;
+    }
+
+    qDebug() << "[VideoCompositor] 输出设置:" << width << "x" << height << "@"
+             << fps << "fps";
+    if (changed)
+        emit outputGeometryChanged(width, height, fps);
+}
+
+int VideoCompositor::outputWidth() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_current.width;
+}
+
+int VideoCompositor::outputHeight() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_current.height;
+}
+
+int VideoCompositor::outputFps() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_current.fps;
+}
+
+void VideoCompositor::setAdaptiveQuality(bool enabled)
+{
+    bool changed = false;
+    QualityTier geometry;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_adaptive == enabled)
+            return;
+        m_adaptive = enabled;
+        // 关闭时恢复设置值
+        if (!enabled)
+            changed = applyQualityLevelLocked(0);
+        geometry = m_current;
+    }
+    qDebug() << "[VideoCompositor] 自适应质量:" << enabled;
+    if (changed)
+        emit outputGeometryChanged(geometry.width, geometry.height,
+                                   geometry.fps);
+}
+
+bool VideoCompositor::isAdaptiveQuality() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_adaptive;
+}
+
+void VideoCompositor::setAdaptiveResolution(bool enabled)
+{
+    bool changed = false;
+    QualityTier geometry;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_adaptiveResolution == enabled)
+            return;
+        m_adaptiveResolution = enabled;
+        changed = applyQualityLevelLocked(0);
+        m_overBudgetTicks = 0;
+        m_underBudgetTicks = 0;
+        geometry = m_current;
+    }
+    qDebug() << "[VideoCompositor] 自适应分辨率:" << enabled;
+    if (changed)
+        emit outputGeometryChanged(geometry.width, geometry.height,
+                                   geometry.fps);
+}
+
+bool VideoCompositor::isAdaptiveResolution() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_adaptiveResolution;
+}
+
+qint64 VideoCompositor::averageTickCostUs() const
+{
+    return m_avgTickCostUs.load(std::memory_order_relaxed);
+}
+
+bool VideoCompositor::applyQualityLevelLocked(int level)
+{
+    // 阶梯：[0] 为设置值，之后是不高于设置值、像素率严格更低的档位
+    m_qualityLadder.clear();
+    m_qualityLadder.push_back(m_configured);
+    const qint64 configuredRate = static_cast<qint64>(m_configured.width) *
+                                  m_configured.height * m_configured.fps;
+    for (const QualityTier &tier : QUALITY_TIERS)
+    {
+        // 不允许降分辨率：只取更低的帧率，尺寸保持设置值
+        if (!m_adaptiveResolution)
+        {
+            if (tier.fps < m_qualityLadder.back().fps)
+                m_qualityLadder.push_back(
+                    {m_configured.width, m_configured.height, tier.fps});
+            continue;
+        }
+
+        const qint64 rate =
+            static_cast<qint64>(tier.width) * tier.height * tier.fps;
+        if (tier.width <= m_configured.width &&
+            tier.height <= m_configured.height &&
+            tier.fps <= m_configured.fps && rate < configuredRate)
+        {
+            m_qualityLadder.push_back(tier);
+        }
+    }
+
+    m_qualityLevel =
+        qBound(0, level, static_cast<int>(m_qualityLadder.size()) - 1);
+    const QualityTier &tier = m_qualityLadder[m_qualityLevel];
+    if (tier.width == m_current.width && tier.height == m_current.height &&
+        tier.fps == m_current.fps)
+    {
+        return false;
+    }
+
+    const bool resized =
+        tier.width != m_current.width || tier.height != m_current.height;
+    m_current = tier;
+    if (resized)
+    {
+        // 画布尺寸变化：重新布局并整帧重绘
+        invalidateLayoutLocked();
+    }
+    return true;
+}
+
+void VideoCompositor::updateAdaptiveQuality(qint64 costUs)
+{
+    // 指数滑动平均（α = 1/8）
+    qint64 avg = m_avgTickCostUs.load(std::memory_order_relaxed);
+    avg = avg == 0 ? costUs : avg + (costUs - avg) / 8;
+    m_avgTickCostUs.store(avg, std::memory_order_relaxed);
+
+    bool changed = false;
+    QualityTier geometry;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_adaptive)
+            return;
+
+        const qint64 budgetUs =
+            1000000 / m_current.fps * ADAPTIVE_BUDGET_PERCENT / 100;
+        if (avg > budgetUs)
+        {
+            ++m_overBudgetTicks;
+            m_underBudgetTicks = 0;
+        }
+        else if (avg < budgetUs / 3)
+        {
+            ++m_underBudgetTicks;
+            m_overBudgetTicks = 0;
+        }
+        else
+        {
+            m_overBudgetTicks = 0;
+            m_underBudgetTicks = 0;
+        }
+
+        int level = m_qualityLevel;
+        if (m_overBudgetTicks >= ADAPTIVE_DOWN_TICKS &&
+            level + 1 < static_cast<int>(m_qualityLadder.size()))
+        {
+            ++level;
+        }
+        else if (m_underBudgetTicks >= ADAPTIVE_UP_TICKS && level > 0)
+        {
+            --level;
+        }
+        if (level == m_qualityLevel)
+            return;
+
+        m_overBudgetTicks = 0;
+        m_underBudgetTicks = 0;
+        changed = applyQualityLevelLocked(level);
+        geometry = m_current;
+        qDebug() << "[VideoCompositor] 自适应调整到第" << m_qualityLevel
+                 << "档:" << geometry.width << "x" << geometry.height << "@"
+                 << geometry.fps << "fps, 平均耗时:" << avg
+                 << "us, 预算:" << budgetUs << "us";
+    }
+
+    if (changed)
+        emit outputGeometryChanged(geometry.width, geometry.height,
+                                   geometry.fps);
+}
+
+void VideoCompositor::setRenderThreadCount(int count)
+{
+    m_renderPool.setMaxThreadCount(qMax(1, count));
+}
+
+int VideoCompositor::renderThreadCount() const
+{
+    return m_renderPool.maxThreadCount();
+}
+
+quint64 VideoCompositor::tilesRenderedCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_tilesRendered;
+}
+
+quint64 VideoCompositor::tilesSkippedCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_tilesSkipped;
+}
+
+void VideoCompositor::setFramePoolSize(int size)
+{
+    m_framePoolSize.store(qMax(2, size));
+}
+
+int VideoCompositor::framePoolSize() const
+{
+    return m_framePoolSize.load();
+}
+
+quint64 VideoCompositor::framesSkippedCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_framesSkipped;
+}
+
+QSize VideoCompositor::tileSize(const QString &participantId) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_tileSizes.value(participantId);
+}
+
+QMap<QString, quint64> VideoCompositor::droppedFrameCounts() const
+{
+    QMutexLocker locker(&m_mutex);
+    QMap<QString, quint64> counts;
+    for (auto it = m_frames.cbegin(); it != m_frames.cend(); ++it)
+        counts.insert(it.key(), it.value().droppedFrames);
+    return counts;
 }
 
 void VideoCompositor::feedFrame(const QString &participantId,
@@ -51,167 +590,763 @@ void VideoCompositor::feedFrame(const QString &participantId,
 
     QMutexLocker locker(&m_mutex);
     auto &pf = m_frames[participantId];
-    // 统一转为 ARGB32 方便绘制
-    if (frame.format() != QImage::Format_ARGB32)
-        pf.lastFrame = frame.convertToFormat(QImage::Format_ARGB32);
-    else
-        pf.lastFrame = frame;
-    if (!displayName.isEmpty())
+    // 上一帧还没被合成就被覆盖：计入丢弃（不做任何像素处理）
+    if (pf.frameSeq != pf.renderedSeq)
+        ++pf.droppedFrames;
+    // 只保存引用，转换和缩放推迟到合成时（只处理真正用到的帧）
+    pf.lastFrame = frame;
+    ++pf.frameSeq;
+    if (!displayName.isEmpty() && displayName != pf.displayName)
+    {
         pf.displayName = displayName;
+        pf.dirty = true; // 标签变化，需重绘
+    }
 }
 
 void VideoCompositor::removeParticipant(const QString &participantId)
 {
     QMutexLocker locker(&m_mutex);
-    m_frames.remove(participantId);
-    m_layout.clear(); // 触发重新布局
-    m_lastParticipantCount = 0;
+    auto it = m_frames.find(participantId);
+    if (it != m_frames.end())
+    {
+        releaseScaler(it.value());
+        m_frames.erase(it);
+    }
+    m_recentSpeakers.removeAll(participantId);
+    invalidateLayoutLocked(); // 触发重新布局
     qDebug() << "[VideoCompositor] 移除参会者:" << participantId;
 }
 
+void VideoCompositor::releaseScaler(ParticipantFrame &pf)
+{
+    sws_freeContext(pf.yuvScaler);
+    pf.yuvScaler = nullptr;
+}
+
+void VideoCompositor::returnJobScalersLocked()
+{
+    for (TileJob &job : m_jobs)
+    {
+        if (!job.scaler)
+            continue;
+        auto it = m_frames.find(job.participantId);
+        if (it != m_frames.end() && !it.value().yuvScaler)
+            std::swap(it.value().yuvScaler, job.scaler);
+        sws_freeContext(job.scaler);
+        job.scaler = nullptr;
+    }
+}
+
 void VideoCompositor::onTimer()
 {
+    compositeNow();
+
+    // 帧率可能被设置或自适应调整
+    const int interval = 1000 / outputFps();
+    if (m_timer->interval() != interval)
+        m_timer->setInterval(interval);
+}
+
+void VideoCompositor::compositeNow()
+{
+    const auto tickStart = std::chrono::steady_clock::now();
+
+    // ---- 持锁：更新布局并快照需要重绘的单元格 ----
     QMutexLocker locker(&m_mutex);
 
+    const QSize canvasSize(m_current.width, m_current.height);
+
     const int n = m_frames.size();
-    if (n == 0)
-    {
-        // 没有任何参会者帧，输出黑画面
-        QImage black(OUTPUT_WIDTH, OUTPUT_HEIGHT, QImage::Format_ARGB32);
-        black.fill(Qt::black);
-        auto now = std::chrono::steady_clock::now();
-        qint64 ts = std::chrono::duration_cast<std::chrono::microseconds>(
-                        now - m_startTime)
-                        .count();
-        locker.unlock();
-        emit compositeFrameReady(black, ts);
-        return;
-    }
 
-    // 重新计算布局（仅在参会者数量变化时）
-    if (n != m_lastParticipantCount)
+    // 重新计算布局（仅在参会者数量变化时），并收集需要通知生产者的尺寸变化
+    std::vector<std::pair<QString, QSize>> tileSizeChanges;
+    if (n > 0 && n != m_lastParticipantCount)
     {
         recalcLayout();
         m_lastParticipantCount = n;
+
+        for (auto it = m_frames.cbegin(); it != m_frames.cend(); ++it)
+        {
+            auto cellIt = m_layout.constFind(it.key());
+            const QSize size = cellIt == m_layout.constEnd()
+                                   ? QSize(0, 0)
+                                   : cellIt.value().size();
+            auto sizeIt = m_tileSizes.find(it.key());
+            if (sizeIt == m_tileSizes.end() || sizeIt.value() != size)
+            {
+                m_tileSizes.insert(it.key(), size);
+                tileSizeChanges.emplace_back(it.key(), size);
+            }
+        }
+        for (auto it = m_tileSizes.begin(); it != m_tileSizes.end();)
+        {
+            if (m_frames.contains(it.key()))
+                ++it;
+            else
+                it = m_tileSizes.erase(it);
+        }
     }
 
-    // 创建画布
-    QImage canvas(OUTPUT_WIDTH, OUTPUT_HEIGHT, QImage::Format_ARGB32);
-    canvas.fill(QColor(26, 26, 46)); // 匹配 UI 背景色 #1A1A2E
+    const bool yuvOutput = m_outputFormat == OutputFormat::Yuv420p;
+    const bool fullRedraw =
+        m_fullRedraw ||
+        (yuvOutput ? (!m_yuvCanvas || m_yuvCanvas->width != canvasSize.width() ||
+                      m_yuvCanvas->height != canvasSize.height())
+                   : m_canvas.size() != canvasSize);
 
-    QPainter painter(&canvas);
-    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    // 需要重绘但帧池已耗尽（下游积压）：跳过本次 tick，不增长内存；
+    // 脏状态原样保留，帧池有空闲后的第一个 tick 补画
+    if (!outputBufferAvailable(canvasSize, yuvOutput))
+    {
+        bool needsDraw = fullRedraw;
+        for (auto it = m_layout.cbegin(); !needsDraw && it != m_layout.cend();
+             ++it)
+        {
+            auto frameIt = m_frames.constFind(it.key());
+            needsDraw = frameIt != m_frames.cend() &&
+                        (frameIt->dirty || frameIt->renderedSeq != frameIt->frameSeq);
+        }
+        if (needsDraw)
+        {
+            if (m_framesSkipped++ % 100 == 0)
+            {
+                qWarning() << "[VideoCompositor] 帧池耗尽，跳过合成帧, 累计:"
+                           << m_framesSkipped;
+            }
+            locker.unlock();
+            for (const auto &change : tileSizeChanges)
+                emit tileSizeChanged(change.first, change.second);
+            return;
+        }
+    }
+    m_fullRedraw = false;
 
-    // 绘制每个参会者的画面
-    for (auto it = m_frames.constBegin(); it != m_frames.constEnd(); ++it)
+    for (auto it = m_frames.begin(); it != m_frames.end(); ++it)
     {
-        const QString &pid = it.key();
-        const ParticipantFrame &pf = it.value();
+        ParticipantFrame &pf = it.value();
 
-        if (!m_layout.contains(pid))
+        auto cellIt = m_layout.constFind(it.key());
+        if (cellIt == m_layout.constEnd())
             continue;
 
-        const QRect &cell = m_layout[pid];
+        // 只重绘有新帧或标脏的单元格（布局变化时全部重绘）
+        if (!fullRedraw && !pf.dirty && pf.renderedSeq == pf.frameSeq)
+        {
+            ++m_tilesSkipped;
+            continue;
+        }
+
+        // 名称或单元格宽度变化时缓存失效，由工作线程重新渲染
+        const QRect &cell = cellIt.value();
+        QImage label;
+        if (pf.labelName == pf.displayName && pf.label.width() == cell.width())
+            label = pf.label;
+        // YUV 输出：缩放上下文在绘制期间归任务独占（参会者可能同时被移除）
+        SwsContext *scaler = nullptr;
+        if (yuvOutput)
+            std::swap(scaler, pf.yuvScaler);
+        m_jobs.push_back({it.key(), cell, pf.lastFrame, pf.displayName, label,
+                          false, scaler});
+        pf.renderedSeq = pf.frameSeq;
+        pf.dirty = false;
+        ++m_tilesRendered;
+    }
 
-        if (!pf.lastFrame.isNull())
+    auto now = std::chrono::steady_clock::now();
+    qint64 ts = std::chrono::duration_cast<std::chrono::microseconds>(
+                    now - m_startTime)
+                    .count();
+
+    locker.unlock();
+
+    for (const auto &change : tileSizeChanges)
+        emit tileSizeChanged(change.first, change.second);
+
+    // ---- 锁外：绘制（画布只在合成线程访问）----
+    if (yuvOutput)
+    {
+        // YUV 输出不使用 ARGB 画布，释放其内存（下游仍持有的引用不受影响）
+        if (!m_canvas.isNull())
         {
-            // 等比缩放填充到单元格
-            QImage scaled = pf.lastFrame.scaled(cell.size(), Qt::KeepAspectRatio,
-                                                Qt::SmoothTransformation);
-            // 居中绘制
-            int dx = cell.x() + (cell.width() - scaled.width()) / 2;
-            int dy = cell.y() + (cell.height() - scaled.height()) / 2;
+            m_canvas = QImage();
+            m_canvasPool.clear();
+        }
+    }
+    else if (m_canvas.size() != canvasSize)
+    {
+        // 旧尺寸的画布不再复用（下游仍持有的引用不受影响）
+        m_canvas = QImage(canvasSize, QImage::Format_ARGB32);
+        m_canvasPool.clear();
+    }
 
-            // 先画黑底（letterbox）
-            painter.fillRect(cell, Qt::black);
-            painter.drawImage(dx, dy, scaled);
+    // 输出尺寸变化：旧尺寸的 YUV 帧不再复用（下游仍持有的引用不受影响）
+    if (m_yuvCanvas && (m_yuvCanvas->width != canvasSize.width() ||
+                        m_yuvCanvas->height != canvasSize.height()))
+    {
+        av_frame_free(&m_yuvCanvas);
+        for (AVFrame *frame : m_yuvPool)
+            av_frame_free(&frame);
+        m_yuvPool.clear();
+    }
+
+    // 输出缓冲被下游（编码器队列）持有时换一块空闲缓冲，避免改写 / 隐式共享分离
+    const bool drawing = fullRedraw || !m_jobs.empty();
+    const bool writable = !drawing || (yuvOutput
+                                           ? ensureYuvCanvasWritable(canvasSize)
+                                           : ensureCanvasWritable());
+    if (!writable)
+    {
+        QMutexLocker scalerLocker(&m_mutex);
+        returnJobScalersLocked();
+        m_jobs.clear();
+        return;
+    }
+    AVFrame *yuv = yuvOutput ? m_yuvCanvas : nullptr;
+
+    if (fullRedraw)
+    {
+        // 没有任何参会者时输出黑画面
+        const QColor background = n == 0 ? QColor(Qt::black)
+                                         : QColor(26, 26, 46); // UI 背景色 #1A1A2E
+        if (yuv)
+            fillYuv(yuv, background);
+        else
+            m_canvas.fill(background);
+    }
+
+    if (!m_jobs.empty())
+    {
+        // 画布被下游持有时 bits() 先在本线程完成分离拷贝，
+        // 工作线程只通过裸指针写各自区域
+        uchar *bits = yuv ? nullptr : m_canvas.bits();
+        const qsizetype bpl = yuv ? 0 : m_canvas.bytesPerLine();
+        const QRect bounds(QPoint(0, 0), canvasSize);
+
+        auto render = [bits, bpl, bounds, yuv](TileJob &job)
+        {
+            if (yuv)
+                renderTileYuv(yuv, bounds, job);
+            else
+                renderTile(bits, bpl, bounds, job);
+        };
+
+        if (m_jobs.size() == 1 || m_renderPool.maxThreadCount() <= 1)
+        {
+            for (TileJob &job : m_jobs)
+                render(job);
         }
         else
         {
-            painter.fillRect(cell, Qt::black);
+            QtConcurrent::blockingMap(&m_renderPool, m_jobs, render);
         }
 
-        // 绘制名称标签
-        if (!pf.displayName.isEmpty())
+        // 新渲染的标签与缩放上下文写回参会者（参会者可能已离开或改名，需重新核对）
+        QMutexLocker cacheLocker(&m_mutex);
+        for (TileJob &job : m_jobs)
         {
-            drawNameLabel(painter, cell, pf.displayName);
+            if (!job.labelRendered)
+                continue;
+            auto it = m_frames.find(job.participantId);
+            if (it != m_frames.end() && it.value().displayName == job.name)
+            {
+                it.value().label = job.label;
+                it.value().labelName = job.name;
+            }
         }
+        returnJobScalersLocked();
     }
 
-    painter.end();
+    // 释放对源帧的引用，保留容量供下一帧复用
+    m_jobs.clear();
 
-    auto now = std::chrono::steady_clock::now();
-    qint64 ts = std::chrono::duration_cast<std::chrono::microseconds>(
-                    now - m_startTime)
-                    .count();
+    const qint64 costUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now() - tickStart)
+                              .count();
 
-    locker.unlock();
-    emit compositeFrameReady(canvas, ts);
+    if (yuvOutput)
+    {
+        if (m_yuvCanvas)
+            emit compositeYuvFrameReady(makeAVFrameRef(m_yuvCanvas), ts);
+    }
+    else
+    {
+        emit compositeFrameReady(m_canvas, ts);
+    }
+
+    updateAdaptiveQuality(costUs);
+}
+
+AVFrame *VideoCompositor::allocYuvFrame(int width, int height)
+{
+    AVFrame *frame = av_frame_alloc();
+    if (!frame)
+        return nullptr;
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = width;
+    frame->height = height;
+    frame->colorspace = AVCOL_SPC_BT470BG;
+    frame->color_range = AVCOL_RANGE_MPEG;
+    if (av_frame_get_buffer(frame, 0) < 0)
+    {
+        av_frame_free(&frame);
+        return nullptr;
+    }
+    return frame;
+}
+
+bool VideoCompositor::ensureYuvCanvasWritable(const QSize &canvasSize)
+{
+    if (!m_yuvCanvas)
+    {
+        m_yuvCanvas = allocYuvFrame(canvasSize.width(), canvasSize.height());
+        return m_yuvCanvas != nullptr;
+    }
+    if (av_frame_is_writable(m_yuvCanvas))
+        return true;
+
+    // 当前画布仍被下游引用：找一块已被释放的帧，没有则新分配
+    AVFrame *next = nullptr;
+    for (auto it = m_yuvPool.begin(); it != m_yuvPool.end(); ++it)
+    {
+        if (av_frame_is_writable(*it))
+        {
+            next = *it;
+            m_yuvPool.erase(it);
+            break;
+        }
+    }
+    if (!next)
+    {
+        // 帧池已满：由调用方跳过本帧
+        if (static_cast<int>(m_yuvPool.size()) + 1 >= m_framePoolSize.load())
+            return false;
+        next = allocYuvFrame(canvasSize.width(), canvasSize.height());
+        if (!next)
+        {
+            qWarning() << "[VideoCompositor] YUV 帧分配失败";
+            return false;
+        }
+    }
+
+    // 增量合成：未变化的单元格沿用上一帧内容
+    av_frame_copy(next, m_yuvCanvas);
+    m_yuvPool.push_back(m_yuvCanvas);
+    m_yuvCanvas = next;
+    return true;
+}
+
+bool VideoCompositor::ensureCanvasWritable()
+{
+    if (m_canvas.isDetached())
+        return true;
+
+    // 当前画布仍被下游引用：找一块已被释放的画布，没有则在上限内新分配
+    QImage next;
+    for (auto it = m_canvasPool.begin(); it != m_canvasPool.end(); ++it)
+    {
+        if (it->isDetached())
+        {
+            next = std::move(*it);
+            m_canvasPool.erase(it);
+            break;
+        }
+    }
+    if (next.isNull())
+    {
+        if (static_cast<int>(m_canvasPool.size()) + 1 >= m_framePoolSize.load())
+            return false;
+        next = QImage(m_canvas.size(), QImage::Format_ARGB32);
+        if (next.isNull())
+        {
+            qWarning() << "[VideoCompositor] 画布分配失败";
+            return false;
+        }
+    }
+
+    // 增量合成：未变化的单元格沿用上一帧内容
+    std::memcpy(next.bits(), m_canvas.constBits(),
+                static_cast<size_t>(m_canvas.sizeInBytes()));
+    m_canvasPool.push_back(std::move(m_canvas));
+    m_canvas = std::move(next);
+    return true;
+}
+
+bool VideoCompositor::outputBufferAvailable(const QSize &canvasSize,
+                                            bool yuvOutput) const
+{
+    const int limit = m_framePoolSize.load();
+    if (yuvOutput)
+    {
+        if (!m_yuvCanvas || m_yuvCanvas->width != canvasSize.width() ||
+            m_yuvCanvas->height != canvasSize.height() ||
+            av_frame_is_writable(m_yuvCanvas))
+            return true;
+        for (AVFrame *frame : m_yuvPool)
+        {
+            if (av_frame_is_writable(frame))
+                return true;
+        }
+        return static_cast<int>(m_yuvPool.size()) + 1 < limit;
+    }
+
+    if (m_canvas.size() != canvasSize || m_canvas.isDetached())
+        return true;
+    for (const QImage &image : m_canvasPool)
+    {
+        if (image.isDetached())
+            return true;
+    }
+    return static_cast<int>(m_canvasPool.size()) + 1 < limit;
+}
+
+void VideoCompositor::renderTile(uchar *canvasBits, qsizetype bytesPerLine,
+                                 const QRect &bounds, TileJob &job)
+{
+    const QRect cell = job.cell.intersected(bounds);
+    if (cell.isEmpty())
+        return;
+
+    // 直接包装画布上该单元格的内存，不拷贝；各任务区域互不重叠
+    QImage view(canvasBits + cell.y() * bytesPerLine + cell.x() * 4,
+                cell.width(), cell.height(), bytesPerLine,
+                QImage::Format_ARGB32);
+    const QRect local(0, 0, cell.width(), cell.height());
+
+    QPainter painter(&view);
+
+    // 先画黑底（letterbox），同时覆盖上一帧的内容和标签
+    painter.fillRect(local, Qt::black);
+
+    if (!job.frame.isNull())
+    {
+        // 等比缩放填充到单元格；原始帧在这里才转换格式（只转本次用到的帧），
+        // 缩放结果由 drawImage 直接混合进 ARGB32 画布
+        QImage source = job.frame;
+        if (source.format() != QImage::Format_ARGB32 &&
+            source.format() != QImage::Format_RGB32 &&
+            source.format() != QImage::Format_ARGB32_Premultiplied)
+            source.convertTo(QImage::Format_ARGB32);
+        QImage scaled = source.scaled(local.size(), Qt::KeepAspectRatio,
+                                      Qt::SmoothTransformation);
+        // 居中绘制
+        int dx = (local.width() - scaled.width()) / 2;
+        int dy = (local.height() - scaled.height()) / 2;
+        painter.drawImage(dx, dy, scaled);
+    }
+
+    // 绘制名称标签（位于单元格底部；缓存未命中时在本线程排版一次）
+    if (!job.name.isEmpty())
+    {
+        if (job.label.isNull())
+        {
+            job.label = renderNameLabel(job.name, local.width());
+            job.labelRendered = true;
+        }
+        painter.drawImage(0, local.bottom() - LABEL_HEIGHT, job.label);
+    }
+}
+
+void VideoCompositor::renderTileYuv(AVFrame *yuv, const QRect &bounds,
+                                    TileJob &job)
+{
+    // 单元格按偶数对齐（见 recalcLayout），2x2 色度块不跨单元格
+    const QRect cell = job.cell.intersected(bounds);
+    if (cell.isEmpty())
+        return;
+
+    QRect target; // 缩放后视频所在区域（画布坐标，偶数对齐）
+    if (!job.frame.isNull())
+    {
+        // libswscale 能直接读取的格式不做转换，其余格式先转成 ARGB32
+        QImage source = job.frame;
+        AVPixelFormat srcFormat = swsSourceFormat(source.format());
+        if (srcFormat == AV_PIX_FMT_NONE)
+        {
+            source.convertTo(QImage::Format_ARGB32);
+            srcFormat = AV_PIX_FMT_BGRA;
+        }
+
+        const QSize scaled =
+            source.size().scaled(cell.size(), Qt::KeepAspectRatio);
+        const int w = scaled.width() & ~1;
+        const int h = scaled.height() & ~1;
+        if (w > 0 && h > 0)
+        {
+            job.scaler = sws_getCachedContext(
+                job.scaler, source.width(), source.height(), srcFormat, w, h,
+                AV_PIX_FMT_YUV420P, SWS_BILINEAR, nullptr, nullptr, nullptr);
+            if (job.scaler)
+            {
+                // 居中放置，偏移取偶数使色度平面对齐
+                const int x = cell.x() + (((cell.width() - w) / 2) & ~1);
+                const int y = cell.y() + (((cell.height() - h) / 2) & ~1);
+                target = QRect(x, y, w, h);
+
+                const uint8_t *srcSlice[4] = {source.constBits(), nullptr,
+                                              nullptr, nullptr};
+                const int srcStride[4] = {
+                    static_cast<int>(source.bytesPerLine()), 0, 0, 0};
+                uint8_t *dst[4] = {
+                    yuv->data[0] + y * yuv->linesize[0] + x,
+                    yuv->data[1] + (y / 2) * yuv->linesize[1] + x / 2,
+                    yuv->data[2] + (y / 2) * yuv->linesize[2] + x / 2,
+                    nullptr};
+                sws_scale(job.scaler, srcSlice, srcStride, 0, source.height(),
+                          dst, yuv->linesize);
+            }
+        }
+    }
+
+    // 黑边（letterbox）：只填视频区域以外的部分，同时覆盖上一帧的内容和标签
+    const QColor black(Qt::black);
+    if (target.isEmpty())
+    {
+        fillYuvRect(yuv, cell, black);
+    }
+    else
+    {
+        fillYuvRect(yuv, QRect(cell.x(), cell.y(), cell.width(),
+                               target.y() - cell.y()),
+                    black);
+        fillYuvRect(yuv, QRect(cell.x(), target.bottom() + 1, cell.width(),
+                               cell.bottom() - target.bottom()),
+                    black);
+        fillYuvRect(yuv, QRect(cell.x(), target.y(), target.x() - cell.x(),
+                               target.height()),
+                    black);
+        fillYuvRect(yuv, QRect(target.right() + 1, target.y(),
+                               cell.right() - target.right(), target.height()),
+                    black);
+    }
+
+    // 名称标签（位于单元格底部；缓存未命中时在本线程排版一次），只混合标签矩形
+    if (!job.name.isEmpty())
+    {
+        if (job.label.isNull())
+        {
+            job.label = renderNameLabel(job.name, cell.width());
+            job.labelRendered = true;
+        }
+        blendLabelYuv(yuv, job.label,
+                      QPoint(cell.x(), cell.bottom() - LABEL_HEIGHT), cell);
+    }
+}
+
+void VideoCompositor::blendLabelYuv(AVFrame *yuv, const QImage &label,
+                                    const QPoint &topLeft, const QRect &clip)
+{
+    const QRect area = QRect(topLeft, label.size()).intersected(clip);
+    if (area.isEmpty())
+        return;
+
+    const auto pixel = [&label, &topLeft](int x, int y)
+    {
+        return reinterpret_cast<const QRgb *>(
+            label.constScanLine(y - topLeft.y()))[x - topLeft.x()];
+    };
+
+    // 亮度逐像素混合：dst = dst * (1 - a) + src（标签为 premultiplied）
+    for (int y = area.top(); y <= area.bottom(); ++y)
+    {
+        uint8_t *yRow = yuv->data[0] + y * yuv->linesize[0];
+        for (int x = area.left(); x <= area.right(); ++x)
+        {
+            const QRgb p = pixel(x, y);
+            const int a = qAlpha(p);
+            if (a == 0)
+                continue;
+            const int srcY =
+                ((66 * qRed(p) + 129 * qGreen(p) + 25 * qBlue(p) + 128) >> 8) +
+                (16 * a + 127) / 255;
+            yRow[x] = clampByte((yRow[x] * (255 - a) + 127) / 255 + srcY);
+        }
+    }
+
+    // 色度按 2x2 块混合：取块内标签像素的平均颜色与平均 alpha
+    const int cx0 = area.left() / 2;
+    const int cx1 = area.right() / 2;
+    const int cy0 = area.top() / 2;
+    const int cy1 = area.bottom() / 2;
+    for (int cy = cy0; cy <= cy1; ++cy)
+    {
+        uint8_t *uRow = yuv->data[1] + cy * yuv->linesize[1];
+        uint8_t *vRow = yuv->data[2] + cy * yuv->linesize[2];
+        for (int cx = cx0; cx <= cx1; ++cx)
+        {
+            int r = 0, g = 0, b = 0, a = 0, count = 0;
+            for (int y = cy * 2; y <= cy * 2 + 1; ++y)
+            {
+                for (int x = cx * 2; x <= cx * 2 + 1; ++x)
+                {
+                    if (!area.contains(x, y))
+                        continue;
+                    const QRgb p = pixel(x, y);
+                    r += qRed(p);
+                    g += qGreen(p);
+                    b += qBlue(p);
+                    a += qAlpha(p);
+                    ++count;
+                }
+            }
+            a = (a + count / 2) / count;
+            if (a == 0)
+                continue;
+            r = (r + count / 2) / count;
+            g = (g + count / 2) / count;
+            b = (b + count / 2) / count;
+            // premultiplied 颜色的色差分量相对 128 偏移，按 alpha 缩放中性值
+            const int srcU = ((-38 * r - 74 * g + 112 * b + 128) >> 8) +
+                             (128 * a + 127) / 255;
+            const int srcV = ((112 * r - 94 * g - 18 * b + 128) >> 8) +
+                             (128 * a + 127) / 255;
+            uRow[cx] = clampByte((uRow[cx] * (255 - a) + 127) / 255 + srcU);
+            vRow[cx] = clampByte((vRow[cx] * (255 - a) + 127) / 255 + srcV);
+        }
+    }
 }
 
 void VideoCompositor::recalcLayout()
 {
     m_layout.clear();
+    m_fullRedraw = true;
 
     const int n = m_frames.size();
     if (n == 0)
         return;
 
+    const QStringList ids = m_frames.keys();
+    const QRect area(0, 0, m_current.width, m_current.height);
+
     // 检查是否有屏幕共享 → 给它分配主画面
     bool hasScreen = m_frames.contains("screen");
 
-    if (hasScreen && n > 1)
+    switch (m_layoutMode)
     {
-        // 屏幕共享模式：屏幕共享占左侧 75%，其余参会者在右侧 25% 纵向排列
-        int mainW = OUTPUT_WIDTH * 3 / 4;
-        int sideW = OUTPUT_WIDTH - mainW;
+    case LayoutMode::Grid:
+        if (hasScreen && n > 1)
+        {
+            // 屏幕共享模式：屏幕共享占主画面，其余参会者在侧栏纵向排列
+            QStringList others = ids;
+            others.removeAll(QStringLiteral("screen"));
+            layoutFocus(QStringLiteral("screen"), others);
+        }
+        else
+        {
+            // 普通网格模式
+            layoutGrid(ids, area);
+        }
+        break;
 
-        m_layout["screen"] = QRect(0, 0, mainW, OUTPUT_HEIGHT);
+    case LayoutMode::Speaker:
+    case LayoutMode::Pinned:
+    {
+        // 主画面：固定的参会者 > 屏幕共享 > 当前说话人 > 第一个参会者
+        QString focus;
+        if (m_layoutMode == LayoutMode::Pinned)
+            focus = resolveTileIdLocked(m_pinnedId);
+        if (focus.isEmpty() && hasScreen)
+            focus = QStringLiteral("screen");
+        if (focus.isEmpty())
+            focus = resolveTileIdLocked(m_speakerFocus);
+        if (focus.isEmpty())
+            focus = ids.first();
 
-        int otherCount = n - 1;
-        int cellH = OUTPUT_HEIGHT / qMax(otherCount, 1);
-        int idx = 0;
-        for (auto it = m_frames.constBegin(); it != m_frames.constEnd(); ++it)
+        // 侧栏：最近发言的人优先，其余按顺序补齐，最多 FILMSTRIP_MAX 人
+        QStringList strip;
+        for (const QString &id : m_recentSpeakers)
         {
-            if (it.key() == "screen")
-                continue;
-            m_layout[it.key()] = QRect(mainW, idx * cellH, sideW, cellH);
-            idx++;
+            if (strip.size() >= FILMSTRIP_MAX)
+                break;
+            if (id != focus && m_frames.contains(id))
+                strip.append(id);
         }
+        for (const QString &id : ids)
+        {
+            if (strip.size() >= FILMSTRIP_MAX)
+                break;
+            if (id != focus && !strip.contains(id))
+                strip.append(id);
+        }
+        layoutFocus(focus, strip);
+        break;
     }
-    else
+
+    case LayoutMode::Paginated:
     {
-        // 普通网格模式
-        int cols = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(n))));
-        int rows = static_cast<int>(
-            std::ceil(static_cast<double>(n) / static_cast<double>(cols)));
-        int cellW = OUTPUT_WIDTH / cols;
-        int cellH = OUTPUT_HEIGHT / rows;
+        const int pages = (n + m_pageSize - 1) / m_pageSize;
+        m_page = qBound(0, m_page, pages - 1);
+        layoutGrid(ids.mid(m_page * m_pageSize, m_pageSize), area);
+        break;
+    }
+    }
+}
 
-        int idx = 0;
-        for (auto it = m_frames.constBegin(); it != m_frames.constEnd(); ++it)
-        {
-            int row = idx / cols;
-            int col = idx % cols;
-            m_layout[it.key()] = QRect(col * cellW, row * cellH, cellW, cellH);
-            idx++;
-        }
+void VideoCompositor::layoutGrid(const QStringList &ids, const QRect &area)
+{
+    const int n = ids.size();
+    if (n == 0)
+        return;
+
+    int cols = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(n))));
+    int rows = static_cast<int>(
+        std::ceil(static_cast<double>(n) / static_cast<double>(cols)));
+    // 偶数对齐：YUV420P 输出时色度块不跨单元格
+    int cellW = (area.width() / cols) & ~1;
+    int cellH = (area.height() / rows) & ~1;
+
+    int idx = 0;
+    for (const QString &id : ids)
+    {
+        int row = idx / cols;
+        int col = idx % cols;
+        m_layout[id] = QRect(area.x() + col * cellW, area.y() + row * cellH,
+                             cellW, cellH);
+        idx++;
+    }
+}
+
+void VideoCompositor::layoutFocus(const QString &focusId,
+                                  const QStringList &strip)
+{
+    const int outW = m_current.width;
+    const int outH = m_current.height;
+
+    if (strip.isEmpty())
+    {
+        m_layout[focusId] = QRect(0, 0, outW, outH);
+        return;
+    }
+
+    // 主画面占左侧 75%，侧栏参会者在右侧 25% 纵向排列
+    int mainW = (outW * 3 / 4) & ~1;
+    int sideW = outW - mainW;
+
+    m_layout[focusId] = QRect(0, 0, mainW, outH);
+
+    // 偶数对齐：YUV420P 输出时色度块不跨单元格
+    int cellH = (outH / static_cast<int>(strip.size())) & ~1;
+    int idx = 0;
+    for (const QString &id : strip)
+    {
+        m_layout[id] = QRect(mainW, idx * cellH, sideW, cellH);
+        idx++;
     }
 }
 
-void VideoCompositor::drawNameLabel(QPainter &painter, const QRect &cell,
-                                    const QString &name)
+QImage VideoCompositor::renderNameLabel(const QString &name, int width)
 {
-    // 半透明黑底 + 白色文字，位于单元格底部
-    int labelH = 28;
-    QRect labelRect(cell.x(), cell.bottom() - labelH, cell.width(), labelH);
+    QImage label(qMax(1, width), LABEL_HEIGHT,
+                 QImage::Format_ARGB32_Premultiplied);
 
-    painter.fillRect(labelRect, QColor(0, 0, 0, 150));
+    // 半透明黑底 + 白色文字
+    label.fill(QColor(0, 0, 0, 150));
 
+    QPainter painter(&label);
     QFont font;
     font.setPixelSize(14);
     font.setBold(true);
     painter.setFont(font);
     painter.setPen(Qt::white);
-    painter.drawText(labelRect, Qt::AlignCenter, name);
+    painter.drawText(label.rect(), Qt::AlignCenter, name);
+    return label;
 }
@@ -4,9 +4,61 @@
  *
  * 负责：
  * 1. 接收多路视频帧（本地摄像头、远程参会者、屏幕共享）
- * 2. 将所有画面合成到一个 1920x1080 的画布上（网格布局）
+ * 2. 将所有画面合成到一个画布上（网格 / 演讲者 / 固定 / 分页布局，默认 1920x1080）
  * 3. 叠加参会者姓名标签
- * 4. 30fps 定时器驱动输出合成帧
+ * 4. 定时器驱动输出合成帧（默认 30fps）
+ *
+ * 增量合成：画布在多次 tick 之间保留，每个参会者记录帧序号，
+ * 只有收到新帧、改名或布局变化的单元格才重新缩放和绘制；
+ * 所有单元格都未变化时直接重发上一帧画布（隐式共享，不拷贝）。
+ *
+ * 并行合成：持锁只做快照（帧句柄、单元格、名称），缩放和绘制在锁外
+ * 分发到专用线程池，每个任务只写画布上互不重叠的单元格区域，
+ * 合成期间 feedFrame() 不被阻塞。
+ *
+ * YUV420P 输出模式（setOutputFormat）：不经过 ARGB 画布。工作线程用每个
+ * 参会者缓存的 SwsContext 把源帧直接缩放进持久 YUV420P AVFrame 画布中该
+ * 单元格的平面区域，letterbox 黑边直接在 YUV 平面填充，名称标签只在标签
+ * 矩形内做 alpha 混合；通过 compositeYuvFrameReady 以引用计数句柄发出，
+ * MeetingRecorder 直接送编码器，不再对整帧做 BGRA → YUV420P 转换。画布
+ * 缓冲仍被下游持有时，从帧池取一块空闲缓冲继续绘制。单元格与缩放目标
+ * 按偶数像素对齐，保证色度平面区域互不重叠。
+ *
+ * 输出分辨率与帧率可在运行时设置（setOutputGeometry），录制器按
+ * outputWidth() / outputHeight() / outputFps() 初始化编码器。自适应模式
+ * （setAdaptiveQuality）统计每帧合成耗时，超出预算时按 QUALITY_TIERS
+ * 逐级降低帧率 / 分辨率，持续空闲时再逐级恢复，最高不超过设置值。
+ * 关闭 setAdaptiveResolution 后只降帧率，输出尺寸始终为设置值（录制中
+ * 编码器尺寸固定，避免改变尺寸后由录制器再放大）。
+ *
+ * 名称标签缓存：每个参会者的标签（半透明底 + 文字）按「名称 + 单元格宽度」
+ * 预渲染为 premultiplied 图像并缓存，只在改名或布局变化时重新排版，
+ * 每帧只做一次图像混合。
+ *
+ * 布局（setLayoutMode）：
+ * - Grid：全部参会者网格排列；有屏幕共享时屏幕占主画面
+ * - Speaker：当前说话人（setActiveSpeakers，通常连接
+ *   AudioMixer::activeSpeakersChanged）占主画面，其余最多 FILMSTRIP_MAX 人
+ *   按最近发言顺序排在侧栏；有屏幕共享时屏幕优先
+ * - Pinned：setPinnedParticipant 指定的参会者占主画面，侧栏同 Speaker
+ * - Paginated：每页最多 pageSize() 人的网格，setPage 翻页
+ * 只有布局中可见的参会者参与缩放和绘制，不可见的参会者每帧零开销。
+ *
+ * 按需取帧：feedFrame() 只保存原始帧的隐式共享句柄，不做格式转换；
+ * 缩放和格式转换在合成时由工作线程针对实际用到的那一帧进行。
+ * 源帧率高于输出帧率时，两次合成之间被覆盖的帧计入该路的
+ * droppedFrameCounts()，不产生任何像素处理开销。
+ *
+ * 目标尺寸回传：每次重新布局后，单元格尺寸有变化的参会者通过
+ * tileSizeChanged 通知生产者（RemoteVideoRenderer / VideoFrameHandler），
+ * 生产者在自己的线程上直接输出缩放到该尺寸的帧，合成时不再缩放；
+ * 尺寸为空表示该参会者当前不可见，生产者可以暂停向合成器供帧。
+ *
+ * 输出帧池：发出的画布（QImage 或 YUV AVFrame）由下游引用计数持有，
+ * 下游（MeetingRecorder 编码完成后）释放引用即回到帧池复用。两种输出
+ * 格式的缓冲总数都不超过 framePoolSize()；需要重绘而帧池耗尽时跳过
+ * 本次 tick（脏单元格保留到下一次），不再增长内存，跳过次数见
+ * framesSkippedCount()。
  */
 
 #ifndef VIDEOCOMPOSITOR_H
@@ -16,9 +68,17 @@
 #include <QMutex>
 #include <QObject>
 #include <QMap>
+#include <QThreadPool>
 #include <QTimer>
 #include <QRect>
+#include <QStringList>
+#include <atomic>
 #include <chrono>
+#include <vector>
+
+#include "compositeframe.h"
+
+struct SwsContext;
 
 class VideoCompositor : public QObject
 {
@@ -27,9 +87,95 @@ public:
     explicit VideoCompositor(QObject *parent = nullptr);
     ~VideoCompositor() override;
 
-    static constexpr int OUTPUT_WIDTH = 1920;
-    static constexpr int OUTPUT_HEIGHT = 1080;
-    static constexpr int OUTPUT_FPS = 30;
+    static constexpr int DEFAULT_OUTPUT_WIDTH = 1920;
+    static constexpr int DEFAULT_OUTPUT_HEIGHT = 1080;
+    static constexpr int DEFAULT_OUTPUT_FPS = 30;
+    static constexpr int DEFAULT_FRAME_POOL_SIZE = 8;
+
+    /**
+     * @brief 设置输出分辨率与帧率（下一帧生效，触发重新布局）
+     *
+     * 宽高向下取偶数（YUV420P 要求），帧率限制在 1~60。自适应模式下
+     * 这是质量上限。应在 MeetingRecorder::startRecording 之前设置，
+     * 录制器按 outputWidth() / outputHeight() / outputFps() 初始化。
+     */
+    void setOutputGeometry(int width, int height, int fps);
+
+    /** @brief 当前实际输出宽度（自适应降级后可能小于设置值） */
+    int outputWidth() const;
+    /** @brief 当前实际输出高度 */
+    int outputHeight() const;
+    /** @brief 当前实际输出帧率 */
+    int outputFps() const;
+
+    /**
+     * @brief 开启 / 关闭自适应质量
+     *
+     * 开启后若平均合成耗时超过帧间隔的 ADAPTIVE_BUDGET_PERCENT%，
+     * 降到下一质量档；持续低于预算的 1/3 时回升一档。关闭时恢复设置值。
+     */
+    void setAdaptiveQuality(bool enabled);
+    bool isAdaptiveQuality() const;
+
+    /**
+     * @brief 自适应时是否允许降低分辨率（默认允许）
+     *
+     * 关闭后质量阶梯只包含设置分辨率下更低的帧率，输出尺寸保持不变。
+     * 切换时从设置值重新开始自适应。
+     */
+    void setAdaptiveResolution(bool enabled);
+    bool isAdaptiveResolution() const;
+
+    /** @brief 最近的平均合成耗时（微秒，指数滑动平均） */
+    qint64 averageTickCostUs() const;
+
+    /**
+     * @brief 画面布局
+     */
+    enum class LayoutMode
+    {
+        Grid,     // 全部参会者网格（默认）
+        Speaker,  // 当前说话人主画面 + 侧栏
+        Pinned,   // 固定参会者主画面 + 侧栏
+        Paginated // 分页网格
+    };
+
+    /** @brief 切换布局（下一帧生效，整帧重绘） */
+    void setLayoutMode(LayoutMode mode);
+    LayoutMode layoutMode() const;
+
+    /**
+     * @brief 固定主画面参会者（Pinned 布局使用；为空表示取消固定）
+     *
+     * 参会者标识与 feedFrame 一致；也可传入参会者 identity，
+     * 匹配以 "identity::" 开头的画面（优先摄像头）。
+     */
+    void setPinnedParticipant(const QString &participantId);
+    QString pinnedParticipant() const;
+
+    /** @brief 分页布局每页人数（至少 1，默认 9） */
+    void setPageSize(int size);
+    int pageSize() const;
+
+    /** @brief 切换到第 page 页（从 0 开始，越界时取最近的有效页） */
+    void setPage(int page);
+    int page() const;
+    int pageCount() const;
+
+    /**
+     * @brief 合成帧输出格式
+     */
+    enum class OutputFormat
+    {
+        Argb32, // QImage（Format_ARGB32），经 compositeFrameReady 发出
+        Yuv420p // AVFrame（YUV420P / BT.601），经 compositeYuvFrameReady 发出
+    };
+
+    /**
+     * @brief 设置输出格式（下一帧生效，切换时整帧重绘）
+     */
+    void setOutputFormat(OutputFormat format);
+    OutputFormat outputFormat() const;
 
     /**
      * @brief 开始合成（启动定时器）
@@ -43,11 +189,54 @@ public:
 
     bool isRunning() const { return m_running; }
 
+    /**
+     * @brief 立即合成一帧并发出 compositeFrameReady
+     *
+     * 定时器每个周期调用；也可在未 start() 时由基准 / 测试直接驱动。
+     * 须始终在同一线程调用。
+     */
+    void compositeNow();
+
+    /**
+     * @brief 设置单元格并行绘制的线程数（1 表示在调用线程串行绘制）
+     */
+    void setRenderThreadCount(int count);
+    int renderThreadCount() const;
+
+    /** @brief 累计重绘的单元格数 */
+    quint64 tilesRenderedCount() const;
+
+    /** @brief 累计因未变化而跳过的单元格数 */
+    quint64 tilesSkippedCount() const;
+
+    /**
+     * @brief 设置输出帧池上限（含当前画布，至少 2 块）
+     *
+     * 1080p 下每块 ARGB 画布约 8MB、YUV 帧约 3MB。
+     */
+    void setFramePoolSize(int size);
+    int framePoolSize() const;
+
+    /** @brief 累计因帧池耗尽（下游积压）而跳过的 tick 数 */
+    quint64 framesSkippedCount() const;
+
+    /**
+     * @brief 每路输入在合成前被新帧覆盖（从未参与合成）的帧数
+     * @return participantId → 累计丢弃帧数（参会者移除后不再统计）
+     */
+    QMap<QString, quint64> droppedFrameCounts() const;
+
+    /**
+     * @brief 参会者当前单元格尺寸（线程安全）
+     * @return 尚未布局时返回无效 QSize；不可见时返回 QSize(0, 0)
+     */
+    QSize tileSize(const QString &participantId) const;
+
 public slots:
     /**
      * @brief 输入参会者视频帧
      * @param participantId 参会者标识（"local" 代表本地摄像头，"screen" 代表屏幕共享）
-     * @param frame BGRA/ARGB32 格式的 QImage
+     * @param frame 任意格式的 QImage（只保存引用，合成时才缩放和转换）
      * @param displayName 显示名称（叠加到画面上）
      */
     void feedFrame(const QString &participantId, const QImage &frame,
@@ -58,28 +247,128 @@ public slots:
      */
     void removeParticipant(const QString &participantId);
 
+    /**
+     * @brief 更新当前说话人（按电平从高到低），驱动 Speaker 布局
+     *
+     * 可直接连接 AudioMixer::activeSpeakersChanged；标识可以是画面的
+     * participantId 或参会者 identity。没有人说话时保持上一位说话人。
+     */
+    void setActiveSpeakers(const QStringList &participantIds);
+
 signals:
     /**
      * @brief 合成帧就绪
-     * @param frame 1920x1080 的合成画面（Format_ARGB32）
+     * @param frame outputWidth() x outputHeight() 的合成画面（Format_ARGB32）
      * @param timestampUs 时间戳（微秒）
      */
     void compositeFrameReady(const QImage &frame, qint64 timestampUs);
 
+    /**
+     * @brief 合成帧就绪（YUV420P 输出模式）
+     * @param frame YUV420P 合成画面（引用合成器画布缓冲，只读）
+     * @param timestampUs 时间戳（微秒）
+     */
+    void compositeYuvFrameReady(const AVFrameRef &frame, qint64 timestampUs);
+
+    /**
+     * @brief 实际输出分辨率 / 帧率变化（设置或自适应调整）
+     */
+    void outputGeometryChanged(int width, int height, int fps);
+
+    /**
+     * @brief 参会者单元格尺寸变化（重新布局后从合成线程发出）
+     * @param participantId 画面标识（与 feedFrame 相同）
+     * @param size 新的单元格尺寸；QSize(0, 0) 表示不可见
+     */
+    void tileSizeChanged(const QString &participantId, const QSize &size);
+
 private slots:
     void onTimer();
 
 private:
     /**
-     * @brief 计算网格布局
+     * @brief 按当前布局模式计算可见单元格
      */
     void recalcLayout();
 
+    // 网格排列 ids 到 area 内
+    void layoutGrid(const QStringList &ids, const QRect &area);
+
+    // focusId 占主画面，strip 排在右侧侧栏
+    void layoutFocus(const QString &focusId, const QStringList &strip);
+
+    // 把说话人 / 固定标识解析为画面 participantId（须持有 m_mutex）
+    QString resolveTileIdLocked(const QString &id) const;
+
+    // 布局失效，下一帧重新计算（须持有 m_mutex）
+    void invalidateLayoutLocked();
+
+    // 一个待重绘单元格的快照（持锁时生成，锁外在工作线程绘制）
+    struct TileJob
+    {
+        QString participantId;
+        QRect cell;
+        QImage frame;
+        QString name;
+        QImage label;              // 缓存的标签；为空时由工作线程渲染并回填
+        bool labelRendered = false; // 本次新渲染了标签，需写回缓存
+        SwsContext *scaler = nullptr; // YUV 输出：从参会者移交来的缩放上下文，绘制后归还
+    };
+
     /**
-     * @brief 在画布上绘制名称标签
+     * @brief 把一个单元格绘制到画布对应区域（工作线程，只写 cell 范围）
+     * @param canvasBits 画布像素首地址（已在合成线程分离）
+     * @param bytesPerLine 画布每行字节数
      */
-    void drawNameLabel(QPainter &painter, const QRect &cell,
-                       const QString &name);
+    static void renderTile(uchar *canvasBits, qsizetype bytesPerLine,
+                           const QRect &bounds, TileJob &job);
+
+    /**
+     * @brief 把一个单元格直接绘制进 YUV420P 画布（工作线程，只写 cell 范围）
+     *
+     * 源帧经 sws_scale 等比缩放后写入平面对应区域，黑边与标签也在 YUV 上完成。
+     */
+    static void renderTileYuv(AVFrame *yuv, const QRect &bounds, TileJob &job);
+
+    /**
+     * @brief 把 premultiplied 标签 alpha 混合进 YUV420P 画布（只写 clip 范围）
+     */
+    static void blendLabelYuv(AVFrame *yuv, const QImage &label,
+                              const QPoint &topLeft, const QRect &clip);
+
+    /**
+     * @brief 确保 YUV 画布可写：仍被下游持有时从帧池换一块空闲缓冲
+     *        （拷贝当前内容，未变化的单元格保持不变）
+     * @return 失败（分配出错）时返回 false
+     */
+    bool ensureYuvCanvasWritable(const QSize &canvasSize);
+
+    /**
+     * @brief 确保 ARGB 画布可写：仍被下游持有时从帧池换一块空闲画布
+     *        （拷贝当前内容）
+     * @return 帧池耗尽时返回 false
+     */
+    bool ensureCanvasWritable();
+
+    // 本次重绘能否拿到可写的输出缓冲（仅合成线程，不分配）
+    bool outputBufferAvailable(const QSize &canvasSize, bool yuvOutput) const;
+
+    // 分配一块 YUV420P 帧
+    static AVFrame *allocYuvFrame(int width, int height);
+
+    // 记录本帧合成耗时，必要时调整自适应质量档位（仅合成线程）
+    void updateAdaptiveQuality(qint64 costUs);
+
+    // 按设置值重建质量阶梯并应用 level 档（须持有 m_mutex）
+    // @return 实际输出几何是否变化
+    bool applyQualityLevelLocked(int level);
+
+    /**
+     * @brief 预渲染名称标签（width x LABEL_HEIGHT，premultiplied ARGB）
+     */
+    static QImage renderNameLabel(const QString &name, int width);
+
+    static constexpr int LABEL_HEIGHT = 28;
 
 private:
     QTimer *m_timer;
@@ -89,16 +378,85 @@ private:
 
     struct ParticipantFrame
     {
-        QImage lastFrame; // 最近一帧（Format_ARGB32）
+        QImage lastFrame; // 最近一帧（原始格式，合成时才缩放转换）
         QString displayName;
+        quint64 frameSeq = 0;    // 收到的帧序号（每次 feedFrame 递增）
+        quint64 renderedSeq = 0; // 画布上当前绘制的帧序号
+        bool dirty = true;       // 名称 / 布局变化，需要重绘
+        quint64 droppedFrames = 0; // 未参与合成就被覆盖的帧数
+        QImage label;            // 缓存的名称标签（宽度即渲染时的单元格宽度）
+        QString labelName;       // label 对应的名称
+        SwsContext *yuvScaler = nullptr; // YUV 输出的缩放上下文（绘制期间移交给任务）
     };
 
+    // 释放参会者持有的缩放上下文（须持有 m_mutex）
+    static void releaseScaler(ParticipantFrame &pf);
+
+    // 把 m_jobs 中任务持有的缩放上下文归还给参会者，参会者已离开则释放（须持有 m_mutex）
+    void returnJobScalersLocked();
+
     QMap<QString, ParticipantFrame> m_frames;
 
     // 布局缓存
-    QMap<QString, QRect> m_layout; // participantId → cell rect
+    QMap<QString, QRect> m_layout; // participantId → cell rect（仅可见的）
+    QMap<QString, QSize> m_tileSizes; // 已通知生产者的单元格尺寸
     int m_lastParticipantCount = 0;
 
+    // 布局设置（受 m_mutex 保护）
+    static constexpr int FILMSTRIP_MAX = 4; // 侧栏最多显示人数
+    LayoutMode m_layoutMode = LayoutMode::Grid;
+    QString m_pinnedId;
+    int m_pageSize = 9;
+    int m_page = 0;
+    QString m_speakerFocus;       // Speaker 布局的主画面（画面 participantId）
+    QStringList m_recentSpeakers; // 最近发言顺序（画面 participantId，新的在前）
+
+    // 质量档位（帧率优先下调，其次分辨率）
+    struct QualityTier
+    {
+        int width;
+        int height;
+        int fps;
+    };
+    static const QualityTier QUALITY_TIERS[];
+    static constexpr int ADAPTIVE_BUDGET_PERCENT = 50; // 合成耗时预算占帧间隔比例
+    static constexpr int ADAPTIVE_DOWN_TICKS = 30;     // 超预算持续多少帧后降档
+    static constexpr int ADAPTIVE_UP_TICKS = 300;      // 低负载持续多少帧后升档
+
+    // 输出几何（受 m_mutex 保护）
+    QualityTier m_configured{DEFAULT_OUTPUT_WIDTH, DEFAULT_OUTPUT_HEIGHT,
+                             DEFAULT_OUTPUT_FPS};
+    QualityTier m_current = m_configured;
+    std::vector<QualityTier> m_qualityLadder; // [0] 为设置值，逐级降低
+    int m_qualityLevel = 0;
+    bool m_adaptive = false;
+    bool m_adaptiveResolution = true; // 阶梯是否包含更低分辨率的档位
+
+    // 自适应统计：平均耗时仅合成线程写；计数受 m_mutex 保护
+    std::atomic<qint64> m_avgTickCostUs{0};
+    int m_overBudgetTicks = 0;
+    int m_underBudgetTicks = 0;
+
+    // 持久画布：跨 tick 保留，只重绘脏单元格
+    QImage m_canvas;
+    std::vector<QImage> m_canvasPool; // 已交给下游、等待释放后复用的画布
+    bool m_fullRedraw = true; // 布局变化后需清空整张画布
+    std::atomic<int> m_framePoolSize{DEFAULT_FRAME_POOL_SIZE};
+
+    // YUV420P 输出（格式受 m_mutex 保护；画布与帧池仅合成线程访问）
+    OutputFormat m_outputFormat = OutputFormat::Argb32;
+    AVFrame *m_yuvCanvas = nullptr;
+    std::vector<AVFrame *> m_yuvPool; // 已交给下游、等待释放后复用的帧
+
+    // 单元格绘制线程池与任务列表（仅合成线程访问，复用避免每帧分配）
+    QThreadPool m_renderPool;
+    std::vector<TileJob> m_jobs;
+
+    // 统计
+    quint64 m_tilesRendered = 0;
+    quint64 m_tilesSkipped = 0;
+    quint64 m_framesSkipped = 0;
+
     // 时间基准
     std::chrono::steady_clock::time_point m_startTime;
 };
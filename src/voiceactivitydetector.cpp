@@ -0,0 +1,81 @@
+/**
+ * @file voiceactivitydetector.cpp
+ * @brief 基于能量的语音活动检测实现
+ */
+
+#include "voiceactivitydetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// 电平平滑时间常数
+constexpr float ATTACK_MS = 10.0f;
+constexpr float RELEASE_MS = 150.0f;
+
+// 噪声底上升速率（dB / 秒）：足够慢，说话时不会被语音本身抬高
+constexpr float NOISE_RISE_DB_PER_SEC = 1.0f;
+
+// 判决门限：高于噪声底 10dB，且绝对电平不低于 -55dBFS
+constexpr float SPEECH_ABOVE_FLOOR_DB = 10.0f;
+constexpr float SPEECH_MIN_DB = -55.0f;
+
+// 判为说话后保持的时长
+constexpr float HANGOVER_MS = 300.0f;
+} // namespace
+
+VoiceActivityDetector::VoiceActivityDetector() = default;
+
+void VoiceActivityDetector::process(const int16_t *samples, int count,
+                                    int sampleRate)
+{
+  if (count <= 0 || sampleRate <= 0)
+    return;
+
+  double energy = 0.0;
+  for (int i = 0; i < count; ++i)
+  {
+    const double s = samples[i];
+    energy += s * s;
+  }
+  const double meanSquare = energy / count / (32768.0 * 32768.0);
+  const float blockDb = meanSquare > 0.0
+                            ? std::max(SILENCE_DB, static_cast<float>(
+                                                       10.0 * std::log10(meanSquare)))
+                            : SILENCE_DB;
+  const float blockMs = 1000.0f * static_cast<float>(count) / sampleRate;
+
+  if (!m_primed)
+  {
+    m_levelDb = blockDb;
+    m_noiseFloorDb = blockDb;
+    m_primed = true;
+  }
+  else
+  {
+    // 一阶平滑，系数按块长换算，使行为与块大小无关
+    const float tau = blockDb > m_levelDb ? ATTACK_MS : RELEASE_MS;
+    const float alpha = 1.0f - std::exp(-blockMs / tau);
+    m_levelDb += alpha * (blockDb - m_levelDb);
+  }
+
+  if (m_levelDb < m_noiseFloorDb)
+    m_noiseFloorDb = m_levelDb;
+  else
+    m_noiseFloorDb += NOISE_RISE_DB_PER_SEC * blockMs / 1000.0f;
+
+  const bool voiced = m_levelDb > m_noiseFloorDb + SPEECH_ABOVE_FLOOR_DB &&
+                      m_levelDb > SPEECH_MIN_DB;
+  if (voiced)
+    m_hangoverMs = HANGOVER_MS;
+  else
+    m_hangoverMs = std::max(0.0f, m_hangoverMs - blockMs);
+}
+
+void VoiceActivityDetector::reset()
+{
+  m_levelDb = SILENCE_DB;
+  m_noiseFloorDb = SILENCE_DB;
+  m_hangoverMs = 0.0f;
+  m_primed = false;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file voiceactivitydetector.h
+ * @brief 基于能量的语音活动检测（VAD）
+ *
+ * 每个音频块计算 RMS 电平（dBFS），并做：
+ * 1. 电平平滑：快攻（~10ms）慢放（~150ms），避免逐块抖动
+ * 2. 噪声底跟踪：电平低于噪声底时立即下调，否则按固定速率缓慢上升，
+ *    稳定的背景噪声（风扇、空调）会被吸收进噪声底而不被判为语音
+ * 3. 判决：电平高于「噪声底 + 门限」且高于绝对门限时判为说话，
+ *    之后保持 hangover 时长，避免词间停顿造成频繁切换
+ *
+ * 非线程安全：由单一线程（通常是该路音频的生产者线程）调用 process()。
+ */
+
+#ifndef VOICEACTIVITYDETECTOR_H
+#define VOICEACTIVITYDETECTOR_H
+
+#include <cstdint>
+
+class VoiceActivityDetector
+{
+public:
+  /** @brief 静音电平（dBFS），也是电平下限 */
+  static constexpr float SILENCE_DB = -96.0f;
+
+  VoiceActivityDetector();
+
+  /**
+   * @brief 处理一块单声道 int16 采样，更新电平与判决
+   * @param sampleRate 采样率（用于把块长换算为时间）
+   */
+  void process(const int16_t *samples, int count, int sampleRate);
+
+  /** @brief 平滑后的电平（dBFS） */
+  float levelDb() const { return m_levelDb; }
+
+  /** @brief 当前噪声底估计（dBFS） */
+  float noiseFloorDb() const { return m_noiseFloorDb; }
+
+  /** @brief 是否判定为正在说话（含 hangover） */
+  bool isSpeaking() const { return m_hangoverMs > 0.0f; }
+
+  void reset();
+
+private:
+  float m_levelDb = SILENCE_DB;
+  float m_noiseFloorDb = SILENCE_DB;
+  float m_hangoverMs = 0.0f;
+  bool m_primed = false; // 首块电平直接作为初始噪声底
+};
+
+#endif // VOICEACTIVITYDETECTOR_H
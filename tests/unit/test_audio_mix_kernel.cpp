@@ -0,0 +1,275 @@
+/**
+ * @file test_audio_mix_kernel.cpp
+ * @brief AudioMixKernel 单元测试
+ *
+ * 测试内容：
+ * - 当前 CPU 支持的每个实现（标量 / SSE2 / AVX2）与参考实现
+ *   （int32 求和 + 钳位）逐位一致
+ * - 正 / 负饱和，以及不是向量宽度整数倍的尾部长度
+ * - 输出与输入重叠（原地混音）
+ * - mix-minus：全体混音与各路「总和 − 自身」，部分输出为 nullptr
+ * - 运行期分派：mixStreams() 使用 activeImplementation()，且选中的是
+ *   当前 CPU 支持的最优实现
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "audiomixkernel.h"
+
+using AudioMixKernel::Implementation;
+
+namespace
+{
+
+const Implementation ALL_IMPLEMENTATIONS[] = {
+    Implementation::Scalar, Implementation::SSE2, Implementation::AVX2};
+
+// 覆盖空输入、单样本和 SSE2（8）/ AVX2（16）宽度前后的尾部长度
+const int SAMPLE_COUNTS[] = {1, 3, 7, 8, 9, 15, 16, 17, 31, 33, 63, 64, 65, 480, 997};
+const int INPUT_COUNTS[] = {1, 2, 3, 5, 8, 32};
+
+struct Streams
+{
+    std::vector<std::vector<int16_t>> data;
+    std::vector<const int16_t *> ptrs;
+};
+
+enum class Pattern
+{
+    Random,      // 全范围随机，混合后大量饱和
+    Quiet,       // 小幅值，不饱和
+    PositiveMax, // 全部 32767，正饱和
+    NegativeMax  // 全部 -32768，负饱和
+};
+
+Streams makeStreams(int inputCount, int sampleCount, Pattern pattern,
+                    unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> full(-32768, 32767);
+    std::uniform_int_distribution<int> quiet(-1000, 1000);
+
+    Streams s;
+    s.data.resize(inputCount);
+    for (auto &stream : s.data)
+    {
+        stream.resize(sampleCount);
+        for (int16_t &v : stream)
+        {
+            switch (pattern)
+            {
+            case Pattern::Random:
+                v = static_cast<int16_t>(full(rng));
+                break;
+            case Pattern::Quiet:
+                v = static_cast<int16_t>(quiet(rng));
+                break;
+            case Pattern::PositiveMax:
+                v = 32767;
+                break;
+            case Pattern::NegativeMax:
+                v = -32768;
+                break;
+            }
+        }
+        s.ptrs.push_back(stream.data());
+    }
+    return s;
+}
+
+int16_t clampRef(int32_t v)
+{
+    return static_cast<int16_t>(std::clamp(v, -32768, 32767));
+}
+
+std::vector<int16_t> referenceMix(const Streams &s, int sampleCount,
+                                  int exclude = -1)
+{
+    std::vector<int16_t> out(sampleCount);
+    for (int i = 0; i < sampleCount; ++i)
+    {
+        int32_t sum = 0;
+        for (size_t k = 0; k < s.data.size(); ++k)
+        {
+            if (static_cast<int>(k) != exclude)
+                sum += s.data[k][i];
+        }
+        out[i] = clampRef(sum);
+    }
+    return out;
+}
+
+std::vector<Implementation> supportedImplementations()
+{
+    std::vector<Implementation> impls;
+    for (Implementation impl : ALL_IMPLEMENTATIONS)
+    {
+        if (AudioMixKernel::isSupported(impl))
+            impls.push_back(impl);
+    }
+    return impls;
+}
+
+} // namespace
+
+// ==================== 运行期分派 ====================
+
+TEST(AudioMixKernelTest, ScalarIsAlwaysSupported)
+{
+    EXPECT_TRUE(AudioMixKernel::isSupported(Implementation::Scalar));
+}
+
+TEST(AudioMixKernelTest, ActiveImplementationIsBestSupported)
+{
+    const Implementation active = AudioMixKernel::activeImplementation();
+    EXPECT_TRUE(AudioMixKernel::isSupported(active));
+
+    Implementation best = Implementation::Scalar;
+    for (Implementation impl : ALL_IMPLEMENTATIONS)
+    {
+        if (AudioMixKernel::isSupported(impl))
+            best = impl; // 按 Scalar → SSE2 → AVX2 递增
+    }
+    EXPECT_EQ(active, best) << AudioMixKernel::implementationName(active);
+}
+
+TEST(AudioMixKernelTest, DispatchMatchesActiveImplementation)
+{
+    const Streams s = makeStreams(5, 997, Pattern::Random, 7);
+    std::vector<int16_t> dispatched(997), direct(997);
+    AudioMixKernel::mixStreams(dispatched.data(), s.ptrs.data(), 5, 997);
+    AudioMixKernel::mixStreamsWith(AudioMixKernel::activeImplementation(),
+                                   direct.data(), s.ptrs.data(), 5, 997);
+    EXPECT_EQ(dispatched, direct);
+    EXPECT_EQ(dispatched, referenceMix(s, 997));
+}
+
+// ==================== 混音逐位一致 ====================
+
+TEST(AudioMixKernelTest, AllImplementationsMatchReference)
+{
+    unsigned seed = 1;
+    for (Implementation impl : supportedImplementations())
+    {
+        for (Pattern pattern : {Pattern::Random, Pattern::Quiet,
+                                Pattern::PositiveMax, Pattern::NegativeMax})
+        {
+            for (int inputs : INPUT_COUNTS)
+            {
+                for (int samples : SAMPLE_COUNTS)
+                {
+                    const Streams s =
+                        makeStreams(inputs, samples, pattern, seed++);
+                    // 多分配一个哨兵，检查不越界写
+                    std::vector<int16_t> out(samples + 1, 0x5a5a);
+                    AudioMixKernel::mixStreamsWith(impl, out.data(),
+                                                   s.ptrs.data(), inputs,
+                                                   samples);
+                    ASSERT_EQ(out.back(), 0x5a5a);
+                    out.pop_back();
+                    ASSERT_EQ(out, referenceMix(s, samples))
+                        << AudioMixKernel::implementationName(impl)
+                        << " inputs=" << inputs << " samples=" << samples
+                        << " pattern=" << static_cast<int>(pattern);
+                }
+            }
+        }
+    }
+}
+
+TEST(AudioMixKernelTest, InPlaceMixMatchesReference)
+{
+    for (Implementation impl : supportedImplementations())
+    {
+        Streams s = makeStreams(4, 65, Pattern::Random, 42);
+        const std::vector<int16_t> expected = referenceMix(s, 65);
+        // 输出写回第 0 路输入
+        AudioMixKernel::mixStreamsWith(impl, s.data[0].data(), s.ptrs.data(),
+                                       4, 65);
+        EXPECT_EQ(s.data[0], expected)
+            << AudioMixKernel::implementationName(impl);
+    }
+}
+
+TEST(AudioMixKernelTest, ZeroInputsProduceSilence)
+{
+    for (Implementation impl : supportedImplementations())
+    {
+        std::vector<int16_t> out(17, 123);
+        AudioMixKernel::mixStreamsWith(impl, out.data(), nullptr, 0, 17);
+        EXPECT_EQ(out, std::vector<int16_t>(17, 0));
+    }
+}
+
+// ==================== mix-minus 逐位一致 ====================
+
+TEST(AudioMixKernelTest, MixMinusMatchesReference)
+{
+    unsigned seed = 1000;
+    for (Implementation impl : supportedImplementations())
+    {
+        for (Pattern pattern : {Pattern::Random, Pattern::Quiet,
+                                Pattern::PositiveMax, Pattern::NegativeMax})
+        {
+            for (int inputs : INPUT_COUNTS)
+            {
+                for (int samples : SAMPLE_COUNTS)
+                {
+                    const Streams s =
+                        makeStreams(inputs, samples, pattern, seed++);
+                    std::vector<int16_t> full(samples);
+                    std::vector<std::vector<int16_t>> minus(
+                        inputs, std::vector<int16_t>(samples, 0x5a5a));
+                    // 奇数路不需要 mix-minus，对应输出须保持不变
+                    std::vector<int16_t *> minusPtrs(inputs, nullptr);
+                    for (int k = 0; k < inputs; k += 2)
+                        minusPtrs[k] = minus[k].data();
+
+                    AudioMixKernel::mixMinusStreamsWith(
+                        impl, full.data(), minusPtrs.data(), s.ptrs.data(),
+                        inputs, samples);
+
+                    const char *name = AudioMixKernel::implementationName(impl);
+                    ASSERT_EQ(full, referenceMix(s, samples))
+                        << name << " inputs=" << inputs
+                        << " samples=" << samples;
+                    for (int k = 0; k < inputs; ++k)
+                    {
+                        if (minusPtrs[k])
+                        {
+                            ASSERT_EQ(minus[k], referenceMix(s, samples, k))
+                                << name << " minus k=" << k
+                                << " inputs=" << inputs
+                                << " samples=" << samples;
+                        }
+                        else
+                        {
+                            ASSERT_EQ(minus[k],
+                                      std::vector<int16_t>(samples, 0x5a5a));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(AudioMixKernelTest, MixMinusWithoutFullOutput)
+{
+    for (Implementation impl : supportedImplementations())
+    {
+        const Streams s = makeStreams(3, 33, Pattern::Random, 9);
+        std::vector<std::vector<int16_t>> minus(3, std::vector<int16_t>(33));
+        std::vector<int16_t *> minusPtrs = {minus[0].data(), minus[1].data(),
+                                            minus[2].data()};
+        AudioMixKernel::mixMinusStreamsWith(impl, nullptr, minusPtrs.data(),
+                                            s.ptrs.data(), 3, 33);
+        for (int k = 0; k < 3; ++k)
+            EXPECT_EQ(minus[k], referenceMix(s, 33, k));
+    }
+}
@@ -0,0 +1,212 @@
+/**
+ * @file test_audio_mixer.cpp
+ * @brief AudioMixer 单元测试（Pacing::Manual，由测试逐周期驱动）
+ *
+ * 测试内容：
+ * - top-N 混音只混合最响的 N 个说话人
+ * - 电平相近时已选中的输入有 SELECTED_HYSTERESIS_DB 滞回，不来回切换
+ * - activeSpeakersChanged 只在说话人集合变化时发出（仅排序变化不发）
+ * - mix-minus 总线恰好去掉自己那一路，包括自己未被 top-N 选中时
+ *
+ * 输入为恒定值的 PCM 块：电平可直接换算，混音结果即各路常数之和。
+ * 每路先送一块静音，让 VAD 的噪声底从静音开始（首块电平即初始噪声底）。
+ */
+
+#include <gtest/gtest.h>
+
+#include <QByteArray>
+#include <QSignalSpy>
+#include <QStringList>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "audiomixer.h"
+
+namespace
+{
+constexpr int SAMPLE_RATE = 48000;
+constexpr int PERIOD = SAMPLE_RATE * AudioMixer::MIX_INTERVAL_MS / 1000;
+
+QByteArray constantPcm(int16_t value, int count = PERIOD)
+{
+    std::vector<int16_t> samples(count, value);
+    return QByteArray(reinterpret_cast<const char *>(samples.data()),
+                      count * static_cast<int>(sizeof(int16_t)));
+}
+
+// 信号参数中 PCM 的第一个采样（恒定输入时整块相同）
+int16_t firstSample(const QList<QVariant> &args)
+{
+    const QByteArray pcm = args.at(0).toByteArray();
+    if (pcm.size() < static_cast<int>(sizeof(int16_t)))
+        return 0;
+    return reinterpret_cast<const int16_t *>(pcm.constData())[0];
+}
+
+// 说话人集合（与顺序无关的比较）
+QStringList sorted(QStringList ids)
+{
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+} // namespace
+
+// ==================== 测试夹具 ====================
+
+class AudioMixerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mixer = std::make_unique<AudioMixer>(nullptr, AudioMixer::Pacing::Manual);
+    }
+
+    // 登记参会者并送一块静音预热 VAD
+    void addParticipants(const QStringList &ids)
+    {
+        for (const QString &id : ids)
+        {
+            inputs.push_back(mixer->remoteInput(id));
+            levels.push_back(0);
+        }
+        tick();
+    }
+
+    // 每路送入当前电平的一个周期，再混音一个周期
+    void tick(int count = 1)
+    {
+        for (int n = 0; n < count; ++n)
+        {
+            for (size_t i = 0; i < inputs.size(); ++i)
+                inputs[i]->push(constantPcm(levels[i]), SAMPLE_RATE, 1);
+            if (localLevel != 0)
+                mixer->feedLocalAudio(constantPcm(localLevel), SAMPLE_RATE, 1);
+            mixer->runTick();
+        }
+    }
+
+    std::unique_ptr<AudioMixer> mixer;
+    std::vector<std::shared_ptr<AudioMixerInput>> inputs;
+    std::vector<int16_t> levels;
+    int16_t localLevel = 0;
+};
+
+// ==================== top-N 选择 ====================
+
+TEST_F(AudioMixerTest, TopNKeepsLoudestSpeakers)
+{
+    mixer->setMaxActiveSpeakers(2);
+    QSignalSpy mixed(mixer.get(), &AudioMixer::mixedAudioReady);
+    addParticipants({"a", "b", "c", "d", "e"});
+
+    levels = {500, 1000, 2000, 4000, 8000};
+    tick(10);
+
+    EXPECT_EQ(mixer->activeSpeakers(), QStringList({"e", "d"}));
+    ASSERT_FALSE(mixed.isEmpty());
+    EXPECT_EQ(firstSample(mixed.last()), 8000 + 4000);
+}
+
+TEST_F(AudioMixerTest, HysteresisPreventsFlapping)
+{
+    mixer->setMaxActiveSpeakers(1);
+    QSignalSpy mixed(mixer.get(), &AudioMixer::mixedAudioReady);
+    addParticipants({"a", "b"});
+
+    levels = {1200, 1000};
+    tick(10);
+    ASSERT_EQ(mixer->activeSpeakers(), QStringList({"a"}));
+
+    // b 反超约 1.6dB（小于滞回加成）：a 保持选中，每个周期都只混 a
+    levels = {1000, 1200};
+    for (int i = 0; i < 50; ++i)
+    {
+        tick();
+        ASSERT_EQ(firstSample(mixed.last()), 1000) << "tick " << i;
+    }
+    EXPECT_EQ(mixer->activeSpeakers(), QStringList({"a"}));
+
+    // b 明显更响（约 6dB）：切换到 b
+    levels = {1000, 2000};
+    tick(10);
+    EXPECT_EQ(mixer->activeSpeakers(), QStringList({"b"}));
+    EXPECT_EQ(firstSample(mixed.last()), 2000);
+}
+
+TEST_F(AudioMixerTest, ActiveSpeakersChangedOnlyWhenSetChanges)
+{
+    QSignalSpy changed(mixer.get(), &AudioMixer::activeSpeakersChanged);
+    addParticipants({"a", "b", "c"});
+    changed.clear();
+
+    // a、b 同一周期开始说话（电平足够高，第一个周期即越过 VAD 门限）
+    levels = {4000, 2000, 0};
+    tick(10);
+    ASSERT_EQ(changed.count(), 1);
+    EXPECT_EQ(changed.last().at(0).toStringList(), QStringList({"a", "b"}));
+
+    // 只是电平排序变化：集合不变，不发信号
+    levels = {2000, 4000, 0};
+    tick(30);
+    EXPECT_EQ(changed.count(), 1);
+    EXPECT_EQ(sorted(mixer->activeSpeakers()), QStringList({"a", "b"}));
+
+    // c 开始说话：集合变化，发一次
+    levels = {2000, 4000, 3000};
+    tick(30);
+    ASSERT_EQ(changed.count(), 2);
+    EXPECT_EQ(sorted(changed.last().at(0).toStringList()),
+              QStringList({"a", "b", "c"}));
+
+    // 稳定说话：不再发出
+    tick(30);
+    EXPECT_EQ(changed.count(), 2);
+}
+
+// ==================== mix-minus ====================
+
+TEST_F(AudioMixerTest, MixMinusExcludesOwnParticipant)
+{
+    mixer->setMixMinusEnabled(true);
+    QSignalSpy mixed(mixer.get(), &AudioMixer::mixedAudioReady);
+    QSignalSpy busA(mixer->mixMinusOutput("a"), &AudioMixerOutput::audioReady);
+    QSignalSpy busB(mixer->mixMinusOutput("b"), &AudioMixerOutput::audioReady);
+    QSignalSpy busLocal(mixer->mixMinusOutput(QString()),
+                        &AudioMixerOutput::audioReady);
+    addParticipants({"a", "b", "c"});
+
+    levels = {1000, 2000, 4000};
+    localLevel = 100;
+    tick(5);
+
+    ASSERT_FALSE(busA.isEmpty());
+    ASSERT_FALSE(busB.isEmpty());
+    ASSERT_FALSE(busLocal.isEmpty());
+    EXPECT_EQ(firstSample(mixed.last()), 100 + 1000 + 2000 + 4000);
+    EXPECT_EQ(firstSample(busA.last()), 100 + 2000 + 4000);
+    EXPECT_EQ(firstSample(busB.last()), 100 + 1000 + 4000);
+    EXPECT_EQ(firstSample(busLocal.last()), 1000 + 2000 + 4000);
+}
+
+TEST_F(AudioMixerTest, MixMinusForParticipantOutsideTopN)
+{
+    mixer->setMixMinusEnabled(true);
+    mixer->setMaxActiveSpeakers(2);
+    QSignalSpy mixed(mixer.get(), &AudioMixer::mixedAudioReady);
+    QSignalSpy busA(mixer->mixMinusOutput("a"), &AudioMixerOutput::audioReady);
+    QSignalSpy busB(mixer->mixMinusOutput("b"), &AudioMixerOutput::audioReady);
+    addParticipants({"a", "b", "c"});
+
+    // a 最轻，未被选中：它的总线就是全体混音（本来就不含 a）
+    levels = {1000, 2000, 4000};
+    localLevel = 100;
+    tick(5);
+
+    ASSERT_EQ(mixer->activeSpeakers(), QStringList({"c", "b"}));
+    ASSERT_FALSE(busA.isEmpty());
+    ASSERT_FALSE(busB.isEmpty());
+    EXPECT_EQ(firstSample(mixed.last()), 100 + 2000 + 4000);
+    EXPECT_EQ(firstSample(busA.last()), 100 + 2000 + 4000);
+    EXPECT_EQ(firstSample(busB.last()), 100 + 4000);
+}
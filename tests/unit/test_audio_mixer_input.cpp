@@ -0,0 +1,112 @@
+/**
+ * @file test_audio_mixer_input.cpp
+ * @brief AudioMixerInput 单元测试
+ *
+ * 测试内容：
+ * - 抖动缓冲模式下连续 underrun 的丢包隐藏电平（每次 6dB）
+ * - 部分读取时隐藏采样不混入历史
+ * - 超过最大隐藏次数后输出静音
+ */
+
+#include <gtest/gtest.h>
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "audiomixerinput.h"
+
+namespace
+{
+constexpr int SAMPLE_RATE = 48000;
+constexpr int PERIOD = 480; // 10ms 混音周期
+constexpr int16_t LEVEL = 8000;
+
+QByteArray constantPcm(int16_t value, int count)
+{
+    std::vector<int16_t> samples(count, value);
+    return QByteArray(reinterpret_cast<const char *>(samples.data()),
+                      count * static_cast<int>(sizeof(int16_t)));
+}
+} // namespace
+
+// ==================== 测试夹具 ====================
+
+class AudioMixerInputTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        clock.start();
+        input = std::make_unique<AudioMixerInput>("p1", &clock, &outputRate);
+        out.assign(PERIOD, 0);
+    }
+
+    bool pull() { return input->pull(out.data(), PERIOD, SAMPLE_RATE, true); }
+
+    QElapsedTimer clock;
+    std::atomic<int> outputRate{SAMPLE_RATE};
+    std::unique_ptr<AudioMixerInput> input;
+    std::vector<int16_t> out;
+};
+
+// ==================== 丢包隐藏测试 ====================
+
+TEST_F(AudioMixerInputTest, ConcealAttenuatesSixDbPerUnderrun)
+{
+    // 两个周期的数据（= 20ms 目标深度），播放完后持续 underrun
+    input->push(constantPcm(LEVEL, PERIOD * 2), SAMPLE_RATE, 1);
+    ASSERT_TRUE(pull());
+    EXPECT_EQ(out.front(), LEVEL);
+    ASSERT_TRUE(pull());
+    EXPECT_EQ(out.back(), LEVEL);
+
+    // 第 n 次连续隐藏相对最后一帧真实数据衰减 6n dB（右移 n 位）
+    for (int n = 1; n <= 5; ++n)
+    {
+        ASSERT_TRUE(pull()) << "underrun " << n;
+        for (int16_t s : out)
+            ASSERT_EQ(s, LEVEL >> n) << "underrun " << n;
+    }
+
+    EXPECT_EQ(input->stats(SAMPLE_RATE).underruns, 5u);
+    EXPECT_EQ(input->stats(SAMPLE_RATE).concealedSamples, 5u * PERIOD);
+}
+
+TEST_F(AudioMixerInputTest, PartialReadDoesNotPolluteHistory)
+{
+    // 两个完整周期 + 半个周期的不同电平数据
+    QByteArray pcm = constantPcm(LEVEL, PERIOD * 2);
+    pcm.append(constantPcm(1200, PERIOD / 2));
+    input->push(pcm, SAMPLE_RATE, 1);
+    ASSERT_TRUE(pull());
+    ASSERT_TRUE(pull());
+
+    // 部分读取：前半为真实数据，后半用最后完整周期衰减 6dB 隐藏
+    ASSERT_TRUE(pull());
+    EXPECT_EQ(out[0], 1200);
+    EXPECT_EQ(out[PERIOD / 2 - 1], 1200);
+    EXPECT_EQ(out[PERIOD / 2], LEVEL >> 1);
+    EXPECT_EQ(out[PERIOD - 1], LEVEL >> 1);
+
+    // 下一次隐藏仍基于最后完整周期的真实数据，不含上一周期的隐藏采样
+    ASSERT_TRUE(pull());
+    for (int16_t s : out)
+        ASSERT_EQ(s, LEVEL >> 2);
+}
+
+TEST_F(AudioMixerInputTest, SilenceAfterMaxConcealment)
+{
+    input->push(constantPcm(LEVEL, PERIOD * 2), SAMPLE_RATE, 1);
+    ASSERT_TRUE(pull());
+    ASSERT_TRUE(pull());
+    for (int n = 1; n <= 5; ++n)
+        ASSERT_TRUE(pull());
+
+    // 第 6 次起视为对端停止发送：回到缓冲状态并输出静音
+    EXPECT_FALSE(pull());
+    for (int16_t s : out)
+        ASSERT_EQ(s, 0);
+}
@@ -0,0 +1,217 @@
+/**
+ * @file test_audio_resampler.cpp
+ * @brief AudioResampler 单元测试
+ *
+ * 测试内容：
+ * - 分块处理（含 1 个采样的极小块、随机块长）与一次性处理逐位一致
+ * - 输出长度符合 outRate/inRate 比例，且不超过 maxOutputSamples()
+ * - 通带正弦经重采样后的 SNR 与幅度（最小二乘拟合同频正弦，
+ *   与滤波器群延迟无关）
+ * - reset() 后与新建的重采样器结果一致
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "audioresampler.h"
+
+namespace
+{
+
+constexpr double PI = 3.14159265358979323846;
+
+struct RatePair
+{
+    int in;
+    int out;
+};
+
+// 远程参会者常见采样率 → 混音输出，以及降采样（ASR 16kHz）
+const RatePair RATE_PAIRS[] = {{16000, 48000}, {24000, 48000},
+                               {44100, 48000}, {48000, 44100},
+                               {48000, 16000}, {32000, 48000}};
+
+std::vector<int16_t> noise(int count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(-20000, 20000);
+    std::vector<int16_t> v(count);
+    for (int16_t &s : v)
+        s = static_cast<int16_t>(dist(rng));
+    return v;
+}
+
+std::vector<int16_t> sine(int count, double freq, int rate, double amplitude)
+{
+    std::vector<int16_t> v(count);
+    for (int i = 0; i < count; ++i)
+        v[i] = static_cast<int16_t>(
+            std::lround(amplitude * std::sin(2.0 * PI * freq * i / rate)));
+    return v;
+}
+
+std::vector<int16_t> resampleOneShot(const RatePair &rates,
+                                     const std::vector<int16_t> &in)
+{
+    AudioResampler r(rates.in, rates.out);
+    std::vector<int16_t> out(r.maxOutputSamples(static_cast<int>(in.size())));
+    const int n = r.process(in.data(), static_cast<int>(in.size()), out.data());
+    out.resize(n);
+    return out;
+}
+
+std::vector<int16_t> resampleChunked(AudioResampler &r,
+                                     const std::vector<int16_t> &in,
+                                     const std::vector<int> &chunks)
+{
+    std::vector<int16_t> out;
+    std::vector<int16_t> buf;
+    size_t pos = 0;
+    size_t c = 0;
+    while (pos < in.size())
+    {
+        const int len = std::min(chunks[c++ % chunks.size()],
+                                 static_cast<int>(in.size() - pos));
+        const int maxOut = r.maxOutputSamples(len);
+        buf.assign(maxOut, 0);
+        const int n = r.process(in.data() + pos, len, buf.data());
+        EXPECT_LE(n, maxOut);
+        out.insert(out.end(), buf.begin(), buf.begin() + n);
+        pos += len;
+    }
+    return out;
+}
+
+/**
+ * @brief 在 [begin, end) 上用最小二乘拟合 a·sin + b·cos，
+ *        返回 SNR（dB）并输出拟合幅度
+ */
+double fitSineSnrDb(const std::vector<int16_t> &x, double freq, int rate,
+                    size_t begin, size_t end, double *amplitude)
+{
+    double ss = 0, cc = 0, sc = 0, xs = 0, xc = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        const double w = 2.0 * PI * freq * static_cast<double>(i) / rate;
+        const double s = std::sin(w);
+        const double c = std::cos(w);
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        xs += x[i] * s;
+        xc += x[i] * c;
+    }
+    const double det = ss * cc - sc * sc;
+    const double a = (xs * cc - xc * sc) / det;
+    const double b = (xc * ss - xs * sc) / det;
+
+    double signal = 0, residual = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        const double w = 2.0 * PI * freq * static_cast<double>(i) / rate;
+        const double fit = a * std::sin(w) + b * std::cos(w);
+        signal += fit * fit;
+        residual += (x[i] - fit) * (x[i] - fit);
+    }
+    *amplitude = std::sqrt(a * a + b * b);
+    return 10.0 * std::log10(signal / std::max(residual, 1e-9));
+}
+
+} // namespace
+
+// ==================== 分块与一次性处理一致 ====================
+
+TEST(AudioResamplerTest, ChunkedMatchesOneShot)
+{
+    for (const RatePair &rates : RATE_PAIRS)
+    {
+        const std::vector<int16_t> in = noise(rates.in / 2, rates.in);
+        const std::vector<int16_t> expected = resampleOneShot(rates, in);
+
+        // 固定 10ms 块、1 个采样的极小块、以及随机块长
+        std::mt19937 rng(rates.out);
+        std::uniform_int_distribution<int> dist(1, 700);
+        std::vector<int> randomChunks(64);
+        for (int &len : randomChunks)
+            len = dist(rng);
+
+        for (const std::vector<int> &chunks :
+             {std::vector<int>{rates.in / 100}, std::vector<int>{1},
+              std::vector<int>{1, 2, 3, 160, 7}, randomChunks})
+        {
+            AudioResampler r(rates.in, rates.out);
+            const std::vector<int16_t> actual = resampleChunked(r, in, chunks);
+            ASSERT_EQ(actual, expected)
+                << rates.in << " -> " << rates.out
+                << " first chunk=" << chunks.front();
+        }
+    }
+}
+
+TEST(AudioResamplerTest, OutputLengthFollowsRateRatio)
+{
+    for (const RatePair &rates : RATE_PAIRS)
+    {
+        // 1 秒输入：输出长度与 outRate 相差不超过滤波器延迟带来的少量采样
+        AudioResampler r(rates.in, rates.out);
+        const std::vector<int16_t> out =
+            resampleChunked(r, noise(rates.in, 1), {rates.in / 100});
+        EXPECT_NEAR(static_cast<double>(out.size()), rates.out,
+                    rates.out * 0.01)
+            << rates.in << " -> " << rates.out;
+    }
+}
+
+TEST(AudioResamplerTest, ResetMatchesFreshInstance)
+{
+    const RatePair rates{44100, 48000};
+    const std::vector<int16_t> first = noise(4410, 3);
+    const std::vector<int16_t> second = noise(4410, 4);
+
+    AudioResampler reused(rates.in, rates.out);
+    resampleChunked(reused, first, {441});
+    reused.reset();
+    AudioResampler fresh(rates.in, rates.out);
+    EXPECT_EQ(resampleChunked(reused, second, {441}),
+              resampleChunked(fresh, second, {441}));
+}
+
+// ==================== 通带质量 ====================
+
+TEST(AudioResamplerTest, PassbandSineSnr)
+{
+    constexpr double AMPLITUDE = 16000.0;
+    // 半幅正弦的 int16 量化上限约 92dB，当前滤波器实测 80~90dB；
+    // 留 10dB 余量，滤波器长度 / 窗函数退化时即可发现
+    constexpr double MIN_SNR_DB = 70.0;
+
+    for (const RatePair &rates : RATE_PAIRS)
+    {
+        const int nyquist = std::min(rates.in, rates.out) / 2;
+        for (double freq : {440.0, 1000.0, nyquist * 0.6})
+        {
+            const std::vector<int16_t> in =
+                sine(rates.in, freq, rates.in, AMPLITUDE);
+            AudioResampler r(rates.in, rates.out);
+            const std::vector<int16_t> out =
+                resampleChunked(r, in, {rates.in / 100});
+
+            // 跳过首尾 50ms：滤波器启动瞬态
+            const size_t skip = static_cast<size_t>(rates.out / 20);
+            ASSERT_GT(out.size(), skip * 3);
+            double amplitude = 0.0;
+            const double snr = fitSineSnrDb(out, freq, rates.out, skip,
+                                            out.size() - skip, &amplitude);
+            EXPECT_GE(snr, MIN_SNR_DB)
+                << rates.in << " -> " << rates.out << " @ " << freq << "Hz";
+            // 通带增益误差 < 0.1dB
+            EXPECT_NEAR(20.0 * std::log10(amplitude / AMPLITUDE), 0.0, 0.1)
+                << rates.in << " -> " << rates.out << " @ " << freq << "Hz";
+        }
+    }
+}
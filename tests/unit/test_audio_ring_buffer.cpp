@@ -0,0 +1,212 @@
+/**
+ * @file test_audio_ring_buffer.cpp
+ * @brief AudioRingBuffer 单元测试
+ *
+ * 测试内容：
+ * - 容量向上取整到 2 的幂
+ * - 空 / 满边界
+ * - 跨越缓冲区末尾的回绕读写
+ * - 缓冲区满时的丢弃计数（droppedSamples）
+ * - skip() 推进读位置
+ * - 生产者 / 消费者线程并发读写的数据完整性
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "audioringbuffer.h"
+
+namespace
+{
+std::vector<int16_t> sequence(int count, int16_t start = 0)
+{
+    std::vector<int16_t> v(count);
+    std::iota(v.begin(), v.end(), start);
+    return v;
+}
+} // namespace
+
+// ==================== 容量 / 边界测试 ====================
+
+TEST(AudioRingBufferTest, CapacityRoundsUpToPowerOfTwo)
+{
+    EXPECT_EQ(AudioRingBuffer(100).capacity(), 128);
+    EXPECT_EQ(AudioRingBuffer(128).capacity(), 128);
+    EXPECT_EQ(AudioRingBuffer(0).capacity(), 2);
+}
+
+TEST(AudioRingBufferTest, InitiallyEmpty)
+{
+    AudioRingBuffer ring(16);
+    int16_t out[4] = {};
+    EXPECT_EQ(ring.available(), 0);
+    EXPECT_EQ(ring.freeSpace(), 16);
+    EXPECT_EQ(ring.read(out, 4), 0);
+    EXPECT_EQ(ring.skip(4), 0);
+    EXPECT_EQ(ring.droppedSamples(), 0u);
+}
+
+TEST(AudioRingBufferTest, FillToCapacityExactly)
+{
+    AudioRingBuffer ring(16);
+    const auto data = sequence(16);
+    EXPECT_EQ(ring.write(data.data(), 16), 16);
+    EXPECT_EQ(ring.available(), 16);
+    EXPECT_EQ(ring.freeSpace(), 0);
+    EXPECT_EQ(ring.droppedSamples(), 0u);
+
+    std::vector<int16_t> out(16);
+    EXPECT_EQ(ring.read(out.data(), 32), 16);
+    EXPECT_EQ(out, data);
+    EXPECT_EQ(ring.available(), 0);
+}
+
+TEST(AudioRingBufferTest, ZeroAndNegativeCountsAreNoOps)
+{
+    AudioRingBuffer ring(16);
+    int16_t buf[1] = {7};
+    EXPECT_EQ(ring.write(buf, 0), 0);
+    EXPECT_EQ(ring.write(buf, -3), 0);
+    EXPECT_EQ(ring.read(buf, -1), 0);
+    EXPECT_EQ(ring.skip(0), 0);
+    EXPECT_EQ(ring.available(), 0);
+    EXPECT_EQ(ring.droppedSamples(), 0u);
+}
+
+// ==================== 回绕测试 ====================
+
+TEST(AudioRingBufferTest, WrapAroundPreservesOrder)
+{
+    AudioRingBuffer ring(16);
+    std::vector<int16_t> out(16);
+
+    // 先把读写位置推进到末尾附近，之后的写入必然跨越末尾
+    const auto head = sequence(12);
+    ASSERT_EQ(ring.write(head.data(), 12), 12);
+    ASSERT_EQ(ring.read(out.data(), 12), 12);
+
+    const auto data = sequence(10, 100);
+    EXPECT_EQ(ring.write(data.data(), 10), 10);
+    EXPECT_EQ(ring.available(), 10);
+
+    out.assign(10, 0);
+    EXPECT_EQ(ring.read(out.data(), 10), 10);
+    EXPECT_EQ(out, data);
+}
+
+TEST(AudioRingBufferTest, RepeatedWrapAroundOverManyLaps)
+{
+    AudioRingBuffer ring(16);
+    int16_t next = 0;
+    int16_t expected = 0;
+    std::vector<int16_t> out(7);
+
+    // 块长与容量互质，读写位置在每一圈落在不同偏移上
+    for (int lap = 0; lap < 100; ++lap)
+    {
+        const auto chunk = sequence(7, next);
+        ASSERT_EQ(ring.write(chunk.data(), 7), 7);
+        next = static_cast<int16_t>(next + 7);
+        ASSERT_EQ(ring.read(out.data(), 7), 7);
+        for (int16_t s : out)
+            ASSERT_EQ(s, expected++);
+    }
+    EXPECT_EQ(ring.droppedSamples(), 0u);
+}
+
+// ==================== 丢弃计数测试 ====================
+
+TEST(AudioRingBufferTest, OverflowDropsNewestAndCounts)
+{
+    AudioRingBuffer ring(16);
+    const auto first = sequence(10);
+    const auto second = sequence(10, 10);
+
+    EXPECT_EQ(ring.write(first.data(), 10), 10);
+    // 只剩 6 个空位：写入前 6 个，其余 4 个丢弃
+    EXPECT_EQ(ring.write(second.data(), 10), 6);
+    EXPECT_EQ(ring.droppedSamples(), 4u);
+
+    // 已满时整块丢弃
+    EXPECT_EQ(ring.write(second.data(), 5), 0);
+    EXPECT_EQ(ring.droppedSamples(), 9u);
+
+    // 已缓存的数据不受影响：保留最旧的 16 个
+    std::vector<int16_t> out(16);
+    EXPECT_EQ(ring.read(out.data(), 16), 16);
+    EXPECT_EQ(out, sequence(16));
+}
+
+TEST(AudioRingBufferTest, SkipAdvancesReadPosition)
+{
+    AudioRingBuffer ring(16);
+    const auto data = sequence(10);
+    ring.write(data.data(), 10);
+
+    EXPECT_EQ(ring.skip(4), 4);
+    EXPECT_EQ(ring.available(), 6);
+
+    int16_t out[2] = {};
+    EXPECT_EQ(ring.read(out, 2), 2);
+    EXPECT_EQ(out[0], 4);
+    EXPECT_EQ(out[1], 5);
+
+    // 超过可读数时只丢弃可读部分，且不计入 droppedSamples
+    EXPECT_EQ(ring.skip(100), 4);
+    EXPECT_EQ(ring.available(), 0);
+    EXPECT_EQ(ring.droppedSamples(), 0u);
+}
+
+// ==================== 并发测试 ====================
+
+TEST(AudioRingBufferTest, ConcurrentProducerConsumerKeepsOrder)
+{
+    constexpr int TOTAL = 200000;
+    AudioRingBuffer ring(256);
+
+    std::thread producer([&ring]()
+                         {
+        int16_t next = 0;
+        int written = 0;
+        while (written < TOTAL)
+        {
+            const int n = std::min(37, TOTAL - written);
+            const auto chunk = sequence(n, next);
+            // 空间不足时等待，不丢数据
+            if (ring.freeSpace() < n)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            ASSERT_EQ(ring.write(chunk.data(), n), n);
+            next = static_cast<int16_t>(next + n);
+            written += n;
+        } });
+
+    // 先收集全部数据，join 之后再比对（断言失败提前返回会遗留线程）
+    std::vector<int16_t> received;
+    received.reserve(TOTAL);
+    std::vector<int16_t> out(64);
+    while (static_cast<int>(received.size()) < TOTAL)
+    {
+        const int n = ring.read(out.data(), 64);
+        if (n == 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        received.insert(received.end(), out.begin(), out.begin() + n);
+    }
+    producer.join();
+
+    int16_t expected = 0;
+    for (int i = 0; i < TOTAL; ++i)
+        ASSERT_EQ(received[i], expected++) << "at sample " << i;
+    EXPECT_EQ(ring.droppedSamples(), 0u);
+    EXPECT_EQ(ring.available(), 0);
+}
@@ -0,0 +1,214 @@
+/**
+ * @file test_bounded_queue.cpp
+ * @brief BoundedQueue 单元测试
+ *
+ * 测试内容：
+ * - FIFO 顺序与容量
+ * - tryPush() 满时立即失败，push() 满时阻塞直到消费者取走
+ * - close()：唤醒阻塞的生产者 / 消费者；之后拒绝入队，
+ *   但已入队的元素仍可取完（drain），取空后 pop() 返回 false
+ * - reset() 清空并重新打开
+ * - 排队时长与最大深度统计
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "boundedqueue.h"
+
+using namespace std::chrono_literals;
+
+// ==================== 基本语义 ====================
+
+TEST(BoundedQueueTest, FifoOrder)
+{
+    BoundedQueue<int> queue(4);
+    for (int i = 0; i < 4; ++i)
+        ASSERT_TRUE(queue.push(i));
+    EXPECT_EQ(queue.size(), 4);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        int value = -1;
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_EQ(queue.size(), 0);
+}
+
+TEST(BoundedQueueTest, CapacityIsAtLeastOne)
+{
+    EXPECT_EQ(BoundedQueue<int>(0).capacity(), 1);
+    EXPECT_EQ(BoundedQueue<int>(-5).capacity(), 1);
+}
+
+TEST(BoundedQueueTest, TryPushFailsWhenFull)
+{
+    BoundedQueue<int> queue(2);
+    EXPECT_TRUE(queue.tryPush(1));
+    EXPECT_TRUE(queue.tryPush(2));
+    EXPECT_FALSE(queue.tryPush(3));
+    EXPECT_EQ(queue.size(), 2);
+
+    int value = 0;
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_TRUE(queue.tryPush(3));
+}
+
+TEST(BoundedQueueTest, MoveOnlyItems)
+{
+    BoundedQueue<std::unique_ptr<int>> queue(2);
+    ASSERT_TRUE(queue.push(std::make_unique<int>(7)));
+    std::unique_ptr<int> out;
+    ASSERT_TRUE(queue.pop(out));
+    ASSERT_TRUE(out);
+    EXPECT_EQ(*out, 7);
+}
+
+// ==================== 反压 ====================
+
+TEST(BoundedQueueTest, PushBlocksUntilConsumerPops)
+{
+    BoundedQueue<int> queue(1);
+    ASSERT_TRUE(queue.push(1));
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&]()
+                         {
+        queue.push(2);
+        pushed = true; });
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(pushed.load()) << "队列满时 push() 应阻塞";
+
+    int value = 0;
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 1);
+    producer.join();
+    EXPECT_TRUE(pushed.load());
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 2);
+}
+
+// ==================== close / drain ====================
+
+TEST(BoundedQueueTest, CloseDrainsRemainingItems)
+{
+    BoundedQueue<int> queue(4);
+    queue.push(1);
+    queue.push(2);
+    queue.close();
+
+    // 关闭后拒绝入队
+    EXPECT_FALSE(queue.push(3));
+    EXPECT_FALSE(queue.tryPush(3));
+
+    // 已入队的元素仍按顺序取出，取空后返回 false（不阻塞）
+    int value = 0;
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 1);
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_FALSE(queue.pop(value));
+}
+
+TEST(BoundedQueueTest, CloseWakesBlockedConsumer)
+{
+    BoundedQueue<int> queue(2);
+    std::atomic<int> result{-1};
+    std::thread consumer([&]()
+                         {
+        int value = 0;
+        result = queue.pop(value) ? 1 : 0; });
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(result.load(), -1) << "空队列 pop() 应阻塞";
+    queue.close();
+    consumer.join();
+    EXPECT_EQ(result.load(), 0);
+}
+
+TEST(BoundedQueueTest, CloseWakesBlockedProducer)
+{
+    BoundedQueue<int> queue(1);
+    queue.push(1);
+    std::atomic<int> result{-1};
+    std::thread producer([&]()
+                         { result = queue.push(2) ? 1 : 0; });
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(result.load(), -1) << "满队列 push() 应阻塞";
+    queue.close();
+    producer.join();
+    EXPECT_EQ(result.load(), 0);
+
+    // 被拒绝的元素不入队，原有元素仍可取出
+    int value = 0;
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_FALSE(queue.pop(value));
+}
+
+TEST(BoundedQueueTest, ConcurrentDrainDeliversEverythingOnce)
+{
+    constexpr int TOTAL = 20000;
+    BoundedQueue<int> queue(4);
+    std::atomic<long long> sum{0};
+    std::atomic<int> count{0};
+
+    std::thread consumer([&]()
+                         {
+        int value = 0;
+        while (queue.pop(value))
+        {
+            sum += value;
+            ++count;
+        } });
+
+    for (int i = 1; i <= TOTAL; ++i)
+        ASSERT_TRUE(queue.push(i));
+    queue.close();
+    consumer.join();
+
+    EXPECT_EQ(count.load(), TOTAL);
+    EXPECT_EQ(sum.load(), static_cast<long long>(TOTAL) * (TOTAL + 1) / 2);
+}
+
+TEST(BoundedQueueTest, ResetReopensEmptyQueue)
+{
+    BoundedQueue<int> queue(2);
+    queue.push(1);
+    queue.push(2);
+    queue.close();
+    queue.reset();
+
+    EXPECT_EQ(queue.size(), 0);
+    EXPECT_EQ(queue.maxDepth(), 0);
+    EXPECT_TRUE(queue.tryPush(3));
+    int value = 0;
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 3);
+}
+
+// ==================== 统计 ====================
+
+TEST(BoundedQueueTest, ReportsWaitTimeAndMaxDepth)
+{
+    BoundedQueue<int> queue(4);
+    queue.push(1);
+    queue.push(2);
+    queue.push(3);
+    EXPECT_EQ(queue.maxDepth(), 3);
+
+    std::this_thread::sleep_for(20ms);
+    int value = 0;
+    qint64 waitUs = -1;
+    ASSERT_TRUE(queue.pop(value, &waitUs));
+    EXPECT_GE(waitUs, 20000);
+    EXPECT_EQ(queue.maxDepth(), 3); // 出队不降低历史最大深度
+}
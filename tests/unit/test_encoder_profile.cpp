@@ -0,0 +1,211 @@
+/**
+ * @file test_encoder_profile.cpp
+ * @brief EncoderProfile / EncoderCalibrator 单元测试
+ *
+ * 测试内容：
+ * - toString() / fromString() 往返（保存到 QSettings 后再读回）
+ * - 拒绝格式错误或未知编码器的字符串，失败时返回默认配置
+ * - EncoderCalibrator::pick()：用构造的测量结果验证选择规则，无需实际编码
+ */
+
+#include <gtest/gtest.h>
+
+#include <QString>
+#include <QStringList>
+
+#include "encoderprofile.h"
+
+namespace
+{
+
+EncoderProfile makeProfile(EncoderProfile::Codec codec, const QString &preset,
+                           int crf = 23)
+{
+    EncoderProfile p;
+    p.codec = codec;
+    p.preset = preset;
+    p.crf = crf;
+    return p;
+}
+
+EncoderCalibrator::Result makeResult(const EncoderProfile &profile,
+                                     bool available, double encodeFps,
+                                     double cpuMsPerFrame, bool realtime)
+{
+    EncoderCalibrator::Result r;
+    r.profile = profile;
+    r.available = available;
+    r.encodeFps = encodeFps;
+    r.cpuMsPerFrame = cpuMsPerFrame;
+    r.realtime = realtime;
+    return r;
+}
+
+} // namespace
+
+// ==================== 序列化 ====================
+
+TEST(EncoderProfileTest, DefaultProfileString)
+{
+    EXPECT_EQ(EncoderProfile().toString(), QStringLiteral("h264/fast/crf23/t0"));
+}
+
+TEST(EncoderProfileTest, RoundTripDefaultCandidates)
+{
+    const QList<EncoderProfile> candidates = EncoderProfile::defaultCandidates();
+    ASSERT_FALSE(candidates.isEmpty());
+    for (const EncoderProfile &profile : candidates)
+    {
+        bool ok = false;
+        const EncoderProfile parsed =
+            EncoderProfile::fromString(profile.toString(), &ok);
+        EXPECT_TRUE(ok) << qPrintable(profile.toString());
+        EXPECT_EQ(parsed, profile) << qPrintable(profile.toString());
+    }
+}
+
+TEST(EncoderProfileTest, RoundTripBitrateAndThreads)
+{
+    EncoderProfile profile = makeProfile(EncoderProfile::Codec::Av1, "10");
+    profile.rateControl = EncoderProfile::RateControl::Bitrate;
+    profile.bitrateKbps = 4000;
+    profile.threads = 8;
+    EXPECT_EQ(profile.toString(), QStringLiteral("av1/10/4000k/t8"));
+
+    bool ok = false;
+    const EncoderProfile parsed =
+        EncoderProfile::fromString(profile.toString(), &ok);
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(parsed, profile);
+}
+
+TEST(EncoderProfileTest, ParsesFields)
+{
+    bool ok = false;
+    const EncoderProfile p =
+        EncoderProfile::fromString(QStringLiteral("hevc/veryfast/crf28/t4"), &ok);
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(p.codec, EncoderProfile::Codec::Hevc);
+    EXPECT_EQ(p.preset, QStringLiteral("veryfast"));
+    EXPECT_EQ(p.rateControl, EncoderProfile::RateControl::Crf);
+    EXPECT_EQ(p.crf, 28);
+    EXPECT_EQ(p.threads, 4);
+    EXPECT_STREQ(p.encoderName(), "libx265");
+}
+
+TEST(EncoderProfileTest, TrimsSurroundingWhitespace)
+{
+    bool ok = false;
+    EncoderProfile::fromString(QStringLiteral("  h264/ultrafast/crf23/t0\n"), &ok);
+    EXPECT_TRUE(ok);
+}
+
+TEST(EncoderProfileTest, RejectsMalformedStrings)
+{
+    const QStringList malformed = {
+        QString(),
+        QStringLiteral("h264"),
+        QStringLiteral("h264/fast/crf23"),          // 缺少线程字段
+        QStringLiteral("h264/fast/crf23/t0/extra"), // 多余字段
+        QStringLiteral("vp9/fast/crf23/t0"),        // 未知编码器
+        QStringLiteral("H264/fast/crf23/t0"),       // 编码器名区分大小写
+        QStringLiteral("h264//crf23/t0"),           // 空预设
+        QStringLiteral("h264/fast/crf/t0"),         // crf 缺少数值
+        QStringLiteral("h264/fast/crfx/t0"),
+        QStringLiteral("h264/fast/23/t0"),          // 未知码控
+        QStringLiteral("h264/fast/0k/t0"),          // 码率须为正
+        QStringLiteral("h264/fast/abck/t0"),
+        QStringLiteral("h264/fast/crf23/4"),        // 线程数缺少 t 前缀
+        QStringLiteral("h264/fast/crf23/t"),
+        QStringLiteral("h264/fast/crf23/t-1"),      // 线程数不能为负
+    };
+
+    for (const QString &text : malformed)
+    {
+        bool ok = true;
+        const EncoderProfile p = EncoderProfile::fromString(text, &ok);
+        EXPECT_FALSE(ok) << qPrintable(text);
+        EXPECT_EQ(p, EncoderProfile()) << "失败时应返回默认配置: "
+                                       << qPrintable(text);
+    }
+}
+
+TEST(EncoderProfileTest, OkPointerIsOptional)
+{
+    EXPECT_EQ(EncoderProfile::fromString(QStringLiteral("garbage")),
+              EncoderProfile());
+    EXPECT_EQ(EncoderProfile::fromString(QStringLiteral("av1/12/crf35/t0")).codec,
+              EncoderProfile::Codec::Av1);
+}
+
+TEST(EncoderProfileTest, EncoderNames)
+{
+    EXPECT_STREQ(makeProfile(EncoderProfile::Codec::H264, "fast").encoderName(),
+                 "libx264");
+    EXPECT_STREQ(makeProfile(EncoderProfile::Codec::Hevc, "fast").encoderName(),
+                 "libx265");
+    EXPECT_STREQ(makeProfile(EncoderProfile::Codec::Av1, "10").encoderName(),
+                 "libsvtav1");
+}
+
+// ==================== 选择规则 ====================
+
+TEST(EncoderCalibratorTest, PicksLowestCpuAmongRealtime)
+{
+    const EncoderProfile fast = makeProfile(EncoderProfile::Codec::H264, "fast");
+    const EncoderProfile veryfast =
+        makeProfile(EncoderProfile::Codec::H264, "veryfast");
+    const EncoderProfile hevc =
+        makeProfile(EncoderProfile::Codec::Hevc, "ultrafast", 28);
+    const EncoderProfile av1 = makeProfile(EncoderProfile::Codec::Av1, "12", 35);
+
+    const QList<EncoderCalibrator::Result> results = {
+        makeResult(fast, true, 45.0, 20.0, true),
+        makeResult(veryfast, true, 90.0, 8.0, true),
+        // CPU 更低但跑不满实时：不应选中
+        makeResult(hevc, true, 25.0, 4.0, false),
+        // 编码器不可用：即使数值最好也不应选中
+        makeResult(av1, false, 500.0, 0.5, true),
+    };
+    EXPECT_EQ(EncoderCalibrator::pick(results), veryfast);
+}
+
+TEST(EncoderCalibratorTest, PrefersCpuOverThroughputWhenBothRealtime)
+{
+    const EncoderProfile a = makeProfile(EncoderProfile::Codec::H264, "superfast");
+    const EncoderProfile b = makeProfile(EncoderProfile::Codec::H264, "ultrafast");
+    // b 吞吐更高，但 a 每帧 CPU 更少（如编码器线程更少），选 a
+    const QList<EncoderCalibrator::Result> results = {
+        makeResult(a, true, 60.0, 6.0, true),
+        makeResult(b, true, 200.0, 7.0, true),
+    };
+    EXPECT_EQ(EncoderCalibrator::pick(results), a);
+}
+
+TEST(EncoderCalibratorTest, FallsBackToHighestThroughputWithoutRealtime)
+{
+    const EncoderProfile slow = makeProfile(EncoderProfile::Codec::H264, "fast");
+    const EncoderProfile faster =
+        makeProfile(EncoderProfile::Codec::H264, "ultrafast");
+    const QList<EncoderCalibrator::Result> results = {
+        makeResult(slow, true, 12.0, 30.0, false),
+        makeResult(faster, true, 24.0, 40.0, false),
+        makeResult(makeProfile(EncoderProfile::Codec::Av1, "12"), false, 99.0,
+                   1.0, false),
+    };
+    EXPECT_EQ(EncoderCalibrator::pick(results), faster);
+}
+
+TEST(EncoderCalibratorTest, ReturnsFallbackWhenNothingAvailable)
+{
+    const EncoderProfile fallback =
+        makeProfile(EncoderProfile::Codec::H264, "veryfast");
+    EXPECT_EQ(EncoderCalibrator::pick({}, fallback), fallback);
+    EXPECT_EQ(EncoderCalibrator::pick({}), EncoderProfile());
+
+    const QList<EncoderCalibrator::Result> results = {
+        makeResult(makeProfile(EncoderProfile::Codec::Hevc, "fast"), false, 0.0,
+                   0.0, false),
+    };
+    EXPECT_EQ(EncoderCalibrator::pick(results, fallback), fallback);
+}
@@ -0,0 +1,249 @@
+/**
+ * @file test_packet_interleaver.cpp
+ * @brief PacketInterleaver 单元测试
+ *
+ * 测试内容：
+ * - 多通道按 DTS 从小到大交织输出
+ * - 空通道未结束时等待；finish() 之后不再等待
+ * - 水位线：空通道沉默超过 maxLookahead 后放行落后的 packet
+ * - 通道已满（anyFull）时不再等待空通道，生产者不会被永久阻塞
+ * - 通道满时 push() 失败、所有权留在调用方
+ * - isDrained() / size() / maxDepth() / reset()
+ * - 两个生产者线程并发写入：每个 packet 恰好取出一次，通道内顺序不变
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "packetinterleaver.h"
+
+namespace
+{
+
+enum Lane
+{
+    Video = 0,
+    Audio = 1
+};
+
+constexpr qint64 NO_LOOKAHEAD_LIMIT = std::numeric_limits<qint64>::max() / 4;
+
+PacketInterleaver::Entry makeEntry(qint64 dtsUs)
+{
+    PacketInterleaver::Entry entry;
+    entry.packet = av_packet_alloc();
+    entry.dtsUs = dtsUs;
+    return entry;
+}
+
+// 取出当前所有可写的 packet，返回其 DTS 序列
+std::vector<qint64> popAll(PacketInterleaver &interleaver)
+{
+    std::vector<qint64> dts;
+    PacketInterleaver::Entry entry;
+    while (interleaver.pop(entry))
+    {
+        dts.push_back(entry.dtsUs);
+        av_packet_free(&entry.packet);
+    }
+    return dts;
+}
+
+} // namespace
+
+// ==================== DTS 交织 ====================
+
+TEST(PacketInterleaverTest, InterleavesByDtsAcrossLanes)
+{
+    PacketInterleaver interleaver(2);
+    interleaver.setMaxLookaheadUs(NO_LOOKAHEAD_LIMIT);
+
+    // 视频 30fps、音频 AAC 21.3ms 一帧，各自单调，跨通道交错
+    for (qint64 dts : {0, 33333, 66666, 100000})
+        ASSERT_TRUE(interleaver.push(Video, makeEntry(dts)));
+    for (qint64 dts : {0, 21333, 42666, 64000, 85333, 106666})
+        ASSERT_TRUE(interleaver.push(Audio, makeEntry(dts)));
+    EXPECT_EQ(interleaver.size(), 10);
+
+    // 两侧都有排队时按 DTS 输出；视频取空后等待视频（音频 106666 留在队列）
+    const std::vector<qint64> out = popAll(interleaver);
+    EXPECT_TRUE(std::is_sorted(out.begin(), out.end()));
+    EXPECT_EQ(out.size(), 9u);
+    EXPECT_EQ(out.back(), 100000);
+
+    interleaver.finish(Video);
+    EXPECT_EQ(popAll(interleaver), std::vector<qint64>{106666});
+    EXPECT_FALSE(interleaver.isDrained());
+    interleaver.finish(Audio);
+    EXPECT_TRUE(interleaver.isDrained());
+}
+
+TEST(PacketInterleaverTest, WaitsForEmptyUnfinishedLane)
+{
+    PacketInterleaver interleaver(2);
+    interleaver.setMaxLookaheadUs(NO_LOOKAHEAD_LIMIT);
+    interleaver.push(Video, makeEntry(0));
+    interleaver.push(Video, makeEntry(33333));
+
+    // 音频可能还会送来更早的 packet，不能先写视频
+    EXPECT_TRUE(popAll(interleaver).empty());
+
+    interleaver.push(Audio, makeEntry(10000));
+    EXPECT_EQ(popAll(interleaver), (std::vector<qint64>{0, 10000}));
+
+    // 音频结束：剩余视频直接放行
+    interleaver.finish(Audio);
+    EXPECT_EQ(popAll(interleaver), std::vector<qint64>{33333});
+}
+
+// ==================== 水位线 ====================
+
+TEST(PacketInterleaverTest, WatermarkReleasesWhenLaneGoesSilent)
+{
+    constexpr qint64 LOOKAHEAD = 100000; // 100ms
+    PacketInterleaver interleaver(2);
+    interleaver.setMaxLookaheadUs(LOOKAHEAD);
+
+    // 麦克风静音：只有视频在走
+    interleaver.push(Video, makeEntry(0));
+    interleaver.push(Video, makeEntry(50000));
+    EXPECT_TRUE(popAll(interleaver).empty()) << "未超过水位线时应等待音频";
+
+    // 最新 DTS 推进到 150ms：早于 50ms（含）的 packet 放行
+    interleaver.push(Video, makeEntry(150000));
+    EXPECT_EQ(popAll(interleaver), (std::vector<qint64>{0, 50000}));
+
+    // 音频恢复后重新按 DTS 交织
+    interleaver.push(Audio, makeEntry(120000));
+    EXPECT_EQ(popAll(interleaver), std::vector<qint64>{120000});
+    EXPECT_TRUE(popAll(interleaver).empty()) << "视频 150ms 应等待音频";
+
+    interleaver.push(Audio, makeEntry(160000));
+    EXPECT_EQ(popAll(interleaver), std::vector<qint64>{150000});
+}
+
+TEST(PacketInterleaverTest, ZeroLookaheadReleasesImmediately)
+{
+    PacketInterleaver interleaver(2);
+    interleaver.setMaxLookaheadUs(0);
+    interleaver.push(Video, makeEntry(0));
+    EXPECT_EQ(popAll(interleaver), std::vector<qint64>{0});
+    EXPECT_EQ(interleaver.maxLookaheadUs(), 0);
+
+    interleaver.setMaxLookaheadUs(-5); // 负值按 0 处理
+    EXPECT_EQ(interleaver.maxLookaheadUs(), 0);
+}
+
+// ==================== 满通道 ====================
+
+TEST(PacketInterleaverTest, FullLaneBypassesWaiting)
+{
+    PacketInterleaver interleaver(2, 4);
+    interleaver.setMaxLookaheadUs(NO_LOOKAHEAD_LIMIT);
+
+    for (qint64 dts = 0; dts < 3; ++dts)
+        ASSERT_TRUE(interleaver.push(Video, makeEntry(dts)));
+    EXPECT_TRUE(popAll(interleaver).empty());
+
+    // 第 4 个填满通道：音频仍为空，但不再等待，放行一个腾出空间
+    ASSERT_TRUE(interleaver.push(Video, makeEntry(3)));
+    PacketInterleaver::Entry entry;
+    ASSERT_TRUE(interleaver.pop(entry));
+    EXPECT_EQ(entry.dtsUs, 0);
+    av_packet_free(&entry.packet);
+
+    // 不再满：恢复等待音频
+    EXPECT_FALSE(interleaver.pop(entry));
+    EXPECT_EQ(interleaver.size(), 3);
+}
+
+TEST(PacketInterleaverTest, PushFailsWhenLaneFullAndKeepsOwnership)
+{
+    PacketInterleaver interleaver(2, 4);
+    for (qint64 dts = 0; dts < 4; ++dts)
+        ASSERT_TRUE(interleaver.push(Video, makeEntry(dts)));
+
+    PacketInterleaver::Entry extra = makeEntry(4);
+    EXPECT_FALSE(interleaver.push(Video, extra));
+    ASSERT_NE(extra.packet, nullptr);
+    av_packet_free(&extra.packet);
+
+    // 另一条通道不受影响
+    EXPECT_TRUE(interleaver.push(Audio, makeEntry(0)));
+    EXPECT_EQ(interleaver.size(), 5);
+    EXPECT_EQ(interleaver.maxDepth(), 5);
+}
+
+// ==================== 状态 ====================
+
+TEST(PacketInterleaverTest, ResetFreesPacketsAndReopens)
+{
+    PacketInterleaver interleaver(2, 8);
+    interleaver.push(Video, makeEntry(0));
+    interleaver.push(Audio, makeEntry(0));
+    interleaver.finish(Video);
+    interleaver.finish(Audio);
+
+    interleaver.reset(); // 残留 packet 由 reset() 释放
+    EXPECT_EQ(interleaver.size(), 0);
+    EXPECT_EQ(interleaver.maxDepth(), 0);
+    EXPECT_FALSE(interleaver.isDrained()) << "reset() 后通道重新打开";
+
+    interleaver.setMaxLookaheadUs(NO_LOOKAHEAD_LIMIT);
+    interleaver.push(Video, makeEntry(5));
+    EXPECT_TRUE(popAll(interleaver).empty()) << "reset() 后应重新等待音频";
+    interleaver.finish(Audio);
+    EXPECT_EQ(popAll(interleaver), std::vector<qint64>{5});
+}
+
+// ==================== 并发 ====================
+
+TEST(PacketInterleaverTest, ConcurrentProducersDeliverEverythingOnce)
+{
+    constexpr int PER_LANE = 20000;
+    PacketInterleaver interleaver(2, 64);
+    interleaver.setMaxLookaheadUs(NO_LOOKAHEAD_LIMIT);
+
+    auto produce = [&interleaver](int lane, qint64 step)
+    {
+        for (int i = 0; i < PER_LANE; ++i)
+        {
+            PacketInterleaver::Entry entry = makeEntry(i * step);
+            entry.queuedAtUs = lane; // 借用入队时间字段标记来源通道
+            while (!interleaver.push(lane, entry))
+                std::this_thread::yield();
+        }
+        interleaver.finish(lane);
+    };
+    std::thread video(produce, Video, 33333);
+    std::thread audio(produce, Audio, 21333);
+
+    std::vector<qint64> lastDts(2, -1);
+    std::vector<int> count(2, 0);
+    bool lanesInOrder = true;
+    PacketInterleaver::Entry entry;
+    while (!interleaver.isDrained())
+    {
+        if (!interleaver.pop(entry))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        const int lane = static_cast<int>(entry.queuedAtUs);
+        lanesInOrder = lanesInOrder && entry.dtsUs > lastDts[lane];
+        lastDts[lane] = entry.dtsUs;
+        ++count[lane];
+        av_packet_free(&entry.packet);
+    }
+    video.join();
+    audio.join();
+
+    EXPECT_TRUE(lanesInOrder);
+    EXPECT_EQ(count[Video], PER_LANE);
+    EXPECT_EQ(count[Audio], PER_LANE);
+    EXPECT_EQ(interleaver.size(), 0);
+}
@@ -0,0 +1,419 @@
+/**
+ * @file test_video_compositor.cpp
+ * @brief VideoCompositor 单元测试（offscreen 平台，无需显示器）
+ *
+ * 测试内容：
+ * - 各布局（网格 / 屏幕共享 / 演讲者 / 分页）的合成画面与金样图比对
+ * - 增量合成：无新帧时跳过单元格、画布不变
+ * - 合成前被覆盖的帧计数
+ * - 输出帧池耗尽时跳过 tick、释放后复用
+ * - 单元格尺寸回传（tileSizeChanged）
+ * - YUV420P 输出的尺寸与像素值、亮度与 ARGB 金样图一致、黑边
+ *
+ * 金样图位于 tests/golden/video_compositor/，缺失即失败。首次生成或布局
+ * 有意变化时设置环境变量 VIDEO_COMPOSITOR_UPDATE_GOLDEN=1 运行本测试重新
+ * 生成，并把 PNG 提交到仓库。比对失败时实际画面写到测试工作目录的
+ * <name>.actual.png。
+ *
+ * 合成输入为确定性的渐变色块，且不设置显示名称（名称标签依赖系统字体，
+ * 不适合做像素比对），允许每通道 ±GOLDEN_TOLERANCE 的缩放误差。
+ */
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QGuiApplication>
+#include <QImage>
+#include <QPainter>
+#include <QSignalSpy>
+
+#include "videocompositor.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+
+constexpr int OUTPUT_WIDTH = 640;
+constexpr int OUTPUT_HEIGHT = 360;
+constexpr int GOLDEN_TOLERANCE = 3;          // 每通道允许的最大差值
+constexpr double GOLDEN_MAX_MISMATCH = 0.001; // 超差像素占比上限
+
+// 参会者标识补零，保证 QMap 顺序与数值顺序一致
+QString participantId(int index)
+{
+    return QStringLiteral("p%1").arg(index, 2, 10, QLatin1Char('0'));
+}
+
+// 每个参会者一张不同色调的渐变图 + 中心色块
+QImage makeFrame(int index, int width = 320, int height = 180)
+{
+    QImage img(width, height, QImage::Format_ARGB32);
+    const int r = (index * 53) % 256;
+    const int g = (index * 97 + 80) % 256;
+    const int b = (index * 151 + 160) % 256;
+    for (int y = 0; y < height; ++y)
+    {
+        auto *line = reinterpret_cast<QRgb *>(img.scanLine(y));
+        for (int x = 0; x < width; ++x)
+            line[x] = qRgb((r + x * 128 / width) % 256,
+                           (g + y * 128 / height) % 256, b);
+    }
+    QPainter p(&img);
+    p.fillRect(width / 4, height / 4, width / 2, height / 2,
+               QColor(255 - r, 255 - g, 255 - b));
+    return img;
+}
+
+// 同步合成一帧并取出 ARGB 画面
+QImage compositeOnce(VideoCompositor &compositor)
+{
+    QImage output;
+    auto connection = QObject::connect(
+        &compositor, &VideoCompositor::compositeFrameReady,
+        [&output](const QImage &frame, qint64) { output = frame.copy(); });
+    compositor.compositeNow();
+    QObject::disconnect(connection);
+    return output;
+}
+
+// 与金样图比对；仅在要求更新时写入金样图，缺失视为失败
+void expectMatchesGolden(const QString &name, const QImage &actual)
+{
+    ASSERT_FALSE(actual.isNull());
+
+    const QDir dir(QStringLiteral(VIDEO_COMPOSITOR_GOLDEN_DIR));
+    const QString path = dir.filePath(name + QStringLiteral(".png"));
+    const QImage image = actual.convertToFormat(QImage::Format_RGB32);
+
+    if (!qEnvironmentVariableIsEmpty("VIDEO_COMPOSITOR_UPDATE_GOLDEN"))
+    {
+        ASSERT_TRUE(QDir().mkpath(dir.absolutePath()));
+        ASSERT_TRUE(image.save(path));
+        std::printf("[ golden   ] 已生成金样图: %s\n", qPrintable(path));
+        return;
+    }
+
+    if (!QFile::exists(path))
+    {
+        image.save(name + QStringLiteral(".actual.png"));
+        FAIL() << "缺少金样图: " << qPrintable(path)
+               << "（设置 VIDEO_COMPOSITOR_UPDATE_GOLDEN=1 生成后提交）";
+    }
+
+    const QImage golden =
+        QImage(path).convertToFormat(QImage::Format_RGB32);
+    ASSERT_FALSE(golden.isNull()) << "无法读取金样图: " << qPrintable(path);
+    ASSERT_EQ(golden.size(), image.size()) << qPrintable(name);
+
+    qint64 mismatched = 0;
+    int maxDiff = 0;
+    for (int y = 0; y < image.height(); ++y)
+    {
+        const auto *a = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        const auto *e = reinterpret_cast<const QRgb *>(golden.constScanLine(y));
+        for (int x = 0; x < image.width(); ++x)
+        {
+            const int diff = std::max({std::abs(qRed(a[x]) - qRed(e[x])),
+                                       std::abs(qGreen(a[x]) - qGreen(e[x])),
+                                       std::abs(qBlue(a[x]) - qBlue(e[x]))});
+            maxDiff = std::max(maxDiff, diff);
+            if (diff > GOLDEN_TOLERANCE)
+                ++mismatched;
+        }
+    }
+
+    const double ratio = static_cast<double>(mismatched) /
+                         (static_cast<double>(image.width()) * image.height());
+    if (ratio > GOLDEN_MAX_MISMATCH)
+        image.save(name + QStringLiteral(".actual.png"));
+    EXPECT_LE(ratio, GOLDEN_MAX_MISMATCH)
+        << qPrintable(name) << ": " << mismatched << " 个像素超差, 最大差值 "
+        << maxDiff;
+}
+
+} // namespace
+
+// ==================== 测试夹具 ====================
+
+class VideoCompositorTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        if (!QGuiApplication::instance())
+        {
+            if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+                qputenv("QT_QPA_PLATFORM", "offscreen");
+            static int argc = 1;
+            static char *argv[] = {(char *)"test"};
+            new QGuiApplication(argc, argv);
+        }
+    }
+
+    void SetUp() override
+    {
+        compositor = new VideoCompositor();
+        configure(*compositor);
+    }
+
+    static void configure(VideoCompositor &vc)
+    {
+        vc.setOutputGeometry(OUTPUT_WIDTH, OUTPUT_HEIGHT, 30);
+        // 串行绘制，保证结果与线程调度无关
+        vc.setRenderThreadCount(1);
+    }
+
+    void TearDown() override
+    {
+        delete compositor;
+        compositor = nullptr;
+    }
+
+    void feedParticipants(int count)
+    {
+        for (int i = 0; i < count; ++i)
+            compositor->feedFrame(participantId(i), makeFrame(i));
+    }
+
+    VideoCompositor *compositor = nullptr;
+};
+
+// ==================== 布局金样图 ====================
+
+TEST_F(VideoCompositorTest, EmptyCanvasIsBlack)
+{
+    const QImage frame = compositeOnce(*compositor);
+    ASSERT_EQ(frame.size(), QSize(OUTPUT_WIDTH, OUTPUT_HEIGHT));
+    EXPECT_EQ(frame.pixel(OUTPUT_WIDTH / 2, OUTPUT_HEIGHT / 2), qRgb(0, 0, 0));
+}
+
+TEST_F(VideoCompositorTest, GridLayoutMatchesGolden)
+{
+    for (int count : {1, 4, 9})
+    {
+        VideoCompositor grid;
+        configure(grid);
+        for (int i = 0; i < count; ++i)
+            grid.feedFrame(participantId(i), makeFrame(i));
+        expectMatchesGolden(QStringLiteral("grid_%1").arg(count),
+                            compositeOnce(grid));
+    }
+}
+
+TEST_F(VideoCompositorTest, ScreenShareLayoutMatchesGolden)
+{
+    feedParticipants(3);
+    compositor->feedFrame(QStringLiteral("screen"), makeFrame(7, 640, 400));
+    expectMatchesGolden(QStringLiteral("screen_share_3"),
+                        compositeOnce(*compositor));
+}
+
+TEST_F(VideoCompositorTest, SpeakerLayoutMatchesGolden)
+{
+    compositor->setLayoutMode(VideoCompositor::LayoutMode::Speaker);
+    feedParticipants(6);
+    compositor->setActiveSpeakers({participantId(3)});
+    expectMatchesGolden(QStringLiteral("speaker_6"), compositeOnce(*compositor));
+}
+
+TEST_F(VideoCompositorTest, PaginatedLayoutMatchesGolden)
+{
+    compositor->setLayoutMode(VideoCompositor::LayoutMode::Paginated);
+    compositor->setPageSize(4);
+    feedParticipants(10);
+    EXPECT_EQ(compositor->pageCount(), 3);
+
+    compositor->setPage(2);
+    expectMatchesGolden(QStringLiteral("paginated_10_page2"),
+                        compositeOnce(*compositor));
+}
+
+// ==================== 增量合成 ====================
+
+TEST_F(VideoCompositorTest, StaticTickSkipsTiles)
+{
+    feedParticipants(4);
+    const QImage first = compositeOnce(*compositor);
+    EXPECT_EQ(compositor->tilesRenderedCount(), 4u);
+
+    const QImage second = compositeOnce(*compositor);
+    EXPECT_EQ(compositor->tilesRenderedCount(), 4u);
+    EXPECT_EQ(compositor->tilesSkippedCount(), 4u);
+    EXPECT_EQ(first, second);
+
+    // 只有一路有新帧时只重绘这一格
+    compositor->feedFrame(participantId(2), makeFrame(12));
+    const QImage third = compositeOnce(*compositor);
+    EXPECT_EQ(compositor->tilesRenderedCount(), 5u);
+    EXPECT_NE(second, third);
+}
+
+TEST_F(VideoCompositorTest, CountsFramesDroppedBeforeComposite)
+{
+    compositor->feedFrame(participantId(0), makeFrame(0));
+    compositor->feedFrame(participantId(0), makeFrame(1));
+    compositor->feedFrame(participantId(0), makeFrame(2));
+    compositeOnce(*compositor);
+    compositor->feedFrame(participantId(0), makeFrame(3));
+    compositeOnce(*compositor);
+
+    EXPECT_EQ(compositor->droppedFrameCounts().value(participantId(0)), 2u);
+}
+
+TEST_F(VideoCompositorTest, AcceptsAnySourceFormat)
+{
+    compositor->feedFrame(participantId(0),
+                          makeFrame(0).convertToFormat(QImage::Format_RGB888));
+    const QImage frame = compositeOnce(*compositor);
+    // 单个参会者占满画布，中心是色块
+    const QColor center = frame.pixelColor(OUTPUT_WIDTH / 2, OUTPUT_HEIGHT / 2);
+    EXPECT_EQ(center.rgb(), qRgb(255, 255 - 80, 255 - 160));
+}
+
+TEST_F(VideoCompositorTest, SkipsTicksWhenFramePoolExhausted)
+{
+    compositor->setFramePoolSize(2);
+    std::vector<QImage> held; // 模拟编码器队列持有的帧
+    auto connection = QObject::connect(
+        compositor, &VideoCompositor::compositeFrameReady,
+        [&held](const QImage &frame, qint64) { held.push_back(frame); });
+
+    for (int i = 0; i < 3; ++i)
+    {
+        compositor->feedFrame(participantId(0), makeFrame(i));
+        compositor->compositeNow();
+    }
+    EXPECT_EQ(held.size(), 2u);
+    EXPECT_EQ(compositor->framesSkippedCount(), 1u);
+    EXPECT_NE(held[0].constBits(), held[1].constBits());
+
+    // 下游释放后缓冲回到池中，下一 tick 补画被跳过的帧，不再分配
+    const uchar *current = held[1].constBits();
+    held.clear();
+    compositor->compositeNow();
+    ASSERT_EQ(held.size(), 1u);
+    EXPECT_EQ(compositor->framesSkippedCount(), 1u);
+    EXPECT_EQ(compositor->tilesRenderedCount(), 3u);
+    EXPECT_EQ(held[0].constBits(), current);
+    QObject::disconnect(connection);
+}
+
+// ==================== 单元格尺寸回传 ====================
+
+TEST_F(VideoCompositorTest, AdvertisesTileSizes)
+{
+    QSignalSpy spy(compositor, &VideoCompositor::tileSizeChanged);
+    compositor->setLayoutMode(VideoCompositor::LayoutMode::Paginated);
+    compositor->setPageSize(4);
+    feedParticipants(5);
+    compositeOnce(*compositor);
+
+    EXPECT_EQ(spy.count(), 5);
+    EXPECT_EQ(compositor->tileSize(participantId(0)),
+              QSize(OUTPUT_WIDTH / 2, OUTPUT_HEIGHT / 2));
+    // 第二页的参会者当前不可见
+    EXPECT_EQ(compositor->tileSize(participantId(4)), QSize(0, 0));
+
+    // 布局不变时不重复通知
+    compositeOnce(*compositor);
+    EXPECT_EQ(spy.count(), 5);
+}
+
+// ==================== YUV420P 输出 ====================
+
+TEST_F(VideoCompositorTest, YuvOutputMatchesGeometry)
+{
+    compositor->setOutputFormat(VideoCompositor::OutputFormat::Yuv420p);
+
+    QImage white(64, 36, QImage::Format_ARGB32);
+    white.fill(Qt::white);
+    compositor->feedFrame(participantId(0), white);
+
+    AVFrameRef output;
+    auto connection = QObject::connect(
+        compositor, &VideoCompositor::compositeYuvFrameReady,
+        [&output](const AVFrameRef &frame, qint64) { output = frame; });
+    compositor->compositeNow();
+    QObject::disconnect(connection);
+
+    ASSERT_TRUE(output);
+    EXPECT_EQ(output->format, AV_PIX_FMT_YUV420P);
+    EXPECT_EQ(output->width, OUTPUT_WIDTH);
+    EXPECT_EQ(output->height, OUTPUT_HEIGHT);
+
+    // BT.601 limited range：白色 Y≈235，U/V≈128
+    const int cx = OUTPUT_WIDTH / 2;
+    const int cy = OUTPUT_HEIGHT / 2;
+    EXPECT_NEAR(output->data[0][cy * output->linesize[0] + cx], 235, 2);
+    EXPECT_NEAR(output->data[1][(cy / 2) * output->linesize[1] + cx / 2], 128, 2);
+    EXPECT_NEAR(output->data[2][(cy / 2) * output->linesize[2] + cx / 2], 128, 2);
+}
+
+TEST_F(VideoCompositorTest, YuvOutputLumaMatchesGolden)
+{
+    // 4 宫格单元格与源帧同为 320x180，YUV 直写路径不经缩放，亮度应与金样图一致
+    compositor->setOutputFormat(VideoCompositor::OutputFormat::Yuv420p);
+    feedParticipants(4);
+
+    AVFrameRef output;
+    auto connection = QObject::connect(
+        compositor, &VideoCompositor::compositeYuvFrameReady,
+        [&output](const AVFrameRef &frame, qint64) { output = frame; });
+    compositor->compositeNow();
+    QObject::disconnect(connection);
+    ASSERT_TRUE(output);
+
+    const QImage golden =
+        QImage(QDir(QStringLiteral(VIDEO_COMPOSITOR_GOLDEN_DIR))
+                   .filePath(QStringLiteral("grid_4.png")))
+            .convertToFormat(QImage::Format_RGB32);
+    ASSERT_EQ(golden.size(), QSize(OUTPUT_WIDTH, OUTPUT_HEIGHT));
+
+    qint64 mismatched = 0;
+    for (int y = 0; y < OUTPUT_HEIGHT; ++y)
+    {
+        const auto *e = reinterpret_cast<const QRgb *>(golden.constScanLine(y));
+        const uint8_t *luma = output->data[0] + y * output->linesize[0];
+        for (int x = 0; x < OUTPUT_WIDTH; ++x)
+        {
+            const int expected =
+                ((66 * qRed(e[x]) + 129 * qGreen(e[x]) + 25 * qBlue(e[x]) +
+                  128) >> 8) + 16;
+            if (std::abs(luma[x] - expected) > GOLDEN_TOLERANCE)
+                ++mismatched;
+        }
+    }
+    EXPECT_LE(static_cast<double>(mismatched) / (OUTPUT_WIDTH * OUTPUT_HEIGHT),
+              GOLDEN_MAX_MISMATCH)
+        << mismatched << " 个亮度像素超差";
+}
+
+TEST_F(VideoCompositorTest, YuvOutputLetterboxIsBlack)
+{
+    compositor->setOutputFormat(VideoCompositor::OutputFormat::Yuv420p);
+
+    // 竖屏源帧：左右两侧为黑边，中间为白色画面
+    QImage white(36, 64, QImage::Format_ARGB32);
+    white.fill(Qt::white);
+    compositor->feedFrame(participantId(0), white);
+
+    AVFrameRef output;
+    auto connection = QObject::connect(
+        compositor, &VideoCompositor::compositeYuvFrameReady,
+        [&output](const AVFrameRef &frame, qint64) { output = frame; });
+    compositor->compositeNow();
+    QObject::disconnect(connection);
+    ASSERT_TRUE(output);
+
+    const int cy = OUTPUT_HEIGHT / 2;
+    const uint8_t *luma = output->data[0] + cy * output->linesize[0];
+    EXPECT_EQ(luma[4], 16);
+    EXPECT_EQ(luma[OUTPUT_WIDTH - 5], 16);
+    EXPECT_NEAR(luma[OUTPUT_WIDTH / 2], 235, 2);
+    EXPECT_EQ(output->data[1][(cy / 2) * output->linesize[1] + 2], 128);
+    EXPECT_EQ(output->data[2][(cy / 2) * output->linesize[2] + 2], 128);
+}
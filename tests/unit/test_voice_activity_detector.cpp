@@ -0,0 +1,138 @@
+/**
+ * @file test_voice_activity_detector.cpp
+ * @brief VoiceActivityDetector 单元测试
+ *
+ * 测试内容：
+ * - 静音不判为说话，电平为 SILENCE_DB
+ * - 静音后出现语音：快攻，第一块即判为说话，电平收敛到块 RMS
+ * - 语音结束后 hangover 保持一段时间再判为静音
+ * - 稳定背景噪声逐渐被噪声底吸收，不再判为说话；其上的语音仍能检出
+ * - 首块电平作为初始噪声底（开头就有噪声时不误判）
+ * - reset() 回到初始状态
+ *
+ * 输入为 ±A 方波：RMS 恰为 A，电平 = 20·log10(A / 32768)。
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "voiceactivitydetector.h"
+
+namespace
+{
+constexpr int SAMPLE_RATE = 48000;
+constexpr int BLOCK = 480; // 10ms
+
+// 约 -15 dBFS 的「语音」与约 -40 dBFS 的背景噪声
+constexpr int16_t SPEECH_AMPLITUDE = 5827;
+constexpr int16_t NOISE_AMPLITUDE = 328;
+
+float amplitudeDb(int16_t amplitude)
+{
+    return 20.0f * std::log10(amplitude / 32768.0f);
+}
+
+// 送入 ms 毫秒的 ±amplitude 方波（amplitude 为 0 即静音）
+void feed(VoiceActivityDetector &vad, int16_t amplitude, int ms)
+{
+    std::vector<int16_t> block(BLOCK);
+    for (int i = 0; i < BLOCK; ++i)
+        block[i] = (i & 1) ? amplitude : static_cast<int16_t>(-amplitude);
+    for (int t = 0; t < ms; t += 10)
+        vad.process(block.data(), BLOCK, SAMPLE_RATE);
+}
+} // namespace
+
+TEST(VoiceActivityDetectorTest, SilenceIsNotSpeech)
+{
+    VoiceActivityDetector vad;
+    feed(vad, 0, 1000);
+    EXPECT_FALSE(vad.isSpeaking());
+    EXPECT_FLOAT_EQ(vad.levelDb(), VoiceActivityDetector::SILENCE_DB);
+}
+
+TEST(VoiceActivityDetectorTest, SpeechAfterSilenceDetectedImmediately)
+{
+    VoiceActivityDetector vad;
+    feed(vad, 0, 500);
+
+    feed(vad, SPEECH_AMPLITUDE, 10);
+    EXPECT_TRUE(vad.isSpeaking());
+
+    // 快攻（~10ms）：100ms 后电平已收敛到块 RMS
+    feed(vad, SPEECH_AMPLITUDE, 100);
+    EXPECT_NEAR(vad.levelDb(), amplitudeDb(SPEECH_AMPLITUDE), 0.5f);
+    EXPECT_TRUE(vad.isSpeaking());
+}
+
+TEST(VoiceActivityDetectorTest, HangoverBridgesShortPauses)
+{
+    VoiceActivityDetector vad;
+    feed(vad, 0, 500);
+    feed(vad, SPEECH_AMPLITUDE, 500);
+    ASSERT_TRUE(vad.isSpeaking());
+
+    // 词间停顿：慢放 + hangover，200ms 内仍判为说话
+    feed(vad, 0, 200);
+    EXPECT_TRUE(vad.isSpeaking());
+
+    // 持续静音：最终回到静音
+    feed(vad, 0, 1000);
+    EXPECT_FALSE(vad.isSpeaking());
+}
+
+TEST(VoiceActivityDetectorTest, StationaryNoiseAbsorbedIntoFloor)
+{
+    VoiceActivityDetector vad;
+    feed(vad, 0, 500);
+
+    // 静音后突然出现的噪声先被当作语音
+    feed(vad, NOISE_AMPLITUDE, 100);
+    EXPECT_TRUE(vad.isSpeaking());
+
+    // 噪声底按 1dB/s 上升，约一分钟后吸收稳定噪声
+    feed(vad, NOISE_AMPLITUDE, 60000);
+    EXPECT_FALSE(vad.isSpeaking());
+    EXPECT_NEAR(vad.noiseFloorDb(), amplitudeDb(NOISE_AMPLITUDE), 1.0f);
+
+    // 噪声之上的语音仍能检出
+    feed(vad, SPEECH_AMPLITUDE, 50);
+    EXPECT_TRUE(vad.isSpeaking());
+}
+
+TEST(VoiceActivityDetectorTest, FirstBlockPrimesNoiseFloor)
+{
+    VoiceActivityDetector vad;
+    feed(vad, NOISE_AMPLITUDE, 1000);
+    EXPECT_FALSE(vad.isSpeaking());
+    EXPECT_NEAR(vad.noiseFloorDb(), amplitudeDb(NOISE_AMPLITUDE), 1.0f);
+}
+
+TEST(VoiceActivityDetectorTest, QuietSpeechBelowAbsoluteThreshold)
+{
+    // 高于噪声底但低于 -55dBFS 的信号不判为说话
+    VoiceActivityDetector vad;
+    feed(vad, 0, 500);
+    feed(vad, 40, 200); // 约 -58 dBFS
+    EXPECT_FALSE(vad.isSpeaking());
+}
+
+TEST(VoiceActivityDetectorTest, ResetRestoresInitialState)
+{
+    VoiceActivityDetector vad;
+    feed(vad, 0, 500);
+    feed(vad, SPEECH_AMPLITUDE, 200);
+    ASSERT_TRUE(vad.isSpeaking());
+
+    vad.reset();
+    EXPECT_FALSE(vad.isSpeaking());
+    EXPECT_FLOAT_EQ(vad.levelDb(), VoiceActivityDetector::SILENCE_DB);
+    EXPECT_FLOAT_EQ(vad.noiseFloorDb(), VoiceActivityDetector::SILENCE_DB);
+
+    // reset 后首块重新作为噪声底
+    feed(vad, NOISE_AMPLITUDE, 500);
+    EXPECT_FALSE(vad.isSpeaking());
+}